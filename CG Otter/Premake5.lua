@@ -24,10 +24,14 @@ local sampleGroups = os.matchdirs(rootDir .. "/samples/*")
 
 -- Select the last item in the project directory to be our startup project 
 -- (this is easily changed in VS, this is just to be handy)
-if #projects > 0 then
-    startup = path.getbasename(projects[#projects])
-else
-    startup = ""
+-- Test projects (names ending in "Tests") are skipped, they're console apps for checking modules
+startup = ""
+for ix=#projects, 1, -1 do
+    local name = path.getbasename(projects[ix])
+    if not name:find("Tests$") then
+        startup = name
+        break
+    end
 end
 
 -- This function concatenates two LUA tables, returning a new result
@@ -1,5 +1,7 @@
 #pragma once
 #include "GLFW/glfw3.h"
+#include <memory>
+#include "JobSystem.h"
 
 // We can declare the name and assume it will get included later, helps avoid circular dependencies
 class GameScene;
@@ -15,4 +17,15 @@ public:
 
 	GLFWwindow* Window;
 	std::shared_ptr<GameScene> ActiveScene;
+	// Runs work across every core, create it from the thread that owns the GL context
+	std::unique_ptr<JobSystem> Jobs;
+
+	/*
+	 * Moves the active scene forward a frame, call once a frame before rendering
+	 *
+	 * Runs as many FixedUpdates as Timing says are due, then Update and LateUpdate. Transforms that moved
+	 * in the last FixedUpdate are left blended between their last two fixed states, so they move smoothly
+	 * at any frame rate. They go back to their real state at the start of the next call
+	 */
+	void Update();
 };
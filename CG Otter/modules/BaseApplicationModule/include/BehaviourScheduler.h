@@ -0,0 +1,274 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include <entt.hpp>
+#include "JobSystem.h"
+
+class IBehaviour;
+struct BehaviourBinding;
+
+/*
+ * Hands out blocks of one size, 64 at a time from a single chunk, so everything allocated from it
+ * sits together in memory. Only behaviours use it, and they're only created and destroyed on the main thread
+ * @param BlockSize The size of each block
+ * @param Alignment The alignment of each block
+ */
+template <size_t BlockSize, size_t Alignment>
+class BehaviourArena {
+public:
+	static void* Allocate() {
+		State& state = _State();
+		if (state.Free.empty()) {
+			_Grow(state);
+		}
+		void* block = state.Free.back();
+		state.Free.pop_back();
+		return block;
+	}
+	static void Free(void* block) {
+		_State().Free.push_back(block);
+	}
+
+private:
+	static constexpr size_t CHUNK_BLOCKS = 64;
+	static constexpr size_t STRIDE = (BlockSize + Alignment - 1) / Alignment * Alignment;
+
+	struct alignas(Alignment) Chunk {
+		unsigned char Data[STRIDE * CHUNK_BLOCKS];
+	};
+	struct State {
+		std::vector<std::unique_ptr<Chunk>> Chunks;
+		std::vector<void*> Free;
+	};
+
+	// Never destroyed, behaviours held by static registries can still give their blocks back at exit
+	static State& _State() {
+		static State* state = new State();
+		return *state;
+	}
+	static void _Grow(State& state) {
+		state.Chunks.push_back(std::make_unique<Chunk>());
+		unsigned char* data = state.Chunks.back()->Data;
+		// Pushed in reverse so the blocks get handed out front to back
+		for (size_t ix = CHUNK_BLOCKS; ix > 0; ix--) {
+			state.Free.push_back(data + (ix - 1) * STRIDE);
+		}
+	}
+};
+
+/*
+ * Allocator for std::allocate_shared that puts the behaviour (and its control block) in a BehaviourArena
+ */
+template <typename T>
+struct BehaviourAllocator {
+	typedef T value_type;
+
+	BehaviourAllocator() = default;
+	template <typename U>
+	BehaviourAllocator(const BehaviourAllocator<U>&) { }
+
+	T* allocate(size_t count) {
+		if (count != 1) {
+			return std::allocator<T>().allocate(count);
+		}
+		return static_cast<T*>(BehaviourArena<sizeof(T), alignof(T)>::Allocate());
+	}
+	void deallocate(T* pointer, size_t count) {
+		if (count != 1) {
+			std::allocator<T>().deallocate(pointer, count);
+		} else {
+			BehaviourArena<sizeof(T), alignof(T)>::Free(pointer);
+		}
+	}
+
+	template <typename U>
+	bool operator==(const BehaviourAllocator<U>&) const { return true; }
+	template <typename U>
+	bool operator!=(const BehaviourAllocator<U>&) const { return false; }
+};
+
+/*
+ * Every behaviour of one type in a registry, with the entity each one is bound to
+ */
+class IBehaviourPool {
+public:
+	virtual ~IBehaviourPool() = default;
+
+	virtual void Add(entt::entity entity, const std::shared_ptr<IBehaviour>& behaviour) = 0;
+	virtual void Remove(entt::entity entity, const IBehaviour* behaviour) = 0;
+	/*
+	 * Runs Update on every enabled behaviour in the pool, FixedUpdate and LateUpdate work the same way
+	 * @param registry The registry the entities are in
+	 * @param jobs Used to split the pool into chunks if the type is thread safe, can be nullptr
+	 */
+	virtual void Update(entt::registry& registry, JobSystem* jobs) = 0;
+	virtual void FixedUpdate(entt::registry& registry, JobSystem* jobs) = 0;
+	virtual void LateUpdate(entt::registry& registry, JobSystem* jobs) = 0;
+	virtual size_t Size() const = 0;
+};
+
+template <typename T>
+class BehaviourPool final : public IBehaviourPool {
+public:
+	// How many behaviours each job gets when the type runs in parallel
+	static constexpr unsigned GRAIN_SIZE = 64;
+
+	void Add(entt::entity entity, const std::shared_ptr<IBehaviour>& behaviour) override {
+		_entities.push_back(entity);
+		_items.push_back(static_cast<T*>(behaviour.get()));
+	}
+	void Remove(entt::entity entity, const IBehaviour* behaviour) override {
+		// Only happens when a binding is destroyed, so a search is fine. Swap with the back to keep things packed
+		for (size_t ix = 0; ix < _items.size(); ix++) {
+			if (_items[ix] == behaviour && _entities[ix] == entity) {
+				_items[ix] = _items.back();
+				_entities[ix] = _entities.back();
+				_items.pop_back();
+				_entities.pop_back();
+				return;
+			}
+		}
+	}
+	// The pool only ever holds exactly T, so the calls don't need to go through the vtable
+	void Update(entt::registry& registry, JobSystem* jobs) override {
+		_Run(registry, jobs, [](T* behaviour, entt::handle entity) { behaviour->T::Update(entity); });
+	}
+	void FixedUpdate(entt::registry& registry, JobSystem* jobs) override {
+		_Run(registry, jobs, [](T* behaviour, entt::handle entity) { behaviour->T::FixedUpdate(entity); });
+	}
+	void LateUpdate(entt::registry& registry, JobSystem* jobs) override {
+		_Run(registry, jobs, [](T* behaviour, entt::handle entity) { behaviour->T::LateUpdate(entity); });
+	}
+	size_t Size() const override { return _items.size(); }
+
+private:
+	/*
+	 * Calls func(behaviour, entity) for every enabled behaviour, in parallel chunks if T is thread safe
+	 */
+	template <typename Func>
+	void _Run(entt::registry& registry, JobSystem* jobs, Func func) {
+		auto runRange = [&](unsigned begin, unsigned end) {
+			for (unsigned ix = begin; ix < end; ix++) {
+				T* behaviour = _items[ix];
+				if (behaviour->Enabled) {
+					func(behaviour, entt::handle(registry, _entities[ix]));
+				}
+			}
+		};
+		if constexpr (T::ThreadSafe) {
+			if (jobs != nullptr) {
+				jobs->ParallelFor((unsigned)_items.size(), GRAIN_SIZE, runRange);
+				return;
+			}
+		}
+		runRange(0, (unsigned)_items.size());
+	}
+
+	std::vector<entt::entity> _entities;
+	// Owned by the bindings, they're removed from here before the binding lets go of them
+	std::vector<T*> _items;
+};
+
+/*
+ * Updates every behaviour in a registry, one type at a time
+ *
+ * Each type gets its own pool, so a type's update runs over one packed array without any virtual calls,
+ * and the behaviours themselves are allocated next to each other (see BehaviourArena). Types that set
+ * ThreadSafe to true have their pool split across the job system. A thread safe behaviour may only
+ * touch its own state and its own entity's components in any of its updates, and can't add or remove anything from the registry
+ *
+ * Types update in the order their first behaviour was bound. There's one scheduler per registry, kept in the
+ * registry's context and filled in by BehaviourBinding::Bind
+ */
+class BehaviourScheduler {
+public:
+	BehaviourScheduler(entt::registry& registry);
+
+	BehaviourScheduler(const BehaviourScheduler& other) = delete;
+	BehaviourScheduler& operator=(const BehaviourScheduler& other) = delete;
+
+	/*
+	 * Gets the scheduler for a registry, creating it the first time
+	 */
+	static BehaviourScheduler& Get(entt::registry& registry) {
+		return registry.ctx_or_set<BehaviourScheduler>(registry);
+	}
+
+	/*
+	 * Gets a small number unique to a behaviour type, for indexing by type without a typeid lookup
+	 * @param T The type of behaviour
+	 */
+	template <typename T>
+	static uint32_t TypeIndex() {
+		static const uint32_t index = _RegisterType(&_MakePool<T>);
+		return index;
+	}
+
+	/*
+	 * Makes a new behaviour, allocated with the rest of its type
+	 * @param T The type of behaviour to make
+	 * @param args The arguments to forward to the behaviour's constructor
+	 */
+	template <typename T, typename ... TArgs>
+	static std::shared_ptr<T> Create(TArgs&&... args) {
+		return std::allocate_shared<T>(BehaviourAllocator<T>(), std::forward<TArgs>(args)...);
+	}
+
+	/*
+	 * Adds a behaviour to the pool for its type, BehaviourBinding does this for you
+	 * @param entity The entity the behaviour is bound to
+	 * @param type The behaviour's type index
+	 * @param behaviour The behaviour, has to be exactly the type the index is for
+	 */
+	void Add(entt::entity entity, uint32_t type, const std::shared_ptr<IBehaviour>& behaviour);
+
+	/*
+	 * Runs Update on every enabled behaviour
+	 * @param jobs Runs the thread safe types in parallel, nullptr updates everything on this thread
+	 */
+	void Update(JobSystem* jobs = nullptr);
+	/*
+	 * Runs FixedUpdate on every enabled behaviour, Application::Update decides how many times a frame
+	 * @param jobs Runs the thread safe types in parallel, nullptr updates everything on this thread
+	 */
+	void FixedUpdate(JobSystem* jobs = nullptr);
+	/*
+	 * Runs LateUpdate on every enabled behaviour, call it once every behaviour has had its Update
+	 * @param jobs Runs the thread safe types in parallel, nullptr updates everything on this thread
+	 */
+	void LateUpdate(JobSystem* jobs = nullptr);
+
+	/*
+	 * Gets the number of behaviours across every pool
+	 */
+	size_t GetBehaviourCount() const;
+	/*
+	 * Gets the number of types that have had a behaviour bound
+	 */
+	size_t GetTypeCount() const { return _updateOrder.size(); }
+
+private:
+	typedef std::unique_ptr<IBehaviourPool>(*PoolFactory)();
+
+	template <typename T>
+	static std::unique_ptr<IBehaviourPool> _MakePool() {
+		return std::make_unique<BehaviourPool<T>>();
+	}
+	/*
+	 * Gives a type its index, and remembers how to make a pool for it
+	 */
+	static uint32_t _RegisterType(PoolFactory factory);
+	static std::vector<PoolFactory>& _Factories();
+
+	/*
+	 * Picks up bindings that arrive already filled in, like ones copied over by GameScene::StampEntity
+	 */
+	void _OnBindingConstructed(entt::registry& registry, entt::entity entity);
+	void _OnBindingDestroyed(entt::registry& registry, entt::entity entity);
+
+	// Indexed by type index, null for types that have never been bound in this registry
+	std::vector<std::unique_ptr<IBehaviourPool>> _pools;
+	std::vector<uint32_t> _updateOrder;
+	entt::registry& _registry;
+};
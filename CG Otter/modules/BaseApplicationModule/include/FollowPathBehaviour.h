@@ -12,10 +12,14 @@ public:
 		_nextPointIx(0) { }
 	~FollowPathBehaviour() override = default;
 
+	// Only ever moves its own transform
+	static constexpr bool ThreadSafe = true;
+
 	std::vector<glm::vec3> Points;
 	float                  Speed;
 
-	void Update(entt::handle entity) override;
+	// Runs at the fixed rate, so the path comes out the same at any frame rate
+	void FixedUpdate(entt::handle entity) override;
 	
 private:
 	int _nextPointIx;
@@ -1,7 +1,8 @@
 #pragma once
 #include <memory>
 #include <entt.hpp>
-#include <typeindex>
+#include <cstdint>
+#include "BehaviourScheduler.h"
 struct BehaviourBinding;
 
 /*
@@ -13,6 +14,11 @@ public:
 	 * Whether or not this component will fire it's events
 	 */
 	bool    Enabled = true;
+	/*
+	 * Set to true in a behaviour type whose updates only touch its own state and its own entity's
+	 * components, so the BehaviourScheduler can spread that type across threads
+	 */
+	static constexpr bool ThreadSafe = false;
 	virtual ~IBehaviour() = default;
 
 	/*
@@ -58,6 +64,10 @@ protected:
  */
 struct BehaviourBinding {
 	std::vector<std::shared_ptr<IBehaviour>> Behaviours;
+	// The type index of each behaviour (see BehaviourScheduler::TypeIndex), lines up with Behaviours
+	std::vector<uint32_t> Types;
+	// Where the first behaviour of each type is in Behaviours, indexed by type index, -1 if there isn't one
+	std::vector<int> FirstOfType;
 
 	/*
 	 * Binds an IBehaviour interface to the given entt entity
@@ -69,14 +79,10 @@ struct BehaviourBinding {
 	 */
 	template <typename T, typename ... TArgs, typename = typename std::enable_if<std::is_base_of<IBehaviour, T>::value>::type>
 	static std::shared_ptr<T> Bind(entt::handle entity, TArgs&&... args) {
-		// Get the binding component
-		BehaviourBinding& binding = entity.get_or_emplace<BehaviourBinding>();
 		// Make a new behaviour, forwarding the arguments
-		const std::shared_ptr<IBehaviour> behaviour = std::make_shared<T>(std::forward<TArgs>(args)...);
-		// Append it to the binding component's storage, and invoke the OnLoad
-		binding.Behaviours.push_back(behaviour);
-		behaviour->OnLoad(entity);
-		return std::dynamic_pointer_cast<T>(behaviour);
+		const std::shared_ptr<T> behaviour = BehaviourScheduler::Create<T>(std::forward<TArgs>(args)...);
+		_Attach(entity, BehaviourScheduler::TypeIndex<T>(), behaviour);
+		return behaviour;
 	}
 
 	/*
@@ -89,15 +95,11 @@ struct BehaviourBinding {
 	 */
 	template <typename T, typename ... TArgs, typename = typename std::enable_if<std::is_base_of<IBehaviour, T>::value>::type>
 	static std::shared_ptr<T> BindDisabled(entt::handle entity, TArgs&&... args) {
-		// Get the binding component
-		BehaviourBinding& binding = entity.get_or_emplace<BehaviourBinding>();
 		// Make a new behaviour, forwarding the arguments
-		const std::shared_ptr<IBehaviour> behaviour = std::make_shared<T>(std::forward<TArgs>(args)...);
+		const std::shared_ptr<T> behaviour = BehaviourScheduler::Create<T>(std::forward<TArgs>(args)...);
 		behaviour->Enabled = false;
-		// Append it to the binding component's storage, and invoke the OnLoad
-		binding.Behaviours.push_back(behaviour);
-		behaviour->OnLoad(entity);
-		return std::dynamic_pointer_cast<T>(behaviour);
+		_Attach(entity, BehaviourScheduler::TypeIndex<T>(), behaviour);
+		return behaviour;
 	}
 
 	
@@ -112,16 +114,7 @@ struct BehaviourBinding {
 	static bool Has(entt::handle entity) {
 		// Check to see if the entity has a behaviour binding attached
 		if (entity.has<BehaviourBinding>()) {
-			// Get the binding component
-			const auto& binding = entity.get<BehaviourBinding>();
-			// Iterate over all the pointers in the binding list
-			for (const auto& ptr : binding.Behaviours) {
-				// If the pointer type matches T, we return true
-				if (std::type_index(typeid(*ptr.get())) == std::type_index(typeid(T))) {
-					return true;
-				}
-			}
-			return false;
+			return entity.get<BehaviourBinding>()._IndexOf(BehaviourScheduler::TypeIndex<T>()) >= 0;
 		}
 		else return false;
 	}
@@ -137,17 +130,37 @@ struct BehaviourBinding {
 	static std::shared_ptr<T> Get(entt::handle entity) {
 		// Check to see if the entity has a behaviour binding attached
 		if (entity.has<BehaviourBinding>()) {
-			// Get the binding component
 			const auto& binding = entity.get<BehaviourBinding>();
-			// Iterate over all the pointers in the binding list
-			for (const auto& ptr : binding.Behaviours) {
-				// If the pointer type matches T, we return that behaviour, making sure to cast it back to the requested type
-				if (std::type_index(typeid(*ptr.get())) == std::type_index(typeid(T))) {
-					return std::dynamic_pointer_cast<T>(ptr);
-				}
-			}
-			return nullptr;
+			// The type index only matches behaviours that are exactly T, so the cast is safe
+			int index = binding._IndexOf(BehaviourScheduler::TypeIndex<T>());
+			return index >= 0 ? std::static_pointer_cast<T>(binding.Behaviours[index]) : nullptr;
 		}
 		else return nullptr;
 	}
+
+private:
+	/*
+	 * Adds a behaviour to the entity's binding and the registry's scheduler, then invokes its OnLoad
+	 */
+	static void _Attach(entt::handle entity, uint32_t type, const std::shared_ptr<IBehaviour>& behaviour) {
+		// Make sure the scheduler is listening before the binding gets created
+		BehaviourScheduler& scheduler = BehaviourScheduler::Get(entity.registry());
+		// Get the binding component
+		BehaviourBinding& binding = entity.get_or_emplace<BehaviourBinding>();
+		if (type >= binding.FirstOfType.size()) {
+			binding.FirstOfType.resize(type + 1, -1);
+		}
+		if (binding.FirstOfType[type] < 0) {
+			binding.FirstOfType[type] = (int)binding.Behaviours.size();
+		}
+		// Append it to the binding component's storage, and invoke the OnLoad
+		binding.Behaviours.push_back(behaviour);
+		binding.Types.push_back(type);
+		scheduler.Add(entity.entity(), type, behaviour);
+		behaviour->OnLoad(entity);
+	}
+
+	int _IndexOf(uint32_t type) const {
+		return type < FirstOfType.size() ? FirstOfType[type] : -1;
+	}
 };
\ No newline at end of file
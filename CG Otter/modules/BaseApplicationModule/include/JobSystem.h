@@ -0,0 +1,160 @@
+#pragma once
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <vector>
+#include <algorithm>
+#include <entt.hpp>
+
+/*
+ * Counts the jobs that are still running for something, Wait on it to block until they're all done
+ *
+ * A job can start children against the counter it was started with (see JobSystem::CurrentCounter).
+ * Children are counted before their parent finishes, so the counter can't hit zero until the
+ * whole tree of jobs is done
+ */
+struct JobCounter {
+	std::atomic<int> Value{ 0 };
+
+	bool IsDone() const { return Value.load(std::memory_order_acquire) == 0; }
+};
+
+/*
+ * A work stealing job system
+ *
+ * Every worker has its own deque. Workers push and pop their own jobs from the back, and when
+ * they run dry they steal from the front of everyone else's, so the oldest (and usually biggest)
+ * jobs get spread around. The thread that creates the system is worker 0, it only runs jobs while it's
+ * inside Wait. Jobs that are only allowed on the main thread (anything touching the GL context) wait for
+ * PumpMainThread, so they never land in the middle of whatever the main thread was waiting on
+ */
+class JobSystem {
+public:
+	/*
+	 * Starts the worker threads
+	 * @param numWorkers The number of threads to start, 0 picks one per core minus one for the main thread
+	 */
+	JobSystem(unsigned numWorkers = 0);
+	~JobSystem();
+
+	JobSystem(const JobSystem& other) = delete;
+	JobSystem& operator=(const JobSystem& other) = delete;
+
+	/*
+	 * Queues a job on the calling thread's deque
+	 * @param job The work to do
+	 * @param counter Incremented now and decremented once the job is done, can be nullptr
+	 */
+	void Run(std::function<void()> job, JobCounter* counter = nullptr);
+	/*
+	 * Queues a job that will only ever run on the main thread, inside PumpMainThread
+	 * Don't Wait on the counter from the main thread, the job can't run until the next pump
+	 * @param job The work to do
+	 * @param counter Incremented now and decremented once the job is done, can be nullptr
+	 */
+	void RunOnMainThread(std::function<void()> job, JobCounter* counter = nullptr);
+	/*
+	 * Runs queued jobs until the counter reaches zero, so the waiting thread is never idle
+	 * @param counter The counter to wait on
+	 */
+	void Wait(JobCounter& counter);
+	/*
+	 * Runs everything queued for the main thread, call once a frame from the main thread
+	 * @returns The number of jobs that were run
+	 */
+	unsigned PumpMainThread();
+
+	/*
+	 * Splits 0 to count into chunks of grainSize, runs them across the workers and waits for them
+	 * @param count The number of items
+	 * @param grainSize How many items each job gets, smaller balances better but costs more overhead
+	 * @param func Called with the range of items to work on, [begin, end)
+	 */
+	void ParallelFor(unsigned count, unsigned grainSize, const std::function<void(unsigned begin, unsigned end)>& func);
+	/*
+	 * Runs func for every entity with all the given components, split across the workers
+	 * The components are only read and written through func, nothing can be added to or removed
+	 * from the registry until this returns
+	 * @param Component The components the entities need to have
+	 * @param registry The registry to look in
+	 * @param grainSize How many entities each job gets
+	 * @param func Called as func(entity, component&...) for each entity
+	 */
+	template <typename ... Component, typename Func>
+	void ParallelEach(entt::registry& registry, unsigned grainSize, Func&& func) {
+		auto view = registry.view<Component...>();
+		// Views over more than one component can't be indexed, so take a copy of the entities first
+		std::vector<entt::entity> entities(view.begin(), view.end());
+		ParallelFor((unsigned)entities.size(), grainSize, [&](unsigned begin, unsigned end) {
+			for (unsigned i = begin; i < end; i++) {
+				func(entities[i], view.template get<Component>(entities[i])...);
+			}
+		});
+	}
+
+	/*
+	 * Gets the counter of the job running on this thread, so it can start children against it
+	 * @returns The counter, or nullptr if this thread isn't running a job (or the job has no counter)
+	 */
+	static JobCounter* CurrentCounter();
+	/*
+	 * Checks if the calling thread is the one that created this system
+	 */
+	bool IsMainThread() const { return std::this_thread::get_id() == _mainThread; }
+	/*
+	 * Gets the number of threads running jobs, including the main thread
+	 */
+	unsigned GetThreadCount() const { return (unsigned)_threads.size() + 1; }
+	/*
+	 * Gets the number of jobs that were run on a different worker than the one that queued them
+	 */
+	unsigned GetStealCount() const { return _steals.load(std::memory_order_relaxed); }
+
+private:
+	struct Job {
+		std::function<void()> Func;
+		JobCounter* Counter;
+	};
+	struct Worker {
+		std::mutex Mutex;
+		std::deque<Job> Jobs;
+	};
+
+	/*
+	 * What each worker thread runs until the system is destroyed
+	 */
+	void _WorkerLoop(unsigned index);
+	/*
+	 * Finds a job, own deque first, then stealing
+	 * @returns True if a job was found
+	 */
+	bool _TryGetJob(unsigned index, Job& job);
+	/*
+	 * Runs a job and decrements its counter
+	 */
+	void _Execute(Job& job);
+	/*
+	 * Gets the deque the calling thread should push onto
+	 */
+	unsigned _CurrentWorker() const;
+	void _Wake();
+
+	std::vector<std::unique_ptr<Worker>> _workers;
+	std::vector<std::thread> _threads;
+	std::thread::id _mainThread;
+
+	std::mutex _mainMutex;
+	std::deque<Job> _mainJobs;
+
+	// Sleeping workers wait on this, woken whenever a job is queued
+	std::mutex _wakeMutex;
+	std::condition_variable _wake;
+	// Jobs sitting in the worker deques, so sleepers know if there's something to steal
+	std::atomic<int> _queued{ 0 };
+	std::atomic<unsigned> _steals{ 0 };
+	bool _stopping = false;
+};
@@ -12,6 +12,27 @@ public:
 	double LastFrame;
 	float  DeltaTime;
 
+	// The time between fixed updates, the simulation always moves forward by exactly this much
+	float  FixedTimeStep = 1.0f / 60.0f;
+	// The most fixed updates one frame will run. If a frame takes longer than this many steps, the rest of the time
+	// is dropped so that a slow frame can't make the next one slower (and so on until everything grinds to a halt)
+	int    MaxFixedSteps = 5;
+	// Time that hasn't been simulated yet, always less than a step once Advance returns
+	double FixedAccumulator = 0.0;
+	// How far the frame is between the last fixed update and the next one, 0 to 1, for interpolating
+	float  FixedAlpha = 0.0f;
+	// The number of fixed updates Advance asked for this frame
+	int    FixedSteps = 0;
+	// The total time that's been thrown away by the MaxFixedSteps cap
+	double DroppedTime = 0.0;
+
+	/*
+	 * Moves the frame forward to the given time, working out DeltaTime and how many fixed updates are due
+	 * @param now The current time, in seconds
+	 * @returns The number of fixed updates to run this frame
+	 */
+	int Advance(double now);
+
 protected:
 	Timing() = default;
 };
\ No newline at end of file
@@ -0,0 +1,29 @@
+#include "Application.h"
+
+#include "Scene.h"
+#include "Timing.h"
+#include "BehaviourScheduler.h"
+#include "TransformSystem.h"
+
+void Application::Update() {
+	Timing& time = Timing::Instance();
+	// The simulation carries on from where the last fixed update left things, not where they were drawn
+	TransformSystem::EndInterpolation();
+
+	int fixedSteps = time.Advance(glfwGetTime());
+	if (ActiveScene == nullptr) {
+		return;
+	}
+
+	BehaviourScheduler& behaviours = BehaviourScheduler::Get(ActiveScene->Registry());
+	for (int step = 0; step < fixedSteps; step++) {
+		TransformSystem::BeginFixedStep();
+		behaviours.FixedUpdate(Jobs.get());
+		TransformSystem::EndFixedStep();
+	}
+	// Thread safe types get spread over the job system
+	behaviours.Update(Jobs.get());
+	behaviours.LateUpdate(Jobs.get());
+
+	TransformSystem::Interpolate(time.FixedAlpha);
+}
@@ -0,0 +1,76 @@
+#include "BehaviourScheduler.h"
+#include "IBehaviour.h"
+
+BehaviourScheduler::BehaviourScheduler(entt::registry& registry) :
+	_registry(registry)
+{
+	// We live in the registry's context, so we go away with its signals and never need to disconnect
+	registry.on_construct<BehaviourBinding>().connect<&BehaviourScheduler::_OnBindingConstructed>(*this);
+	registry.on_destroy<BehaviourBinding>().connect<&BehaviourScheduler::_OnBindingDestroyed>(*this);
+}
+
+void BehaviourScheduler::Add(entt::entity entity, uint32_t type, const std::shared_ptr<IBehaviour>& behaviour) {
+	if (type >= _pools.size()) {
+		_pools.resize(type + 1);
+	}
+	if (_pools[type] == nullptr) {
+		_pools[type] = _Factories()[type]();
+		_updateOrder.push_back(type);
+	}
+	_pools[type]->Add(entity, behaviour);
+}
+
+void BehaviourScheduler::Update(JobSystem* jobs) {
+	for (uint32_t type : _updateOrder) {
+		_pools[type]->Update(_registry, jobs);
+	}
+}
+
+void BehaviourScheduler::FixedUpdate(JobSystem* jobs) {
+	for (uint32_t type : _updateOrder) {
+		_pools[type]->FixedUpdate(_registry, jobs);
+	}
+}
+
+void BehaviourScheduler::LateUpdate(JobSystem* jobs) {
+	for (uint32_t type : _updateOrder) {
+		_pools[type]->LateUpdate(_registry, jobs);
+	}
+}
+
+size_t BehaviourScheduler::GetBehaviourCount() const {
+	size_t count = 0;
+	for (uint32_t type : _updateOrder) {
+		count += _pools[type]->Size();
+	}
+	return count;
+}
+
+uint32_t BehaviourScheduler::_RegisterType(PoolFactory factory) {
+	std::vector<PoolFactory>& factories = _Factories();
+	factories.push_back(factory);
+	return (uint32_t)(factories.size() - 1);
+}
+
+std::vector<BehaviourScheduler::PoolFactory>& BehaviourScheduler::_Factories() {
+	static std::vector<PoolFactory> factories;
+	return factories;
+}
+
+void BehaviourScheduler::_OnBindingConstructed(entt::registry& registry, entt::entity entity) {
+	const BehaviourBinding& binding = registry.get<BehaviourBinding>(entity);
+	for (size_t ix = 0; ix < binding.Behaviours.size(); ix++) {
+		Add(entity, binding.Types[ix], binding.Behaviours[ix]);
+	}
+}
+
+void BehaviourScheduler::_OnBindingDestroyed(entt::registry& registry, entt::entity entity) {
+	const BehaviourBinding& binding = registry.get<BehaviourBinding>(entity);
+	for (size_t ix = 0; ix < binding.Behaviours.size(); ix++) {
+		// The binding could have been made before we were around to see it
+		uint32_t type = binding.Types[ix];
+		if (type < _pools.size() && _pools[type] != nullptr) {
+			_pools[type]->Remove(entity, binding.Behaviours[ix].get());
+		}
+	}
+}
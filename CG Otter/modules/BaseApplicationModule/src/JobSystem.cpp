@@ -0,0 +1,182 @@
+#include "JobSystem.h"
+
+// Which system and worker the current thread belongs to, main and outside threads share worker 0
+static thread_local JobSystem* t_system = nullptr;
+static thread_local unsigned t_worker = 0;
+// Counter of the job the current thread is running
+static thread_local JobCounter* t_counter = nullptr;
+
+JobSystem::JobSystem(unsigned numWorkers) :
+	_mainThread(std::this_thread::get_id())
+{
+	if (numWorkers == 0) {
+		// hardware_concurrency can give back 0 if it doesn't know
+		unsigned cores = std::thread::hardware_concurrency();
+		numWorkers = cores > 1 ? cores - 1 : 1;
+	}
+
+	// Slot 0 belongs to the main thread, it never gets its own thread
+	for (unsigned i = 0; i <= numWorkers; i++) {
+		_workers.push_back(std::make_unique<Worker>());
+	}
+	for (unsigned i = 1; i <= numWorkers; i++) {
+		_threads.emplace_back(&JobSystem::_WorkerLoop, this, i);
+	}
+}
+
+JobSystem::~JobSystem() {
+	{
+		std::lock_guard<std::mutex> lock(_wakeMutex);
+		_stopping = true;
+	}
+	_wake.notify_all();
+
+	for (std::thread& thread : _threads) {
+		thread.join();
+	}
+}
+
+void JobSystem::Run(std::function<void()> job, JobCounter* counter) {
+	if (counter != nullptr) {
+		counter->Value.fetch_add(1, std::memory_order_relaxed);
+	}
+	Worker& worker = *_workers[_CurrentWorker()];
+	{
+		std::lock_guard<std::mutex> lock(worker.Mutex);
+		worker.Jobs.push_back({ std::move(job), counter });
+	}
+	_queued.fetch_add(1, std::memory_order_release);
+	_Wake();
+}
+
+void JobSystem::RunOnMainThread(std::function<void()> job, JobCounter* counter) {
+	if (counter != nullptr) {
+		counter->Value.fetch_add(1, std::memory_order_relaxed);
+	}
+	std::lock_guard<std::mutex> lock(_mainMutex);
+	_mainJobs.push_back({ std::move(job), counter });
+}
+
+void JobSystem::Wait(JobCounter& counter) {
+	unsigned index = _CurrentWorker();
+	while (!counter.IsDone()) {
+		Job job;
+		if (_TryGetJob(index, job)) {
+			_Execute(job);
+		} else {
+			// Whatever we're waiting on is running somewhere else
+			std::this_thread::yield();
+		}
+	}
+}
+
+unsigned JobSystem::PumpMainThread() {
+	// Take the whole queue at once, jobs that queue more main thread work get picked up next time
+	std::deque<Job> jobs;
+	{
+		std::lock_guard<std::mutex> lock(_mainMutex);
+		jobs.swap(_mainJobs);
+	}
+	for (Job& job : jobs) {
+		_Execute(job);
+	}
+	return (unsigned)jobs.size();
+}
+
+void JobSystem::ParallelFor(unsigned count, unsigned grainSize, const std::function<void(unsigned begin, unsigned end)>& func) {
+	if (count == 0) {
+		return;
+	}
+	grainSize = std::max(grainSize, 1u);
+	unsigned numChunks = (count + grainSize - 1) / grainSize;
+	if (numChunks == 1 || _threads.empty()) {
+		func(0, count);
+		return;
+	}
+
+	JobCounter counter;
+	for (unsigned chunk = 1; chunk < numChunks; chunk++) {
+		unsigned begin = chunk * grainSize;
+		unsigned end = std::min(count, begin + grainSize);
+		Run([&func, begin, end]() { func(begin, end); }, &counter);
+	}
+	// Do the first chunk ourselves, then help with the rest
+	func(0, std::min(count, grainSize));
+	Wait(counter);
+}
+
+JobCounter* JobSystem::CurrentCounter() {
+	return t_counter;
+}
+
+void JobSystem::_WorkerLoop(unsigned index) {
+	t_system = this;
+	t_worker = index;
+
+	while (true) {
+		Job job;
+		if (_TryGetJob(index, job)) {
+			_Execute(job);
+			continue;
+		}
+
+		std::unique_lock<std::mutex> lock(_wakeMutex);
+		_wake.wait(lock, [this]() { return _stopping || _queued.load(std::memory_order_acquire) > 0; });
+		if (_stopping) {
+			return;
+		}
+	}
+}
+
+bool JobSystem::_TryGetJob(unsigned index, Job& job) {
+	// Our own deque first, newest job first since its data is most likely still in cache
+	{
+		Worker& own = *_workers[index];
+		std::lock_guard<std::mutex> lock(own.Mutex);
+		if (!own.Jobs.empty()) {
+			job = std::move(own.Jobs.back());
+			own.Jobs.pop_back();
+			_queued.fetch_sub(1, std::memory_order_relaxed);
+			return true;
+		}
+	}
+
+	// Steal the oldest job from someone else, starting after ourselves so everyone doesn't pick on the same worker
+	unsigned count = (unsigned)_workers.size();
+	for (unsigned i = 1; i < count; i++) {
+		Worker& victim = *_workers[(index + i) % count];
+		std::lock_guard<std::mutex> lock(victim.Mutex);
+		if (!victim.Jobs.empty()) {
+			job = std::move(victim.Jobs.front());
+			victim.Jobs.pop_front();
+			_queued.fetch_sub(1, std::memory_order_relaxed);
+			_steals.fetch_add(1, std::memory_order_relaxed);
+			return true;
+		}
+	}
+	return false;
+}
+
+void JobSystem::_Execute(Job& job) {
+	// Nested jobs can run inside Wait, so put back whatever was running before
+	JobCounter* previous = t_counter;
+	t_counter = job.Counter;
+	job.Func();
+	t_counter = previous;
+
+	if (job.Counter != nullptr) {
+		job.Counter->Value.fetch_sub(1, std::memory_order_release);
+	}
+}
+
+unsigned JobSystem::_CurrentWorker() const {
+	return t_system == this ? t_worker : 0;
+}
+
+void JobSystem::_Wake() {
+	// Taking the lock means a worker can't miss this between checking _queued and going to sleep
+	{
+		std::lock_guard<std::mutex> lock(_wakeMutex);
+	}
+	_wake.notify_one();
+}
@@ -2,6 +2,7 @@
 
 #include "Transform.h"
 #include "GameObjectTag.h"
+#include "BehaviourScheduler.h"
 #include "LoggingBase.h"
 
 entt::registry GameScene::_prefabRegistry;
@@ -12,6 +13,8 @@ GameScene::GameScene(const std::string& name) {
 
 	RegisterComponentType<Transform>();
 	RegisterComponentType<GameObjectTag>();
+	// Behaviours that StampEntity copies in need the scheduler listening before they arrive
+	BehaviourScheduler::Get(_registry);
 }
 
 entt::handle GameScene::CreateEntity(const std::string& name) {
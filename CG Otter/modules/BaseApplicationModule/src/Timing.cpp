@@ -0,0 +1,24 @@
+#include "Timing.h"
+#include <algorithm>
+
+int Timing::Advance(double now) {
+	CurrentFrame = now;
+	DeltaTime = static_cast<float>(CurrentFrame - LastFrame);
+	DeltaTime = DeltaTime > 1.0f ? 1.0f : DeltaTime;
+	LastFrame = CurrentFrame;
+
+	FixedAccumulator += DeltaTime;
+	FixedSteps = static_cast<int>(FixedAccumulator / FixedTimeStep);
+	if (FixedSteps > MaxFixedSteps) {
+		// We can't keep up, give up on the time we won't get to instead of carrying it into the next frame
+		double kept = static_cast<double>(MaxFixedSteps) * FixedTimeStep;
+		DroppedTime += FixedAccumulator - kept;
+		FixedAccumulator = kept;
+		FixedSteps = MaxFixedSteps;
+	}
+	FixedAccumulator -= static_cast<double>(FixedSteps) * FixedTimeStep;
+	// Rounding can leave us a hair under zero
+	FixedAccumulator = std::max(FixedAccumulator, 0.0);
+	FixedAlpha = static_cast<float>(FixedAccumulator / FixedTimeStep);
+	return FixedSteps;
+}
@@ -66,6 +66,15 @@ public:
 	/// Sets the vertical field of view in degrees for this camera
 	/// </summary>
 	void SetFovDegrees(float value);
+	/// <summary>
+	/// Sets a sub-pixel offset that gets baked into the projection matrix, used for temporal anti-aliasing
+	/// </summary>
+	/// <param name="jitter">The offset in normalized device coordinates (2 / width is one pixel)</param>
+	void SetJitter(const glm::vec2& jitter);
+	/// <summary>
+	/// Gets the sub-pixel offset currently applied to the projection matrix, in normalized device coordinates
+	/// </summary>
+	const glm::vec2& GetJitter() const { return _jitter; }
 
 	/// <summary>
 	/// Gets the camera's position in world space
@@ -112,6 +121,7 @@ protected:
 	glm::vec3 _position;
 	glm::vec3 _normal;
 	glm::vec3 _up;
+	glm::vec2 _jitter;
 
 	glm::mat4 _view;
 	glm::mat4 _projection;
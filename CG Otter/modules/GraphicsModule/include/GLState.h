@@ -0,0 +1,129 @@
+#pragma once
+#include <glad/glad.h>
+
+/// <summary>
+/// Keeps a shadow copy of the OpenGL binding and render state we care about, so
+/// setting something that is already set never reaches the driver
+///
+/// Everything that binds a program, VAO, framebuffer, texture, sampler, uniform buffer, or changes
+/// depth/blend/cull state should go through here, otherwise the shadow copy goes stale
+/// </summary>
+class GLState
+{
+public:
+	/// <summary>
+	/// How many texture and sampler units we shadow, anything above this is passed straight through
+	/// </summary>
+	static const int MAX_TRACKED_UNITS = 32;
+	/// <summary>
+	/// How many uniform buffer binding points we shadow
+	/// </summary>
+	static const int MAX_TRACKED_BUFFERS = 16;
+
+	/// <summary>
+	/// Binds a shader program, skipped if it's already bound
+	/// </summary>
+	static void UseProgram(GLuint program);
+	/// <summary>
+	/// Binds a vertex array object, skipped if it's already bound
+	/// </summary>
+	static void BindVertexArray(GLuint vao);
+	/// <summary>
+	/// Binds a framebuffer to GL_FRAMEBUFFER, GL_READ_FRAMEBUFFER or GL_DRAW_FRAMEBUFFER,
+	/// skipped if it's already bound there
+	/// </summary>
+	static void BindFramebuffer(GLenum target, GLuint fbo);
+	/// <summary>
+	/// Binds a texture to a texture unit using glBindTextureUnit, 0 unbinds the unit
+	/// </summary>
+	static void BindTexture(int unit, GLuint texture);
+	/// <summary>
+	/// Binds a sampler object to a texture unit, 0 goes back to the texture's own parameters
+	/// </summary>
+	static void BindSampler(int unit, GLuint sampler);
+	/// <summary>
+	/// Binds a range of a buffer to a GL_UNIFORM_BUFFER binding point, skipped if that exact range is already bound there
+	/// </summary>
+	static void BindUniformBuffer(int binding, GLuint buffer, GLintptr offset, GLsizeiptr size);
+
+	/// <summary>
+	/// Enables or disables a capability, GL_DEPTH_TEST, GL_BLEND, GL_CULL_FACE,
+	/// GL_SCISSOR_TEST and GL_STENCIL_TEST are shadowed, anything else is passed straight through
+	/// </summary>
+	static void SetEnabled(GLenum capability, bool enabled);
+	static void Enable(GLenum capability) { SetEnabled(capability, true); }
+	static void Disable(GLenum capability) { SetEnabled(capability, false); }
+
+	static void DepthFunc(GLenum func);
+	static void DepthMask(bool write);
+	static void BlendFunc(GLenum source, GLenum destination);
+	static void CullFace(GLenum face);
+
+	/// <summary>
+	/// Has to be called before deleting an object, GL is free to hand the name back out
+	/// and we'd skip binding the new object thinking it's the old one
+	/// </summary>
+	static void OnProgramDeleted(GLuint program);
+	static void OnVertexArrayDeleted(GLuint vao);
+	static void OnFramebufferDeleted(GLuint fbo);
+	static void OnTextureDeleted(GLuint texture);
+	static void OnSamplerDeleted(GLuint sampler);
+	static void OnBufferDeleted(GLuint buffer);
+
+	/// <summary>
+	/// Forgets everything, the next call of each kind always goes through.
+	/// Use this after handing the context to code that doesn't go through GLState
+	/// </summary>
+	static void Invalidate();
+
+	/// <summary>
+	/// Rolls the counters over, the getters report the frame that just finished
+	/// </summary>
+	static void BeginFrame();
+	/// <summary>
+	/// Gets how many state calls went through to OpenGL last frame
+	/// </summary>
+	static unsigned GetIssuedCount() { return _lastIssued; }
+	/// <summary>
+	/// Gets how many state calls were skipped last frame because nothing would have changed
+	/// </summary>
+	static unsigned GetElidedCount() { return _lastElided; }
+
+private:
+	// Marks a binding we don't know the value of
+	static const GLuint UNKNOWN = ~0u;
+
+	enum Capability {
+		DepthTest,
+		Blend,
+		CullFaceCap,
+		ScissorTest,
+		StencilTest,
+		CapabilityCount
+	};
+	// Index into _capabilities, or -1 if the capability isn't shadowed
+	static int _CapabilityIndex(GLenum capability);
+	// Counts the call and returns true if it needs to go through
+	static bool _Changed(GLuint& cached, GLuint value);
+
+	static GLuint _program;
+	static GLuint _vao;
+	static GLuint _readFramebuffer;
+	static GLuint _drawFramebuffer;
+	static GLuint _textures[MAX_TRACKED_UNITS];
+	static GLuint _samplers[MAX_TRACKED_UNITS];
+	static GLuint _capabilities[CapabilityCount];
+	static GLuint _uniformBuffers[MAX_TRACKED_BUFFERS];
+	static GLintptr _uniformOffsets[MAX_TRACKED_BUFFERS];
+	static GLsizeiptr _uniformSizes[MAX_TRACKED_BUFFERS];
+	static GLuint _depthFunc;
+	static GLuint _depthMask;
+	static GLuint _blendSource;
+	static GLuint _blendDestination;
+	static GLuint _cullFace;
+
+	static unsigned _issued;
+	static unsigned _elided;
+	static unsigned _lastIssued;
+	static unsigned _lastElided;
+};
@@ -0,0 +1,114 @@
+#pragma once
+#include <glad/glad.h>
+#include <memory>
+#include <vector>
+#include <algorithm>
+#include <typeindex>
+#include <unordered_map>
+
+#include "VertexBuffer.h"
+#include "IndexBuffer.h"
+#include "VertexArrayObject.h"
+
+/// <summary>
+/// A GeometryArena is one large vertex buffer and one large index buffer that many meshes of the same vertex format
+/// are packed into. Since every mesh shares the same buffers, they can all be drawn from one VAO, which is what lets
+/// us batch them together with glMultiDrawElementsIndirect
+/// </summary>
+class GeometryArena final
+{
+public:
+	typedef std::shared_ptr<GeometryArena> sptr;
+	static inline sptr Create(size_t vertexSize, const std::vector<BufferAttribute>& attributes, size_t vertexCapacity, size_t indexCapacity) {
+		return std::make_shared<GeometryArena>(vertexSize, attributes, vertexCapacity, indexCapacity);
+	}
+	// We'll disallow moving and copying, since we want to manually control when the destructor is called
+	// We'll use these classes via pointers
+	GeometryArena(const GeometryArena& other) = delete;
+	GeometryArena(GeometryArena&& other) = delete;
+	GeometryArena& operator=(const GeometryArena& other) = delete;
+	GeometryArena& operator=(GeometryArena&& other) = delete;
+
+	/// <summary>
+	/// The default size of a new arena, meshes bigger than this get an arena sized to fit them
+	/// </summary>
+	static const size_t DEFAULT_VERTEX_CAPACITY = 256 * 1024;
+	static const size_t DEFAULT_INDEX_CAPACITY = 1024 * 1024;
+
+public:
+	/// <summary>
+	/// Creates a new arena, allocating storage for the given number of vertices and indices up front
+	/// </summary>
+	/// <param name="vertexSize">The size of a single vertex, in bytes</param>
+	/// <param name="attributes">The vertex declaration for the vertex format stored in this arena</param>
+	/// <param name="vertexCapacity">The maximum number of vertices this arena can hold</param>
+	/// <param name="indexCapacity">The maximum number of indices this arena can hold</param>
+	GeometryArena(size_t vertexSize, const std::vector<BufferAttribute>& attributes, size_t vertexCapacity, size_t indexCapacity);
+	~GeometryArena() = default;
+
+	/// <summary>
+	/// Copies a mesh into the arena, and returns a VAO that will draw just that mesh
+	/// </summary>
+	/// <param name="vertices">A pointer to the vertex data to copy in</param>
+	/// <param name="vertexCount">The number of vertices to copy</param>
+	/// <param name="indices">A pointer to the indices to copy in, relative to the first vertex of this mesh</param>
+	/// <param name="indexCount">The number of indices to copy</param>
+	/// <returns>The VAO for the mesh, or nullptr if the arena does not have enough room left</returns>
+	VertexArrayObject::sptr Allocate(const void* vertices, size_t vertexCount, const uint32_t* indices, size_t indexCount);
+
+	/// <summary>
+	/// Returns the VAO that covers the whole arena, used for multi-draw calls
+	/// </summary>
+	const VertexArrayObject::sptr& GetVAO() const { return _vao; }
+	/// <summary>
+	/// Returns the number of vertices that have been allocated so far
+	/// </summary>
+	size_t GetVertexCount() const { return _vertexCount; }
+	/// <summary>
+	/// Returns the number of indices that have been allocated so far
+	/// </summary>
+	size_t GetIndexCount() const { return _indexCount; }
+
+	/// <summary>
+	/// Bakes a mesh into the current arena for it's vertex type, starting a new arena if the current one is full
+	/// </summary>
+	/// <typeparam name="VertType">The vertex type of the mesh, must have a V_DECL</typeparam>
+	template <typename VertType>
+	static VertexArrayObject::sptr Bake(const VertType* vertices, size_t vertexCount, const uint32_t* indices, size_t indexCount) {
+		// There is one current arena per vertex type
+		sptr& current = _current[std::type_index(typeid(VertType))];
+		VertexArrayObject::sptr result = current != nullptr ? current->Allocate(vertices, vertexCount, indices, indexCount) : nullptr;
+		if (result == nullptr) {
+			// Meshes from the old arena hold onto it's buffers, so we can just let go of it
+			current = Create(sizeof(VertType), VertType::V_DECL,
+				std::max(DEFAULT_VERTEX_CAPACITY, vertexCount), std::max(DEFAULT_INDEX_CAPACITY, indexCount));
+			result = current->Allocate(vertices, vertexCount, indices, indexCount);
+		}
+		return result;
+	}
+
+	/// <summary>
+	/// Lets go of the arenas meshes are being baked into, has to happen while the context is still alive.
+	/// Meshes already baked keep their arena's buffers. Resources::Unload calls this for you
+	/// </summary>
+	static void Unload();
+
+protected:
+	// The arena each vertex type is baking into, see Bake
+	static std::unordered_map<std::type_index, sptr> _current;
+
+	// The shared buffers that every mesh in this arena sub-allocates from
+	VertexBuffer::sptr _vertexBuffer;
+	IndexBuffer::sptr _indexBuffer;
+	// A VAO over the whole arena
+	VertexArrayObject::sptr _vao;
+	// The vertex declaration, so that we can make VAOs for the meshes in this arena
+	std::vector<BufferAttribute> _attributes;
+
+	size_t _vertexSize;
+	size_t _vertexCapacity;
+	size_t _indexCapacity;
+	// The number of vertices and indices handed out so far
+	size_t _vertexCount;
+	size_t _indexCount;
+};
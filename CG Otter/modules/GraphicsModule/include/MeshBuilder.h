@@ -1,6 +1,7 @@
 #pragma once
 #include <vector>
 #include <VertexArrayObject.h>
+#include <GeometryArena.h>
 
 template <typename VertType>
 class MeshBuilder
@@ -81,17 +82,14 @@ public:
 	/// </summary>
 	size_t GetTriangleCount() const { return _indices.size() > 0 ? _indices.size() / 3 : _vertices.size() / 3; }
 
+	/// <summary>
+	/// Uploads the mesh to the GPU. Indexed meshes get packed into the shared GeometryArena for their vertex type
+	/// </summary>
 	VertexArrayObject::sptr Bake() {
-		VertexBuffer::sptr vbo = VertexBuffer::Create();
-		vbo->LoadData(GetVertexDataPtr(), _vertices.size());
-
-		IndexBuffer::sptr ebo = IndexBuffer::Create();
-		ebo->LoadData(GetIndexDataPtr(), _indices.size());
-
-		VertexArrayObject::sptr result = VertexArrayObject::Create();
-		result->AddVertexBuffer(vbo, VertType::V_DECL);
-		result->SetIndexBuffer(ebo);
-
+		VertexArrayObject::sptr result = _indices.size() > 0 ?
+			GeometryArena::Bake(GetVertexDataPtr(), _vertices.size(), GetIndexDataPtr(), _indices.size()) :
+			BakeUnindexed();
+		ApplyBounds(result);
 		return result;
 	}
 	
@@ -112,6 +110,46 @@ public:
 	
 protected:
 	friend class MeshFactory;
+
+	/// <summary>
+	/// Gives the mesh it's own buffers, for meshes with no index data
+	/// </summary>
+	VertexArrayObject::sptr BakeUnindexed() {
+		VertexBuffer::sptr vbo = VertexBuffer::Create();
+		vbo->LoadData(GetVertexDataPtr(), _vertices.size());
+
+		IndexBuffer::sptr ebo = IndexBuffer::Create();
+		ebo->LoadData(GetIndexDataPtr(), _indices.size());
+
+		VertexArrayObject::sptr result = VertexArrayObject::Create();
+		result->AddVertexBuffer(vbo, VertType::V_DECL);
+		result->SetIndexBuffer(ebo);
+
+		return result;
+	}
+
+	/// <summary>
+	/// Works out the bounding box and bounding sphere of the vertices and stores them on the VAO
+	/// </summary>
+	void ApplyBounds(const VertexArrayObject::sptr& vao) const {
+		if (_vertices.size() == 0) {
+			return;
+		}
+		glm::vec3 min = _vertices[0].Position;
+		glm::vec3 max = _vertices[0].Position;
+		for (const VertType& vertex : _vertices) {
+			min = glm::min(min, vertex.Position);
+			max = glm::max(max, vertex.Position);
+		}
+		// The sphere shares the box's center, so culling only needs the one center point
+		glm::vec3 center = (min + max) * 0.5f;
+		float radiusSq = 0.0f;
+		for (const VertType& vertex : _vertices) {
+			glm::vec3 offset = vertex.Position - center;
+			radiusSq = glm::max(radiusSq, glm::dot(offset, offset));
+		}
+		vao->SetBounds(min, max, glm::sqrt(radiusSq));
+	}
 	
 	std::vector<VertType> _vertices;
 	std::vector<uint32_t> _indices;
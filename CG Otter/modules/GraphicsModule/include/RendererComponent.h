@@ -1,12 +1,23 @@
 #pragma once
 #include <VertexArrayObject.h>
 #include <ShaderMaterial.h>
+#include <Resources.h>
 
 class RendererComponent {
 public:
-	VertexArrayObject::sptr Mesh;
-	ShaderMaterial::sptr    Material;
+	// Handles into Resources, the pools own the mesh and material so copying these is free
+	MeshHandle              Mesh;
+	MaterialHandle          Material;
+	// The world transform this was drawn with last frame, used to generate motion vectors
+	glm::mat4               PrevWorld = glm::mat4(1.0f);
+	// Packed render sort key, minus the depth bits, only rebuilt when SortKeyDirty is set
+	// If you change Mesh, Material or the material's layer or shader directly, set SortKeyDirty
+	uint64_t                SortKey = 0;
+	bool                    SortKeyDirty = true;
 
-	RendererComponent& SetMesh(const VertexArrayObject::sptr& mesh) { Mesh = mesh; return *this; }
-	RendererComponent& SetMaterial(const ShaderMaterial::sptr& material) { Material = material; return *this; }
+	RendererComponent& SetMesh(MeshHandle mesh) { Mesh = mesh; SortKeyDirty = true; return *this; }
+	RendererComponent& SetMaterial(MaterialHandle material) { Material = material; SortKeyDirty = true; return *this; }
+	// These add the mesh or material to its pool if it isn't there yet
+	RendererComponent& SetMesh(const VertexArrayObject::sptr& mesh) { return SetMesh(Resources::Meshes.Add(mesh)); }
+	RendererComponent& SetMaterial(const ShaderMaterial::sptr& material) { return SetMaterial(Resources::Materials.Add(material)); }
 };
\ No newline at end of file
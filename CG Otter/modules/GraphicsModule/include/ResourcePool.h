@@ -0,0 +1,171 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include <unordered_map>
+
+/// <summary>
+/// A reference to something in a ResourcePool, just an index and a generation
+///
+/// Copying one is free, unlike a shared_ptr which bumps an atomic refcount every time. The generation
+/// goes up whenever a slot gets reused, so a handle to something that was removed stops resolving
+/// instead of quietly pointing at whatever took its place
+/// </summary>
+template <typename T>
+struct Handle {
+	uint32_t Index = 0;
+	// Pools never hand out generation 0, so a default handle is always null
+	uint32_t Generation = 0;
+
+	bool IsValid() const { return Generation != 0; }
+	bool operator ==(const Handle& other) const { return Index == other.Index && Generation == other.Generation; }
+	bool operator !=(const Handle& other) const { return !(*this == other); }
+};
+
+/// <summary>
+/// Owns a set of resources and hands out handles to them
+///
+/// Handles index a slot table, and the slots point into dense arrays so the live resources
+/// always sit next to each other. Resolving a handle is two array reads and a compare, and
+/// never touches the refcount of the shared_ptr the pool is holding on to
+/// </summary>
+template <typename T>
+class ResourcePool {
+public:
+	typedef std::shared_ptr<T> sptr;
+
+	ResourcePool() = default;
+	~ResourcePool() = default;
+	ResourcePool(const ResourcePool& other) = delete;
+	ResourcePool& operator=(const ResourcePool& other) = delete;
+
+	/// <summary>
+	/// Takes a reference to a resource and returns its handle, adding the same resource twice returns the same handle
+	/// </summary>
+	/// <returns>The handle, or a null handle if resource is nullptr</returns>
+	Handle<T> Add(const sptr& resource) {
+		if (resource == nullptr) {
+			return Handle<T>();
+		}
+		auto it = _lookup.find(resource.get());
+		if (it != _lookup.end()) {
+			return Handle<T>{ it->second, _slots[it->second].Generation };
+		}
+
+		uint32_t slot;
+		if (_freeSlots.empty()) {
+			slot = (uint32_t)_slots.size();
+			_slots.push_back({ 0, 1 });
+		} else {
+			slot = _freeSlots.back();
+			_freeSlots.pop_back();
+		}
+		_slots[slot].Dense = (uint32_t)_items.size();
+		_items.push_back(resource.get());
+		_owners.push_back(resource);
+		_denseSlots.push_back(slot);
+		_lookup[resource.get()] = slot;
+		return Handle<T>{ slot, _slots[slot].Generation };
+	}
+
+	/// <summary>
+	/// Resolves a handle, this is the one to use in hot loops
+	/// </summary>
+	/// <returns>The resource, or nullptr if the handle is null or stale</returns>
+	T* Get(Handle<T> handle) const {
+		if (handle.Index >= _slots.size()) {
+			return nullptr;
+		}
+		const Slot& slot = _slots[handle.Index];
+		return slot.Generation == handle.Generation ? _items[slot.Dense] : nullptr;
+	}
+	/// <summary>
+	/// Resolves a handle to the shared_ptr the pool owns, for code that needs to keep the resource around
+	/// </summary>
+	const sptr& GetShared(Handle<T> handle) const {
+		static const sptr empty;
+		T* item = Get(handle);
+		return item != nullptr ? _owners[_slots[handle.Index].Dense] : empty;
+	}
+	/// <summary>
+	/// Finds the handle for a resource that's already in the pool
+	/// </summary>
+	/// <returns>The handle, or a null handle if the resource was never added</returns>
+	Handle<T> Find(const T* resource) const {
+		auto it = _lookup.find(resource);
+		return it != _lookup.end() ? Handle<T>{ it->second, _slots[it->second].Generation } : Handle<T>();
+	}
+
+	/// <summary>
+	/// Drops the pool's reference to a resource, every handle to it goes stale
+	/// </summary>
+	/// <returns>True if the handle was still live</returns>
+	bool Remove(Handle<T> handle) {
+		if (Get(handle) == nullptr) {
+			return false;
+		}
+		uint32_t dense = _slots[handle.Index].Dense;
+		uint32_t last = (uint32_t)_items.size() - 1;
+		_lookup.erase(_items[dense]);
+
+		// Move the last resource into the hole so the arrays stay packed
+		if (dense != last) {
+			_items[dense] = _items[last];
+			_owners[dense] = std::move(_owners[last]);
+			_denseSlots[dense] = _denseSlots[last];
+			_slots[_denseSlots[dense]].Dense = dense;
+		}
+		_items.pop_back();
+		_owners.pop_back();
+		_denseSlots.pop_back();
+
+		_Retire(handle.Index);
+		return true;
+	}
+	/// <summary>
+	/// Drops every resource in the pool, handles from before this all go stale
+	/// </summary>
+	void Clear() {
+		for (uint32_t slot : _denseSlots) {
+			_Retire(slot);
+		}
+		_lookup.clear();
+		_items.clear();
+		_denseSlots.clear();
+		// Last, in case a destructor goes looking for something in here
+		_owners.clear();
+	}
+
+	size_t Size() const { return _items.size(); }
+	/// <summary>
+	/// The live resources, packed together in no particular order
+	/// </summary>
+	const std::vector<T*>& GetItems() const { return _items; }
+
+private:
+	struct Slot {
+		// Where the slot's resource is in the dense arrays
+		uint32_t Dense;
+		uint32_t Generation;
+	};
+
+	/// <summary>
+	/// Bumps a slot's generation and puts it up for reuse
+	/// </summary>
+	void _Retire(uint32_t slot) {
+		// Skip 0 when it wraps around, that's the null generation
+		if (++_slots[slot].Generation == 0) {
+			_slots[slot].Generation = 1;
+		}
+		_freeSlots.push_back(slot);
+	}
+
+	std::vector<Slot>     _slots;
+	std::vector<uint32_t> _freeSlots;
+	// Dense arrays, all in the same order
+	std::vector<T*>       _items;
+	std::vector<sptr>     _owners;
+	std::vector<uint32_t> _denseSlots;
+	// Only used when adding, so the same resource always gets the same handle
+	std::unordered_map<const T*, uint32_t> _lookup;
+};
@@ -0,0 +1,33 @@
+#pragma once
+#include "ResourcePool.h"
+#include "Shader.h"
+#include "ShaderMaterial.h"
+#include "VertexArrayObject.h"
+#include "Texture2D.h"
+
+typedef Handle<Shader>            ShaderHandle;
+typedef Handle<ShaderMaterial>    MaterialHandle;
+typedef Handle<VertexArrayObject> MeshHandle;
+typedef Handle<Texture2D>         TextureHandle;
+
+/// <summary>
+/// The pools that own the resources renderers point at
+///
+/// Components hold handles into these instead of shared_ptrs, so drawing a frame never
+/// touches a refcount. Anything added here lives until it's removed or Unload is called
+/// </summary>
+class Resources
+{
+public:
+	static ResourcePool<Shader>            Shaders;
+	static ResourcePool<ShaderMaterial>    Materials;
+	static ResourcePool<VertexArrayObject> Meshes;
+	static ResourcePool<Texture2D>         Textures;
+
+	/// <summary>
+	/// Releases everything in the pools, has to happen while the context is still alive.
+	/// Materials go first since they're holding on to shaders and textures. The arenas
+	/// meshes get baked into go with the meshes
+	/// </summary>
+	static void Unload();
+};
@@ -4,14 +4,38 @@
 
 #include <string>               // for std::string
 #include <unordered_map>        // for std::unordered_map
+#include <unordered_set>        // for std::unordered_set
+#include <vector>               // for std::vector
 #include <GLM/glm.hpp>          // for our GLM types
 #include <GLM/gtc/type_ptr.hpp> // for glm::value_ptr
 #include "Logging.h"            // for the logging functions
+#include "UniformId.h"          // for hashed uniform names
+
+/// <summary>
+/// Where one member of a shader's material block lives in the block's std140 layout
+/// </summary>
+struct MaterialBlockMember {
+	GLint  Offset;
+	GLenum Type;
+	// Bytes from one column to the next, only meaningful for matrices
+	GLint  MatrixStride;
+};
+
+/// <summary>
+/// The layout of the "MaterialBlock" uniform block, read back from the program after it links
+/// </summary>
+struct MaterialBlockLayout {
+	// The binding point the shader declared the block at, -1 if the shader has no material block
+	GLint Binding = -1;
+	// Size of the whole block in bytes, padding included
+	GLint Size = 0;
+	std::unordered_map<std::string, MaterialBlockMember> Members;
+};
 
 /// <summary>
 /// This class will wrap around an OpenGL shader program
 /// </summary>
-class Shader final
+class Shader final : public std::enable_shared_from_this<Shader>
 {
 public:
 	typedef std::shared_ptr<Shader> sptr;
@@ -42,6 +66,7 @@ public:
 	/// <param name="source">The source code of the shader to load</param>
 	/// <param name="type">The stage to load (GL_VERTEX_SHADER or GL_FRAGMENT_SHADER)</param>
 	/// <returns>True if the shader is loaded, false if there was an issue</returns>
+	/// <remarks>Stages aren't compiled until Link, and not at all if the program binary cache has the program</remarks>
 	bool LoadShaderPart(const char* source, GLenum type);
 	/// <summary>
 	/// Loads a single shader stage into this shader object (ex: Vertex Shader or Fragment Shader) from an external file (in res)
@@ -54,7 +79,8 @@ public:
 	/// <summary>
 	/// Links the vertex and fragment shader, and allows this shader program to be used
 	/// </summary>
-	/// <returns>True if the linking was sucessful, false if otherwise</returns>
+	/// <returns>True if the linking was sucessful, false if otherwise. Inside a ShaderLibrary batch this
+	/// is always true, the program is checked the first time it gets used instead</returns>
 	bool Link();
 
 	/// <summary>
@@ -70,16 +96,77 @@ public:
 	/// Gets the underlying OpenGL handle that this class is wrapping
 	/// </summary>
 	GLuint GetHandle() const { return _handle; }
+
+	/// <summary>
+	/// Name of the uniform block materials write their parameters into
+	/// </summary>
+	static constexpr const char* MATERIAL_BLOCK_NAME = "MaterialBlock";
+	/// <summary>
+	/// Gets the layout of this shader's material block, the binding is -1 if it doesn't declare one
+	/// </summary>
+	const MaterialBlockLayout& GetMaterialBlockLayout() { _Resolve(); return _materialBlock; }
+	/// <summary>
+	/// Gets the texture unit a sampler uniform reads from. Samplers without a layout(binding) get
+	/// the next free unit the first time they're asked for, so every material using this shader
+	/// agrees on where each texture goes. Variants share units with the shader they were built from,
+	/// so ask the program you're drawing with, samplers behind a keyword are only in its variants
+	/// </summary>
+	/// <param name="name">The name of the sampler uniform</param>
+	/// <returns>The texture unit, or -1 if the sampler isn't in this program</returns>
+	int GetSamplerUnit(const std::string& name);
+
+	/// <summary>
+	/// Gets this shader built with a set of keywords #defined in both stages, so the source can
+	/// use #ifdef instead of branching on uniforms. Each keyword set is only built once, and keywords
+	/// the source never mentions are ignored so they don't make pointless copies of the program.
+	/// Variants start with this shader's uniform values, and anything set on this shader by name
+	/// or UniformId afterwards is passed on to them
+	/// </summary>
+	/// <param name="keywords">The keywords to define, in any order</param>
+	/// <returns>This shader if none of the keywords apply, otherwise the variant</returns>
+	sptr GetVariant(const std::vector<std::string>& keywords);
 	
 public:
+	/// <summary>
+	/// Looks a uniform up in the table built when the shader linked, no strings involved
+	/// </summary>
+	/// <returns>The uniform's location, or -1 if the shader doesn't have it</returns>
+	int GetUniformLocation(UniformId id);
+	/// <summary>
+	/// Same as above, but hashes the name at runtime and warns the first time a name is missing
+	/// </summary>
 	int GetUniformLocation(const std::string& name);
 	
+	template <typename T>
+	void SetUniform(UniformId id, const T& value) {
+		int location = GetUniformLocation(id);
+		if (location != -1) {
+			SetUniform(location, &value, 1);
+		}
+		for (auto& kvp : _variants) {
+			kvp.second->SetUniform(id, value);
+		}
+	}
+	template <typename T>
+	void SetUniformMatrix(UniformId id, const T& value, bool transposed = false) {
+		int location = GetUniformLocation(id);
+		if (location != -1) {
+			SetUniformMatrix(location, &value, 1, transposed);
+		}
+		for (auto& kvp : _variants) {
+			kvp.second->SetUniformMatrix(id, value, transposed);
+		}
+	}
 	template <typename T>
 	void SetUniform(const std::string& name, const T& value) {
 		int location = GetUniformLocation(name);
 		if (location != -1) {
 			SetUniform(location, &value, 1);
 		}
+		// By id so a variant that compiled the uniform out doesn't warn about it
+		for (auto& kvp : _variants) {
+			kvp.second->SetUniform(UniformId(name), value);
+		}
 	}
 	template <typename T>
 	void SetUniformMatrix(const std::string& name, const T& value, bool transposed = false) {
@@ -87,6 +174,9 @@ public:
 		if (location != -1) {
 			SetUniformMatrix(location, &value, 1, transposed);
 		}
+		for (auto& kvp : _variants) {
+			kvp.second->SetUniformMatrix(UniformId(name), value, transposed);
+		}
 	}
 	template <typename T>
 	void SetUniform(int location, const T& value) {
@@ -117,11 +207,59 @@ public:
 	void SetUniform(int location, const glm::bvec4* value, int count = 1);
 	
 protected:
-	GLuint _vs;
-	GLuint _fs;
+	std::string _vertexSource;
+	std::string _fragmentSource;
 	
 	GLuint _handle;
+	// Set from Link until we've checked on the program, see ShaderLibrary
+	bool _pending;
+	bool _linked;
+
+	struct UniformLocation {
+		uint32_t Hash;
+		int      Location;
+	};
+	// Every uniform with a location, sorted by hash so lookups are a binary search
+	std::vector<UniformLocation> _uniformLocs;
+	// Names we've already warned about, so a missing uniform set every frame doesn't flood the log
+	std::unordered_set<uint32_t> _missingUniforms;
+	// Only filled in on the shader variants are built from, see GetSamplerUnit
+	std::unordered_map<std::string, int> _samplerUnits;
+	// Samplers the source gives a layout(binding) of its own, those keep their unit even if it's 0
+	std::unordered_set<uint32_t> _boundSamplers;
+	// Units below this are left for textures the application binds itself
+	static const int FIRST_SAMPLER_UNIT = 1;
+	int _nextSamplerUnit;
+	// The shader this variant was built from, it owns us so it's always around. nullptr if we aren't a variant
+	Shader* _base;
+
+	MaterialBlockLayout _materialBlock;
 
-	std::unordered_map<std::string, int> _uniformLocs;
+	// Keyed by the sorted keywords joined with spaces
+	std::unordered_map<std::string, sptr> _variants;
+
+	/// <summary>
+	/// Waits for a pending link and reads everything we need back from the program
+	/// </summary>
+	/// <returns>True if the program linked</returns>
+	bool _Resolve() { return _pending ? _FinishLink() : _linked; }
+	bool _FinishLink();
+	/// <summary>
+	/// Fills _uniformLocs from the linked program's active uniforms, and _boundSamplers from the source
+	/// </summary>
+	void _ReflectUniforms();
+	/// <summary>
+	/// Adds every uniform declared with a layout(binding) in a stage's source to _boundSamplers.
+	/// GL reports an explicit binding of 0 the same as no binding at all, so only the source can tell us
+	/// </summary>
+	void _FindBoundSamplers(const std::string& source);
+	/// <summary>
+	/// Copies the value of every uniform outside a block into another program that has the same uniform
+	/// </summary>
+	void _CopyUniformsTo(Shader& target);
+	/// <summary>
+	/// Reads the material block layout back from the linked program
+	/// </summary>
+	void _IntrospectMaterialBlock();
 	
 };
\ No newline at end of file
@@ -0,0 +1,162 @@
+#pragma once
+#include <glad/glad.h>
+#include <string>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+#include "Shader.h"
+
+/// <summary>
+/// Owns everything shared between shader programs
+///
+/// Compiled stages are kept by a hash of their source, so a stage every post effect uses
+/// (like passthrough_vert.glsl) only gets compiled once. Linked programs are saved to disk
+/// with glGetProgramBinary and loaded back on the next run, keyed by their sources and
+/// the driver that built them, so a warm start doesn't compile anything at all
+///
+/// Linking only submits work to the driver, nothing asks for a compile or link status until
+/// the program is first used or the batch ends. Inside a batch every program gets submitted
+/// before we wait on any of them, so drivers that compile on their own threads can overlap them
+/// </summary>
+class ShaderLibrary
+{
+public:
+	/// <summary>
+	/// Turns on the program binary cache, needs a current OpenGL context.
+	/// Without this stages still get shared, but every run compiles from source
+	/// </summary>
+	/// <param name="cacheDirectory">The folder to keep program binaries in, created if it's missing</param>
+	/// <param name="loader">Used to find GL_KHR_parallel_shader_compile, which glad doesn't load for us</param>
+	static void Init(const std::string& cacheDirectory, GLADloadproc loader = nullptr);
+	/// <summary>
+	/// Drops every stage and program the library is holding on to, has to happen while the context is still alive
+	/// </summary>
+	static void Unload();
+
+	/// <summary>
+	/// Gets a program made from the two files, programs with the same sources are only ever built once.
+	/// Programs handed out here are shared, so only set uniforms on them right before drawing
+	/// </summary>
+	static Shader::sptr LoadFromFiles(const char* vertexPath, const char* fragmentPath);
+	/// <summary>
+	/// Same as LoadFromFiles, but for sources built at runtime
+	/// </summary>
+	static Shader::sptr LoadFromSource(const std::string& vertexSource, const std::string& fragmentSource);
+
+	/// <summary>
+	/// Starts a batch, programs linked until EndBatch are only submitted and never waited on
+	/// </summary>
+	static void BeginBatch();
+	/// <summary>
+	/// Waits on everything submitted since BeginBatch, finishing whichever programs are done first
+	/// </summary>
+	static void EndBatch();
+	static bool IsBatching() { return _batching; }
+	/// <summary>
+	/// Gets whether the driver compiles on its own threads and lets us poll for completion
+	/// </summary>
+	static bool IsParallelCompileSupported() { return _parallelCompile; }
+
+	/// <summary>
+	/// Starts building a program from source, loading it from the binary cache if it's there and
+	/// compiling it if it isn't. Nothing waits on the driver until FinishProgram
+	/// </summary>
+	static void SubmitProgram(GLuint program, const std::string& vertexSource, const std::string& fragmentSource);
+	/// <summary>
+	/// Waits for a submitted program, logs any errors and saves freshly linked programs to the cache
+	/// </summary>
+	/// <returns>True if the program linked</returns>
+	static bool FinishProgram(GLuint program);
+	/// <summary>
+	/// Forgets about a program that's being deleted before anyone finished it
+	/// </summary>
+	static void CancelProgram(GLuint program);
+	/// <summary>
+	/// Deletes the shared stage objects, programs keep working without them.
+	/// Anything linked from source after this has to compile its stages again
+	/// </summary>
+	static void ReleaseStages();
+
+	/// <summary>
+	/// Reads a shader source file, throws if it can't be opened.
+	/// Lines like #include "file.glsl" are replaced with that file, looked up next to the file including it
+	/// </summary>
+	static std::string ReadSource(const char* path);
+	/// <summary>
+	/// 64 bit FNV-1a, seed with a previous hash to chain several buffers together
+	/// </summary>
+	static uint64_t Hash(const void* data, size_t size, uint64_t seed = 14695981039346656037ull);
+
+	/// <summary>
+	/// Gets the total time spent building programs, in milliseconds
+	/// </summary>
+	static float GetBuildTime() { return _buildTime; }
+	/// <summary>
+	/// Gets how many programs came out of the binary cache
+	/// </summary>
+	static unsigned GetCachedCount() { return _cachedCount; }
+	/// <summary>
+	/// Gets how many programs had to be compiled from source
+	/// </summary>
+	static unsigned GetCompiledCount() { return _compiledCount; }
+	/// <summary>
+	/// Gets how many stage compiles were skipped because the same source was already compiled
+	/// </summary>
+	static unsigned GetSharedStageCount() { return _sharedStageCount; }
+
+private:
+	// Start of every cache file, bump the last byte when the layout changes
+	static const uint32_t CACHE_MAGIC = 0x4F534201;
+	// GL_COMPLETION_STATUS_KHR, the ARB version of the extension uses the same value
+	static const GLenum COMPLETION_STATUS = 0x91B1;
+	// Deeper than this and we assume the includes are going in circles
+	static const int MAX_INCLUDE_DEPTH = 16;
+
+	// A program that's been handed to the driver but not checked on yet
+	struct PendingProgram {
+		GLuint   Program;
+		uint64_t Key;
+		// Zero when the program came out of the binary cache
+		GLuint   VertexStage;
+		GLuint   FragmentStage;
+	};
+
+	/// <summary>
+	/// Gets the compiled stage for some source, compiling it if it hasn't been yet
+	/// </summary>
+	/// <returns>The stage object, or 0 if it didn't compile</returns>
+	static GLuint _GetStage(const std::string& source, GLenum type);
+	/// <summary>
+	/// Reads a file and expands its includes, depth guards against files including each other
+	/// </summary>
+	static std::string _ReadSource(const std::string& path, int depth);
+	/// <summary>
+	/// Logs the compile errors for a stage that broke a link, and drops it so the next link compiles it again
+	/// </summary>
+	static void _ReportStage(GLuint stage);
+	/// <summary>
+	/// Checks on a program without blocking, always false without the parallel compile extension
+	/// </summary>
+	static bool _IsComplete(GLuint program);
+	static bool _Finish(const PendingProgram& pending);
+	static std::string _CachePath(uint64_t key);
+	static bool _LoadBinary(GLuint program, uint64_t key);
+	static void _SaveBinary(GLuint program, uint64_t key);
+
+	static std::unordered_map<uint64_t, GLuint> _stages;
+	static std::unordered_map<uint64_t, Shader::sptr> _programs;
+	// In the order they were submitted
+	static std::vector<PendingProgram> _pending;
+	static bool _batching;
+	static bool _parallelCompile;
+
+	static std::string _cacheDirectory;
+	// Hash of the vendor, renderer and version strings, binaries from another driver are thrown out
+	static uint64_t _driverHash;
+	static bool _binariesSupported;
+
+	static float _buildTime;
+	static unsigned _cachedCount;
+	static unsigned _compiledCount;
+	static unsigned _sharedStageCount;
+};
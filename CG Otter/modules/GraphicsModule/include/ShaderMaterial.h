@@ -1,56 +1,54 @@
 #pragma once
 #include <string>
+#include <vector>
+#include <cstdint>
 #include "Shader.h"
 #include "ITexture.h"
 #include "Macros.h"
 #include <EnumToString.h>
 
-struct ShaderParamName {
-	std::string Name;
-	int         Location;
-
-	ShaderParamName(const std::string& name) :
-		Name(name), Location(-1) {}
-
-	bool operator ==(const ShaderParamName& r) const {
-		return Name == r.Name;
-	}
-	bool operator !=(const ShaderParamName& r) const {
-		return Name != r.Name;
-	}
-};
-
-namespace  std
-{
-	template<>
-	struct hash<ShaderParamName> {
-		std::size_t operator()(const ShaderParamName& p) const noexcept {
-			return std::hash<std::string>()(p.Name);
-		}
-	};
-}
-
+/// <summary>
+/// A shader plus the parameters to draw with it
+///
+/// Parameters the shader declares in its MaterialBlock are packed into a std140 buffer
+/// owned by the material, so applying the material is a single buffer range bind plus
+/// whichever texture binds actually changed. Anything outside the block still goes
+/// through glProgramUniform every time the material is applied
+///
+/// Keywords pick which variant of the shader gets drawn with (see Shader::GetVariant),
+/// the material's own keywords are combined with the global ones
+/// </summary>
 class ShaderMaterial {
 	SMART_MEMORY_MANAGED(ShaderMaterial)
 public:
-	
+
 	ShaderMaterial();
 	virtual ~ShaderMaterial();
 
+	/// <summary>
+	/// The shader to draw with, has to be set before any parameters and can't change after
+	/// </summary>
 	Shader::sptr Shader;
-	std::unordered_map<ShaderParamName, ITexture::sptr> Textures;
-	std::unordered_map<ShaderParamName, float> FloatParams;
-	std::unordered_map<ShaderParamName, glm::vec2> Vec2Params;
-	std::unordered_map<ShaderParamName, glm::vec3> Vec3Params;
-	std::unordered_map<ShaderParamName, glm::vec4> Vec4Params;
-	std::unordered_map<ShaderParamName, glm::mat4> Mat4Params;
-	std::unordered_map<ShaderParamName, glm::mat3> Mat3Params;
 
 	int RenderLayer;
 	std::string DebugName;
 
 	void Apply();
 
+	/// <summary>
+	/// Gets the program to draw with, the shader's variant for every keyword that's turned on
+	/// </summary>
+	const Shader::sptr& GetProgram();
+
+	/// <summary>
+	/// Turns a keyword on or off for just this material
+	/// </summary>
+	void SetKeyword(const std::string& keyword, bool enabled);
+	/// <summary>
+	/// Turns a keyword on or off for every material
+	/// </summary>
+	static void SetGlobalKeyword(const std::string& keyword, bool enabled);
+
 	void Set(const std::string& name, const ITexture::sptr& texture);
 	void Set(const std::string& name, float value);
 	void Set(const std::string& name, const glm::vec2& value);
@@ -59,5 +57,71 @@ public:
 	void Set(const std::string& name, const glm::mat4& value);
 	void Set(const std::string& name, const glm::mat3& value);
 
+	/// <summary>
+	/// Returns a small number unique to this material, handy for sort keys
+	/// </summary>
+	uint32_t GetId() const { return _id; }
+
 protected:
+	uint32_t _id;
+	static uint32_t _nextId;
+
+	struct TextureBinding {
+		std::string    Name;
+		// Unit in the program we're currently drawing with, -1 if it doesn't have the sampler
+		int            Unit;
+		ITexture::sptr Texture;
+	};
+	/// <summary>
+	/// A parameter that isn't in the shader's material block, stored as raw floats
+	/// and sent with the glProgramUniform call matching its type
+	/// </summary>
+	struct LooseParam {
+		std::string Name;
+		// Location in the program we're currently drawing with
+		int    Location;
+		GLenum Type;
+		float  Data[16];
+	};
+
+	// Textures in the order they were first set, each on the unit the shader gave its sampler
+	std::vector<TextureBinding> _textures;
+	std::vector<LooseParam>     _looseParams;
+
+	// CPU copy of the material block, laid out exactly like the shader's std140 block
+	std::vector<uint8_t> _block;
+	GLuint _blockBuffer;
+	GLint  _blockBinding;
+	bool   _blockDirty;
+	// The shader _block was laid out for
+	const ::Shader* _layoutShader;
+
+	std::vector<std::string> _keywords;
+	// The variant GetProgram last picked, and what it was picked for
+	Shader::sptr _program;
+	const ::Shader* _programShader;
+	uint32_t _programKeywordVersion;
+	bool _keywordsChanged;
+
+	static std::vector<std::string> _globalKeywords;
+	// Bumped whenever the global keywords change, so materials know to pick their variant again
+	static uint32_t _globalKeywordVersion;
+
+	/// <summary>
+	/// Adds or removes a keyword from a list, returns true if the list changed
+	/// </summary>
+	static bool _SetKeyword(std::vector<std::string>& keywords, const std::string& keyword, bool enabled);
+
+	/// <summary>
+	/// Lays the block out for the shader the first time a parameter is set
+	/// </summary>
+	void _ResolveLayout();
+	/// <summary>
+	/// Writes a column major value into the block or the loose params, whichever the shader declared it in
+	/// </summary>
+	void _SetParam(const std::string& name, GLenum type, int columns, int rows, const float* data);
+	/// <summary>
+	/// Creates the block's buffer if needed and copies the CPU block into it
+	/// </summary>
+	void _UploadBlock();
 };
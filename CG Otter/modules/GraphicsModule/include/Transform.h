@@ -3,9 +3,12 @@
 #include <memory>
 #include <GLM/glm.hpp>
 #include <GLM/gtc/quaternion.hpp>
+#include "TransformSystem.h"
 
 /// <summary>
 /// A simple transformation class, without parent/child relationships
+///
+/// The actual position, rotation, scale and matrices live in TransformSystem, this just owns a slot in it
 /// </summary>
 class Transform final
 {
@@ -13,36 +16,27 @@ public:
 	struct TransformDirtyTag { };
 	
 	Transform(entt::handle gameObject) :
-		_isLocalDirty(true),
-		_localTransform(glm::mat4(1.0f)),
-		_normalMatrix(glm::mat3(1.0f)),
-		_isWorldDirty(true),
-		_worldTransform(glm::mat4(1.0f)),
-		_worldNormalMatrix(glm::mat3(1.0f)),
-		_rotation(glm::quat(1.0f, 0.0f, 0.0f, 0.0f)),
-		_rotationEulerDeg(glm::vec3(0.0f)),
-		_position(glm::vec3(0.0f)),
-		_scale(glm::vec3(1.0f)),
+		_slot(TransformSystem::Allocate()),
 		_parent(entt::null),
-		_gameObject(gameObject),
-		_hierarchyDepth(0)
+		_gameObject(gameObject)
 	{}
-	Transform(const Transform& other) = default;
-	Transform(Transform&& other) = default;
-	Transform& operator =(const Transform & other) = default;
-	Transform& operator =(Transform && other) = default;
-	virtual ~Transform() = default;
+	// Copies get their own slot, moves take the other transform's slot with them
+	Transform(const Transform& other);
+	Transform(Transform&& other) noexcept;
+	Transform& operator =(const Transform & other);
+	Transform& operator =(Transform && other) noexcept;
+	virtual ~Transform();
 
 	// Rotation Getters/Setters
 
 	/// <summary>
 	/// Gets the local rotation of the transform in euler degrees
 	/// </summary>
-	const glm::vec3& GetLocalRotation() const { return _rotationEulerDeg; }
+	const glm::vec3& GetLocalRotation() const { return TransformSystem::GetEulerDegrees(_slot); }
 	/// <summary>
 	/// Returns the local rotation as a quaternion
 	/// </summary>
-	const glm::quat& GetLocalRotationQuat() const { return _rotation; }
+	glm::quat GetLocalRotationQuat() const { return TransformSystem::GetRotation(_slot); }
 	/// <summary>
 	/// Sets the local rotation of this transform to the given value in euler degrees
 	/// </summary>
@@ -69,7 +63,7 @@ public:
 	/// <summary>
 	/// Gets the local position of this transform
 	/// </summary>
-	const glm::vec3& GetLocalPosition() const { return _position; }
+	glm::vec3 GetLocalPosition() const { return TransformSystem::GetPosition(_slot); }
 	/// <summary>
 	/// Sets this transforms translation within it's local space
 	/// </summary>
@@ -90,7 +84,7 @@ public:
 	/// <summary>
 	/// Gets the local scale for this transform, along each axis
 	/// </summary>
-	const glm::vec3& GetLocalScale() const { return _scale; }
+	glm::vec3 GetLocalScale() const { return TransformSystem::GetScale(_slot); }
 	/// <summary>
 	/// Sets this transforms scale within it's local space
 	/// </summary>
@@ -183,42 +177,47 @@ public:
 	/// </summary>
 	const glm::mat4& LocalTransform() const;
 	/// <summary>
-	/// Gets the local rotation matrix for this transform, updating it if required.
-	/// This is useful for calculating the normal matrix
+	/// Gets the normal matrix for the local transform (the inverse transpose of its rotation and scale), updating it if required
 	/// </summary>
 	const glm::mat3& NormalMatrix() const;
 
+	/// <summary>
+	/// Parents this transform to another entity's, or un-parents it if the handle is null.
+	/// Our children come along, and only our subtree has its depths updated
+	/// </summary>
 	void SetParent(entt::handle parent);
 
-	void UpdateWorldMatrix() const;
+	/// <summary>
+	/// Re-calculates the world matrix if our local transform or our parent's world matrix changed.
+	/// Parents have to be updated before their children, TransformSystem::Update does that for every transform
+	/// </summary>
+	/// <returns>True if the world matrix was re-calculated</returns>
+	bool UpdateWorldMatrix() const;
+	/// <summary>
+	/// Gets a number that changes every time the world matrix is re-calculated, compare against a
+	/// saved copy to find out if the transform moved
+	/// </summary>
+	uint32_t GetWorldVersion() const { return TransformSystem::GetWorldVersion(_slot); }
+
+	const glm::mat4& WorldTransform() const { return TransformSystem::GetWorld(_slot); }
+	const glm::mat3& WorldNormalMatrix() const { return TransformSystem::GetWorldNormal(_slot); };
 
-	const glm::mat4& WorldTransform() const { return _worldTransform; }
-	const glm::mat3& WorldNormalMatrix() const { return _worldNormalMatrix; };
+	/// <summary>
+	/// Gets this transform's slot in the TransformSystem
+	/// </summary>
+	uint32_t GetSlot() const { return _slot; }
 
 	/// <summary>
 	/// Gets the depth of this transform within the scene hierarchy (ie. how many parents
 	/// to the root)
 	/// </summary>
 	/// <returns></returns>
-	int GetHierarchyDepth() const { return _hierarchyDepth; }
+	int GetHierarchyDepth() const { return TransformSystem::GetDepth(_slot); }
 
 private:
-	mutable bool _isLocalDirty;
-	mutable glm::mat4 _localTransform;
-	mutable glm::mat3 _normalMatrix;
-
-	mutable bool _isWorldDirty;
-	mutable glm::mat4 _worldTransform;
-	mutable glm::mat3 _worldNormalMatrix;
-	
-	glm::quat _rotation;
-	glm::vec3 _rotationEulerDeg;
-	glm::vec3 _position;
-	glm::vec3 _scale;
+	// NULL_SLOT once another transform has been moved out of us
+	uint32_t _slot;
 
 	entt::entity _parent;
 	entt::handle _gameObject;
-	int _hierarchyDepth;
-
-	void _UpdateLocalTransformIfDirty() const;
 };
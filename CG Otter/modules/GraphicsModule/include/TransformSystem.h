@@ -0,0 +1,222 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include <GLM/glm.hpp>
+#include <GLM/gtc/quaternion.hpp>
+
+/// <summary>
+/// Stores every Transform's state and works out their matrices
+///
+/// Local position, rotation and scale are kept structure of arrays, so local matrices get built
+/// four transforms at a time with SSE. The matrices they produce are stored one after another in
+/// slot order for whoever reads them. A Transform is just a slot in here plus its place in the scene
+///
+/// Slots never move, a slot number is good until the transform that owns it is destroyed. References
+/// handed out by the getters are only good until the next slot is allocated, so don't hold on to them
+/// </summary>
+class TransformSystem
+{
+public:
+	static constexpr uint32_t NULL_SLOT = 0xFFFFFFFF;
+
+	/// <summary>
+	/// Gets a slot for a new transform, at the origin with no rotation, unit scale and no parent
+	/// </summary>
+	static uint32_t Allocate();
+	/// <summary>
+	/// Gives a slot back to be reused
+	/// </summary>
+	static void Free(uint32_t slot);
+	/// <summary>
+	/// Copies the local position, rotation and scale of one slot into another
+	/// </summary>
+	static void CopyLocal(uint32_t destination, uint32_t source);
+
+	// Local state
+
+	static glm::vec3 GetPosition(uint32_t slot) { return glm::vec3(_px[slot], _py[slot], _pz[slot]); }
+	static glm::quat GetRotation(uint32_t slot) { return glm::quat(_qw[slot], _qx[slot], _qy[slot], _qz[slot]); }
+	static glm::vec3 GetScale(uint32_t slot) { return glm::vec3(_sx[slot], _sy[slot], _sz[slot]); }
+	/// <summary>
+	/// Gets the rotation in euler degrees, they only get worked out from the quaternion when something asks
+	/// </summary>
+	static const glm::vec3& GetEulerDegrees(uint32_t slot);
+
+	static void SetPosition(uint32_t slot, const glm::vec3& position);
+	static void SetRotation(uint32_t slot, const glm::quat& rotation);
+	/// <summary>
+	/// Sets the rotation from euler degrees, GetEulerDegrees gives back exactly these angles
+	/// </summary>
+	static void SetRotation(uint32_t slot, const glm::vec3& eulerDegrees);
+	static void SetScale(uint32_t slot, const glm::vec3& scale);
+
+	// Hierarchy
+
+	/// <summary>
+	/// Parents a slot to another, bringing its children along. Costs the depth of the new parent
+	/// plus the size of the moved subtree, nothing else in the hierarchy gets touched
+	/// </summary>
+	/// <param name="parent">The parent's slot, or NULL_SLOT for none. Can't be the slot or one of its children</param>
+	static void SetParent(uint32_t slot, uint32_t parent);
+	static uint32_t GetParent(uint32_t slot) { return _parent[slot]; }
+	static uint32_t GetFirstChild(uint32_t slot) { return _firstChild[slot]; }
+	static uint32_t GetNextSibling(uint32_t slot) { return _nextSibling[slot]; }
+	/// <summary>
+	/// Gets how many parents there are between the slot and the root
+	/// </summary>
+	static int GetDepth(uint32_t slot) { return _depth[slot]; }
+	/// <summary>
+	/// Checks if a slot is root or somewhere underneath it, by walking up from slot
+	/// </summary>
+	static bool IsInSubtree(uint32_t slot, uint32_t root);
+
+	// Matrices
+
+	/// <summary>
+	/// Gets the local matrix, building it first if it's dirty
+	/// </summary>
+	static const glm::mat4& GetLocal(uint32_t slot);
+	/// <summary>
+	/// Gets the inverse transpose of the local matrix's upper 3x3, building it first if it's dirty
+	/// </summary>
+	static const glm::mat3& GetLocalNormal(uint32_t slot);
+	static const glm::mat4& GetWorld(uint32_t slot) { return _world[slot]; }
+	static const glm::mat3& GetWorldNormal(uint32_t slot) { return _worldNormal[slot]; }
+	/// <summary>
+	/// Gets a number that changes every time the slot's world matrix is rebuilt
+	/// </summary>
+	static uint32_t GetWorldVersion(uint32_t slot) { return _worldVersion[slot]; }
+
+	/// <summary>
+	/// Rebuilds one world matrix if it or its parent's changed, the parent has to be up to date already
+	/// </summary>
+	/// <returns>True if the world matrix was rebuilt</returns>
+	static bool UpdateWorld(uint32_t slot);
+	/// <summary>
+	/// Builds every dirty local matrix, then rebuilds every world matrix that changed, parents first
+	/// </summary>
+	/// <returns>How many world matrices were rebuilt</returns>
+	static unsigned Update();
+
+	// Fixed step interpolation
+
+	/// <summary>
+	/// Remembers every slot's local state, call before each fixed step
+	/// </summary>
+	static void BeginFixedStep();
+	/// <summary>
+	/// Notes which slots moved during the fixed step, those are the ones Interpolate blends
+	/// </summary>
+	static void EndFixedStep();
+	/// <summary>
+	/// Moves every slot that moved in the last fixed step to somewhere between where it was before the step
+	/// and where it is now, for rendering. Call EndInterpolation before the simulation touches anything again
+	/// </summary>
+	/// <param name="alpha">How far through the next fixed step the frame is, 0 to 1</param>
+	static void Interpolate(float alpha);
+	/// <summary>
+	/// Puts the slots Interpolate moved back where the simulation left them. Slots that were set since
+	/// Interpolate keep the new value
+	/// </summary>
+	static void EndInterpolation();
+
+	/// <summary>
+	/// Gets how many slots are in use
+	/// </summary>
+	static unsigned GetCount() { return (unsigned)(_alive.size() - _free.size()); }
+
+private:
+	// Slots are added this many at a time, so every SSE group is always whole
+	static constexpr uint32_t GROUP_SIZE = 4;
+
+	/// <summary>
+	/// Adds more slots to the free list
+	/// </summary>
+	static void _Grow();
+	/// <summary>
+	/// Puts a slot back to the identity with no parent
+	/// </summary>
+	static void _Reset(uint32_t slot);
+	static void _MarkDirty(uint32_t slot) { _localDirty[slot] = 1; _worldDirty[slot] = 1; _moved[slot] = 1; }
+	/// <summary>
+	/// Takes a slot out of its parent's child list, leaving its own children attached
+	/// </summary>
+	static void _Unlink(uint32_t slot);
+	/// <summary>
+	/// Gets the slot after this one in a depth first walk of root's subtree, or NULL_SLOT once the walk is done
+	/// </summary>
+	static uint32_t _NextInSubtree(uint32_t slot, uint32_t root);
+	/// <summary>
+	/// Sets the depth of everything under root, root included
+	/// </summary>
+	static void _UpdateDepths(uint32_t root, int depth);
+	/// <summary>
+	/// Builds the local matrices for one slot, uses the same math as _ComposeLocals so the results match
+	/// </summary>
+	static void _ComposeLocal(uint32_t slot);
+	/// <summary>
+	/// Builds the local matrices for every group of four with a dirty slot in it
+	/// </summary>
+	static void _ComposeLocals();
+	/// <summary>
+	/// Rebuilds _order by walking down from every root, so parents land before their children
+	/// </summary>
+	static void _RebuildOrder();
+
+	// Local TRS, structure of arrays
+	static std::vector<float> _px, _py, _pz;
+	static std::vector<float> _qx, _qy, _qz, _qw;
+	static std::vector<float> _sx, _sy, _sz;
+	static std::vector<uint8_t> _localDirty;
+	static std::vector<uint8_t> _worldDirty;
+
+	// Euler angles are only for editing, worked out on demand
+	static std::vector<glm::vec3> _euler;
+	static std::vector<uint8_t> _eulerDirty;
+
+	static std::vector<glm::mat4> _local;
+	static std::vector<glm::mat3> _localNormal;
+	static std::vector<glm::mat4> _world;
+	static std::vector<glm::mat3> _worldNormal;
+	static std::vector<uint32_t> _worldVersion;
+	// The parent's world version when the slot's world matrix was last built
+	static std::vector<uint32_t> _parentVersion;
+
+	// Hierarchy links, children are a doubly linked list so any one can be taken out without a search
+	static std::vector<uint32_t> _parent;
+	static std::vector<uint32_t> _firstChild;
+	static std::vector<uint32_t> _nextSibling;
+	static std::vector<uint32_t> _prevSibling;
+	static std::vector<int> _depth;
+	static std::vector<uint8_t> _alive;
+	static std::vector<uint32_t> _free;
+
+	// Live slots, parents always before their children. Rebuilt once on the next Update after the hierarchy changes
+	static std::vector<uint32_t> _order;
+	static bool _orderDirty;
+
+	// Every slot's local state at the start of the last fixed step
+	struct LocalState {
+		std::vector<float> Px, Py, Pz;
+		std::vector<float> Qx, Qy, Qz, Qw;
+		std::vector<float> Sx, Sy, Sz;
+	};
+	// Where a slot really is while Interpolate has it somewhere else
+	struct Stash {
+		uint32_t  Slot;
+		glm::vec3 Position;
+		glm::quat Rotation;
+		glm::vec3 Scale;
+		glm::vec3 Euler;
+		uint8_t   EulerDirty;
+	};
+	static LocalState _fixedPrevious;
+	// Set when the slot is alive at the start of a fixed step, cleared when it's reset, so a slot that
+	// gets reused never blends from what used to be in it
+	static std::vector<uint8_t> _fixedValid;
+	// Set whenever the local state is changed, cleared at the start of every fixed step
+	static std::vector<uint8_t> _moved;
+	// Slots that moved in the last fixed step
+	static std::vector<uint32_t> _fixedMoved;
+	static std::vector<Stash> _interpolated;
+};
@@ -0,0 +1,35 @@
+#pragma once
+#include <cstdint>
+#include <string>
+
+/// <summary>
+/// Identifies a uniform by a hash of its name, so looking up a location doesn't need any string work
+///
+/// Declare these as static constexpr next to the code that sets the uniform and the hash is worked out
+/// by the compiler:
+///     static constexpr UniformId u_Radius("u_Radius");
+///     shader->SetUniform(u_Radius, radius);
+/// </summary>
+struct UniformId {
+	uint32_t    Hash;
+	// Kept for logging, only valid as long as the string the id was made from
+	const char* Name;
+
+	/// <summary>
+	/// 32 bit FNV-1a over a null terminated string
+	/// </summary>
+	static constexpr uint32_t HashName(const char* name) {
+		uint32_t hash = 2166136261u;
+		for (; *name != '\0'; name++) {
+			hash = (hash ^ (uint8_t)*name) * 16777619u;
+		}
+		return hash;
+	}
+
+	// Explicit so a string literal still picks the std::string overloads on Shader
+	constexpr explicit UniformId(const char* name) : Hash(HashName(name)), Name(name) {}
+	explicit UniformId(const std::string& name) : Hash(HashName(name.c_str())), Name(name.c_str()) {}
+
+	constexpr bool operator ==(const UniformId& other) const { return Hash == other.Hash; }
+	constexpr bool operator !=(const UniformId& other) const { return Hash != other.Hash; }
+};
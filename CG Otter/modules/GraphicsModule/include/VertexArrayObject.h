@@ -3,6 +3,7 @@
 #include <cstdint>
 #include <vector>
 #include <memory>
+#include <GLM/glm.hpp>
 
 #include "VertexBuffer.h"
 #include "IndexBuffer.h"
@@ -113,6 +114,20 @@ public:
 	/// <param name="buffer">The buffer to add (note, does not take ownership, you will still need to delete later)</param>
 	/// <param name="attributes">A list of vertex attributes that will be fed by this buffer</param>
 	void AddVertexBuffer(const VertexBuffer::sptr& buffer, const std::vector<BufferAttribute>& attributes);
+	/// <summary>
+	/// Adds a per-instance vertex buffer to this VAO, the attributes advance once per instance instead of once per vertex
+	/// </summary>
+	/// <param name="buffer">The buffer holding the instance data (note, does not take ownership, you will still need to delete later)</param>
+	/// <param name="attributes">A list of vertex attributes that will be fed by this buffer</param>
+	void AddInstanceBuffer(const VertexBuffer::sptr& buffer, const std::vector<BufferAttribute>& attributes);
+	/// <summary>
+	/// Limits this VAO to drawing part of it's index buffer, for meshes that live in a shared GeometryArena
+	/// </summary>
+	/// <param name="firstIndex">The first index in the index buffer that belongs to this mesh</param>
+	/// <param name="indexCount">The number of indices in this mesh</param>
+	/// <param name="baseVertex">The offset added to every index, the first vertex of this mesh</param>
+	/// <param name="arenaVao">The VAO covering the whole arena, used to draw many meshes at once</param>
+	void SetArenaRange(GLuint firstIndex, GLsizei indexCount, GLint baseVertex, const sptr& arenaVao);
 
 	/// <summary>
 	/// Binds this VAO as the source of data for draw operations
@@ -128,7 +143,55 @@ public:
 	/// </summary>
 	GLuint GetHandle() const { return _handle; }
 
+	/// <summary>
+	/// Returns the VAO of the GeometryArena this mesh lives in, or nullptr if the mesh has it's own buffers
+	/// </summary>
+	const sptr& GetArenaVAO() const { return _arenaVao; }
+	/// <summary>
+	/// Returns the first index of this mesh within it's index buffer
+	/// </summary>
+	GLuint GetFirstIndex() const { return _firstIndex; }
+	/// <summary>
+	/// Returns the number of indices this mesh draws
+	/// </summary>
+	GLsizei GetIndexCount() const;
+	/// <summary>
+	/// Returns the offset added to every index of this mesh
+	/// </summary>
+	GLint GetBaseVertex() const { return _baseVertex; }
+
+	/// <summary>
+	/// Sets the local space bounds of the mesh, MeshBuilder::Bake fills these in for you
+	/// </summary>
+	/// <param name="min">The minimum corner of the axis aligned bounding box</param>
+	/// <param name="max">The maximum corner of the axis aligned bounding box</param>
+	/// <param name="radius">The radius of the bounding sphere, centered on the middle of the box</param>
+	void SetBounds(const glm::vec3& min, const glm::vec3& max, float radius);
+	/// <summary>
+	/// Removes the bounds, meshes without bounds are never culled
+	/// </summary>
+	void ClearBounds() { _hasBounds = false; }
+	/// <summary>
+	/// Returns true if this mesh has bounds that can be used for culling
+	/// </summary>
+	bool HasBounds() const { return _hasBounds; }
+	/// <summary>
+	/// Returns the corners of the local space axis aligned bounding box
+	/// </summary>
+	const glm::vec3& GetBoundsMin() const { return _boundsMin; }
+	const glm::vec3& GetBoundsMax() const { return _boundsMax; }
+	/// <summary>
+	/// Returns the radius of the local space bounding sphere, which is centered on the middle of the bounding box
+	/// </summary>
+	float GetBoundingRadius() const { return _boundingRadius; }
+
 	void Render() const;
+	/// <summary>
+	/// Draws several instances of this mesh in a single call
+	/// </summary>
+	/// <param name="instanceCount">The number of instances to draw</param>
+	/// <param name="baseInstance">The first element of the instance buffers to read from</param>
+	void RenderInstanced(GLsizei instanceCount, GLuint baseInstance = 0) const;
 	
 protected:
 	// Helper structure to store a buffer and the attributes
@@ -142,8 +205,23 @@ protected:
 	IndexBuffer::sptr _indexBuffer;
 	// The vertex buffers bound to this VAO
 	std::vector<VertexBufferBinding> _vertexBuffers;
+	// The per-instance buffers bound to this VAO
+	std::vector<VertexBufferBinding> _instanceBuffers;
 
 	GLsizei _vertexCount;
+
+	// The part of the index buffer we draw, only used by meshes in a GeometryArena
+	GLuint _firstIndex;
+	GLsizei _indexCount;
+	GLint _baseVertex;
+	// The VAO over the whole arena this mesh lives in
+	sptr _arenaVao;
+
+	// Local space bounds, for culling
+	bool _hasBounds;
+	glm::vec3 _boundsMin;
+	glm::vec3 _boundsMax;
+	float _boundingRadius;
 	
 	// The underlying OpenGL handle that this class is wrapping around
 	GLuint _handle;
@@ -12,6 +12,7 @@ Camera::Camera() :
 	_position(glm::vec3(0.0f)),
 	_normal(glm::vec3(0.0f, 0.0f, 1.0f)),
 	_up(glm::vec3(0.0f, 1.0f, 0.0f)), // Using Y-up coordinate system by default
+	_jitter(glm::vec2(0.0f)),
 	_view(glm::mat4(1.0f)),
 	_projection(glm::mat4(1.0f)),
 	_viewProjection(glm::mat4(1.0f)),
@@ -66,6 +67,11 @@ void Camera::SetFovDegrees(float value) {
 	SetFovRadians(glm::radians(value));
 }
 
+void Camera::SetJitter(const glm::vec2& jitter) {
+	_jitter = jitter;
+	__CalculateProjection();
+}
+
 const glm::mat4& Camera::GetViewProjection() const {
 	if (_isDirty) {
 		_viewProjection = _projection * _view;
@@ -95,6 +101,10 @@ void Camera::__CalculateProjection() {
 	else {
 		_projection = glm::perspective(_fovRadians, _aspectRatio, _nearPlane, _farPlane);
 	}
+	// Shift the whole image in clip space, this works the same for both perspective and ortho
+	if (_jitter != glm::vec2(0.0f)) {
+		_projection = glm::translate(glm::mat4(1.0f), glm::vec3(_jitter, 0.0f)) * _projection;
+	}
 	_isDirty = true;
 }
 
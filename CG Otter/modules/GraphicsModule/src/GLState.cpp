@@ -0,0 +1,243 @@
+#include "GLState.h"
+
+GLuint GLState::_program = GLState::UNKNOWN;
+GLuint GLState::_vao = GLState::UNKNOWN;
+GLuint GLState::_readFramebuffer = GLState::UNKNOWN;
+GLuint GLState::_drawFramebuffer = GLState::UNKNOWN;
+GLuint GLState::_textures[GLState::MAX_TRACKED_UNITS];
+GLuint GLState::_samplers[GLState::MAX_TRACKED_UNITS];
+GLuint GLState::_capabilities[GLState::CapabilityCount];
+GLuint GLState::_uniformBuffers[GLState::MAX_TRACKED_BUFFERS];
+GLintptr GLState::_uniformOffsets[GLState::MAX_TRACKED_BUFFERS];
+GLsizeiptr GLState::_uniformSizes[GLState::MAX_TRACKED_BUFFERS];
+GLuint GLState::_depthFunc = GLState::UNKNOWN;
+GLuint GLState::_depthMask = GLState::UNKNOWN;
+GLuint GLState::_blendSource = GLState::UNKNOWN;
+GLuint GLState::_blendDestination = GLState::UNKNOWN;
+GLuint GLState::_cullFace = GLState::UNKNOWN;
+
+unsigned GLState::_issued = 0;
+unsigned GLState::_elided = 0;
+unsigned GLState::_lastIssued = 0;
+unsigned GLState::_lastElided = 0;
+
+// The arrays can't be given a non-zero initializer, so mark everything unknown before main runs
+static const bool _isStateUnknown = (GLState::Invalidate(), true);
+
+void GLState::UseProgram(GLuint program) {
+	if (_Changed(_program, program)) {
+		glUseProgram(program);
+	}
+}
+
+void GLState::BindVertexArray(GLuint vao) {
+	if (_Changed(_vao, vao)) {
+		glBindVertexArray(vao);
+	}
+}
+
+void GLState::BindFramebuffer(GLenum target, GLuint fbo) {
+	switch (target) {
+		case GL_READ_FRAMEBUFFER:
+			if (_Changed(_readFramebuffer, fbo)) {
+				glBindFramebuffer(target, fbo);
+			}
+			break;
+		case GL_DRAW_FRAMEBUFFER:
+			if (_Changed(_drawFramebuffer, fbo)) {
+				glBindFramebuffer(target, fbo);
+			}
+			break;
+		default:
+			// GL_FRAMEBUFFER sets both
+			if (_readFramebuffer == fbo && _drawFramebuffer == fbo) {
+				_elided++;
+			} else {
+				_issued++;
+				_readFramebuffer = fbo;
+				_drawFramebuffer = fbo;
+				glBindFramebuffer(target, fbo);
+			}
+			break;
+	}
+}
+
+void GLState::BindTexture(int unit, GLuint texture) {
+	if (unit < 0 || unit >= MAX_TRACKED_UNITS) {
+		_issued++;
+		glBindTextureUnit(unit, texture);
+	} else if (_Changed(_textures[unit], texture)) {
+		glBindTextureUnit(unit, texture);
+	}
+}
+
+void GLState::BindSampler(int unit, GLuint sampler) {
+	if (unit < 0 || unit >= MAX_TRACKED_UNITS) {
+		_issued++;
+		glBindSampler(unit, sampler);
+	} else if (_Changed(_samplers[unit], sampler)) {
+		glBindSampler(unit, sampler);
+	}
+}
+
+void GLState::BindUniformBuffer(int binding, GLuint buffer, GLintptr offset, GLsizeiptr size) {
+	if (binding < 0 || binding >= MAX_TRACKED_BUFFERS) {
+		_issued++;
+		glBindBufferRange(GL_UNIFORM_BUFFER, binding, buffer, offset, size);
+		return;
+	}
+	if (_uniformBuffers[binding] == buffer && _uniformOffsets[binding] == offset && _uniformSizes[binding] == size) {
+		_elided++;
+		return;
+	}
+	_issued++;
+	_uniformBuffers[binding] = buffer;
+	_uniformOffsets[binding] = offset;
+	_uniformSizes[binding] = size;
+	glBindBufferRange(GL_UNIFORM_BUFFER, binding, buffer, offset, size);
+}
+
+void GLState::SetEnabled(GLenum capability, bool enabled) {
+	int index = _CapabilityIndex(capability);
+	if (index == -1) {
+		_issued++;
+	} else if (!_Changed(_capabilities[index], enabled ? GL_TRUE : GL_FALSE)) {
+		return;
+	}
+
+	if (enabled) {
+		glEnable(capability);
+	} else {
+		glDisable(capability);
+	}
+}
+
+void GLState::DepthFunc(GLenum func) {
+	if (_Changed(_depthFunc, func)) {
+		glDepthFunc(func);
+	}
+}
+
+void GLState::DepthMask(bool write) {
+	if (_Changed(_depthMask, write ? GL_TRUE : GL_FALSE)) {
+		glDepthMask(write ? GL_TRUE : GL_FALSE);
+	}
+}
+
+void GLState::BlendFunc(GLenum source, GLenum destination) {
+	if (_blendSource == source && _blendDestination == destination) {
+		_elided++;
+		return;
+	}
+	_issued++;
+	_blendSource = source;
+	_blendDestination = destination;
+	glBlendFunc(source, destination);
+}
+
+void GLState::CullFace(GLenum face) {
+	if (_Changed(_cullFace, face)) {
+		glCullFace(face);
+	}
+}
+
+void GLState::OnProgramDeleted(GLuint program) {
+	// Deleting a bound program leaves it in use until something else is bound, so just forget it
+	if (_program == program) {
+		_program = UNKNOWN;
+	}
+}
+
+void GLState::OnVertexArrayDeleted(GLuint vao) {
+	// GL falls back to 0 when the bound VAO is deleted
+	if (_vao == vao) {
+		_vao = 0;
+	}
+}
+
+void GLState::OnFramebufferDeleted(GLuint fbo) {
+	// Same for framebuffers, the binding reverts to the default framebuffer
+	if (_readFramebuffer == fbo) {
+		_readFramebuffer = 0;
+	}
+	if (_drawFramebuffer == fbo) {
+		_drawFramebuffer = 0;
+	}
+}
+
+void GLState::OnTextureDeleted(GLuint texture) {
+	for (int i = 0; i < MAX_TRACKED_UNITS; i++) {
+		if (_textures[i] == texture) {
+			_textures[i] = 0;
+		}
+	}
+}
+
+void GLState::OnSamplerDeleted(GLuint sampler) {
+	for (int i = 0; i < MAX_TRACKED_UNITS; i++) {
+		if (_samplers[i] == sampler) {
+			_samplers[i] = 0;
+		}
+	}
+}
+
+void GLState::OnBufferDeleted(GLuint buffer) {
+	// Deleted buffers get unbound from every binding point they were on
+	for (int i = 0; i < MAX_TRACKED_BUFFERS; i++) {
+		if (_uniformBuffers[i] == buffer) {
+			_uniformBuffers[i] = 0;
+			_uniformOffsets[i] = 0;
+			_uniformSizes[i] = 0;
+		}
+	}
+}
+
+void GLState::Invalidate() {
+	_program = UNKNOWN;
+	_vao = UNKNOWN;
+	_readFramebuffer = UNKNOWN;
+	_drawFramebuffer = UNKNOWN;
+	for (int i = 0; i < MAX_TRACKED_UNITS; i++) {
+		_textures[i] = UNKNOWN;
+		_samplers[i] = UNKNOWN;
+	}
+	for (int i = 0; i < CapabilityCount; i++) {
+		_capabilities[i] = UNKNOWN;
+	}
+	for (int i = 0; i < MAX_TRACKED_BUFFERS; i++) {
+		_uniformBuffers[i] = UNKNOWN;
+	}
+	_depthFunc = UNKNOWN;
+	_depthMask = UNKNOWN;
+	_blendSource = UNKNOWN;
+	_blendDestination = UNKNOWN;
+	_cullFace = UNKNOWN;
+}
+
+void GLState::BeginFrame() {
+	_lastIssued = _issued;
+	_lastElided = _elided;
+	_issued = 0;
+	_elided = 0;
+}
+
+int GLState::_CapabilityIndex(GLenum capability) {
+	switch (capability) {
+		case GL_DEPTH_TEST:   return DepthTest;
+		case GL_BLEND:        return Blend;
+		case GL_CULL_FACE:    return CullFaceCap;
+		case GL_SCISSOR_TEST: return ScissorTest;
+		case GL_STENCIL_TEST: return StencilTest;
+		default:              return -1;
+	}
+}
+
+bool GLState::_Changed(GLuint& cached, GLuint value) {
+	if (cached == value) {
+		_elided++;
+		return false;
+	}
+	_issued++;
+	cached = value;
+	return true;
+}
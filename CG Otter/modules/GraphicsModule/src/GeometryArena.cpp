@@ -0,0 +1,48 @@
+#include "GeometryArena.h"
+
+std::unordered_map<std::type_index, GeometryArena::sptr> GeometryArena::_current;
+
+GeometryArena::GeometryArena(size_t vertexSize, const std::vector<BufferAttribute>& attributes, size_t vertexCapacity, size_t indexCapacity) :
+	_attributes(attributes),
+	_vertexSize(vertexSize),
+	_vertexCapacity(vertexCapacity),
+	_indexCapacity(indexCapacity),
+	_vertexCount(0),
+	_indexCount(0)
+{
+	// Allocate the storage up front, meshes get copied in with glNamedBufferSubData as they are baked
+	_vertexBuffer = VertexBuffer::Create();
+	_vertexBuffer->LoadData(nullptr, vertexSize, vertexCapacity);
+	_indexBuffer = IndexBuffer::Create();
+	_indexBuffer->LoadData<uint32_t>(nullptr, indexCapacity);
+
+	_vao = VertexArrayObject::Create();
+	_vao->AddVertexBuffer(_vertexBuffer, _attributes);
+	_vao->SetIndexBuffer(_indexBuffer);
+}
+
+VertexArrayObject::sptr GeometryArena::Allocate(const void* vertices, size_t vertexCount, const uint32_t* indices, size_t indexCount)
+{
+	if (_vertexCount + vertexCount > _vertexCapacity || _indexCount + indexCount > _indexCapacity) {
+		return nullptr;
+	}
+
+	glNamedBufferSubData(_vertexBuffer->GetHandle(), _vertexCount * _vertexSize, vertexCount * _vertexSize, vertices);
+	glNamedBufferSubData(_indexBuffer->GetHandle(), _indexCount * sizeof(uint32_t), indexCount * sizeof(uint32_t), indices);
+
+	// The mesh gets it's own VAO over the shared buffers, so it can still be drawn on it's own
+	VertexArrayObject::sptr result = VertexArrayObject::Create();
+	result->AddVertexBuffer(_vertexBuffer, _attributes);
+	result->SetIndexBuffer(_indexBuffer);
+	result->SetArenaRange(static_cast<GLuint>(_indexCount), static_cast<GLsizei>(indexCount), static_cast<GLint>(_vertexCount), _vao);
+
+	_vertexCount += vertexCount;
+	_indexCount += indexCount;
+
+	return result;
+}
+
+void GeometryArena::Unload()
+{
+	_current.clear();
+}
@@ -1,6 +1,7 @@
 #include "ITexture.h"
 
 #include "Logging.h"
+#include "GLState.h"
 
 ITexture::Limits ITexture::_limits = ITexture::Limits();
 bool ITexture::_isStaticInit = false;
@@ -31,21 +32,20 @@ ITexture::ITexture()
 
 ITexture::~ITexture() {
 	if (glIsTexture(_handle)) {
+		GLState::OnTextureDeleted(_handle);
 		glDeleteTextures(1, &_handle);
 	}
 }
 
 void ITexture::Bind(int slot) const {
 	if (_handle != 0) {
-		//glActiveTexture(GL_TEXTURE0 + slot);
-		glBindTextureUnit(slot, _handle);
+		GLState::BindTexture(slot, _handle);
 	}
 }
 
 void ITexture::Unbind(int slot)
 {
-	//glActiveTexture(GL_TEXTURE0 + slot);
-	glBindTextureUnit(slot, 0);
+	GLState::BindTexture(slot, 0);
 }
 
 
@@ -0,0 +1,15 @@
+#include "Resources.h"
+#include "GeometryArena.h"
+
+ResourcePool<Shader>            Resources::Shaders;
+ResourcePool<ShaderMaterial>    Resources::Materials;
+ResourcePool<VertexArrayObject> Resources::Meshes;
+ResourcePool<Texture2D>         Resources::Textures;
+
+void Resources::Unload() {
+	Materials.Clear();
+	Meshes.Clear();
+	GeometryArena::Unload();
+	Textures.Clear();
+	Shaders.Clear();
+}
@@ -1,18 +1,27 @@
 #include "Shader.h"
 #include "Logging.h"
-#include <fstream>
-#include <sstream>
+#include "GLState.h"
+#include "ShaderLibrary.h"
+#include <vector>
+#include <algorithm>
+#include <regex>
 
 Shader::Shader() :
-	_vs(0),
-	_fs(0),
-	_handle(0)
+	_handle(0),
+	_pending(false),
+	_linked(false),
+	_nextSamplerUnit(FIRST_SAMPLER_UNIT),
+	_base(nullptr)
 {
 	_handle = glCreateProgram();
 }
 
 Shader::~Shader() {
 	if (_handle != 0) {
+		if (_pending) {
+			ShaderLibrary::CancelProgram(_handle);
+		}
+		GLState::OnProgramDeleted(_handle);
 		glDeleteProgram(_handle);
 		_handle = 0;
 		LOG_INFO("Deleting shader program");
@@ -21,107 +30,50 @@ Shader::~Shader() {
 
 bool Shader::LoadShaderPart(const char* source, GLenum type)
 {
-	// Creates a new shader part (VS, FS, GS, etc...)
-	GLuint handle = glCreateShader(type);
-
-	// Load the GLSL source and compile it
-	glShaderSource(handle, 1, &source, nullptr);
-	glCompileShader(handle);
-
-	// Get the compilation status for the shader part
-	GLint status = 0;
-	glGetShaderiv(handle, GL_COMPILE_STATUS, &status);
-
-	if (status == GL_FALSE) {
-		// Get the size of the error log
-		GLint logSize = 0;
-		glGetShaderiv(handle, GL_INFO_LOG_LENGTH, &logSize);
-
-		// Create a new character buffer for the log
-		char* log = new char[logSize];
-
-		// Get the log
-		glGetShaderInfoLog(handle, logSize, &logSize, log);
-
-		// Dump error log
-		LOG_ERROR("Failed to compile shader part:\n{}", log);
-
-		// Clean up our log memory
-		delete[] log;
-
-		// Delete the broken shader result
-		glDeleteShader(handle);
-		handle = 0;
-	}
-
+	// We only hold on to the source here, ShaderLibrary compiles it when we link
 	switch (type) {
-		case GL_VERTEX_SHADER: _vs = handle; break;
-		case GL_FRAGMENT_SHADER: _fs = handle; break;
-		default: LOG_WARN("Not implemented"); break;
+		case GL_VERTEX_SHADER: _vertexSource = source; break;
+		case GL_FRAGMENT_SHADER: _fragmentSource = source; break;
+		default: LOG_WARN("Not implemented"); return false;
 	}
-
-	return status != GL_FALSE;
+	return true;
 }
 
 bool Shader::LoadShaderPartFromFile(const char* path, GLenum type) {
-	std::ifstream file(path);
-	if (!file.is_open()) {
-		LOG_ERROR("File not found: {}", path);
-		throw std::runtime_error("File not found, see logs for more information");
-	}
-	std::stringstream stream;
-	stream << file.rdbuf();
-	bool result = LoadShaderPart(stream.str().c_str(), type);
-	file.close();
-	return result;
+	return LoadShaderPart(ShaderLibrary::ReadSource(path).c_str(), type);
 }
 
 bool Shader::Link()
 {
-	LOG_ASSERT(_vs != 0 && _fs != 0, "Must attach both a vertex and fragment shader!");
-
-	// Attach our two shaders
-	glAttachShader(_handle, _vs);
-	glAttachShader(_handle, _fs);
-
-	// Perform linking
-	glLinkProgram(_handle);
-
-	// Remove shader parts to save space (we can do this since we only needed the shader parts to compile an actual shader program)
-	glDetachShader(_handle, _vs);
-	glDeleteShader(_vs);
-	glDetachShader(_handle, _fs);
-	glDeleteShader(_fs);
-
-	GLint status = 0;
-	glGetProgramiv(_handle, GL_LINK_STATUS, &status);
-
-	if (status == GL_FALSE)
-	{
-		// Get the length of the log
-		GLint length = 0;
-		glGetProgramiv(_handle, GL_INFO_LOG_LENGTH, &length);
-
-		if (length > 0) {
-			// Read the log from openGL
-			char* log = new char[length];
-			glGetProgramInfoLog(_handle, length, &length, log);
-			LOG_ERROR("Shader failed to link:\n{}", log);
-			delete[] log;
-		}
-		else {
-			LOG_ERROR("Shader failed to link for an unknown reason!");
-		}
+	LOG_ASSERT(!_vertexSource.empty() && !_fragmentSource.empty(), "Must attach both a vertex and fragment shader!");
+
+	// Either loads the program from the binary cache or compiles and links the stages,
+	// without waiting on the driver
+	ShaderLibrary::SubmitProgram(_handle, _vertexSource, _fragmentSource);
+	_pending = true;
+	_linked = false;
+
+	// Inside a batch we put off checking on the program until something needs it
+	return ShaderLibrary::IsBatching() ? true : _FinishLink();
+}
+
+bool Shader::_FinishLink() {
+	_pending = false;
+	_linked = ShaderLibrary::FinishProgram(_handle);
+	if (_linked) {
+		_ReflectUniforms();
+		_IntrospectMaterialBlock();
 	}
-	return status != GL_FALSE;
+	return _linked;
 }
 
 void Shader::Bind() {
-	glUseProgram(_handle);
+	_Resolve();
+	GLState::UseProgram(_handle);
 }
 
 void Shader::UnBind() {
-	glUseProgram(0);
+	GLState::UseProgram(0);
 }
 
 void Shader::SetUniformMatrix(int location, const glm::mat3* value, int count, bool transposed) {
@@ -173,24 +125,249 @@ void Shader::SetUniform(int location, const glm::bvec4* value, int count) {
 	glProgramUniform4i(location, value->x, value->y, value->z, value->w, 1);
 }
 
-int Shader::GetUniformLocation(const std::string& name) {
-	// Search the map for the given name
-	std::unordered_map<std::string, int>::const_iterator it = _uniformLocs.find(name);
-	int result = -1;
+int Shader::GetSamplerUnit(const std::string& name) {
+	int location = GetUniformLocation(name);
+	if (location == -1) {
+		return -1;
+	}
+
+	// Units are handed out by the shader the variants were built from, so a sampler that only
+	// some keywords turn on still gets one unit that every variant with it agrees on
+	Shader& owner = _base != nullptr ? *_base : *this;
+	std::unordered_map<std::string, int>::const_iterator it = owner._samplerUnits.find(name);
+	if (it != owner._samplerUnits.end()) {
+		return it->second;
+	}
+
+	// Samplers the source put on a unit stay there, everything else gets the next free one
+	int unit = -1;
+	if (_boundSamplers.count(UniformId::HashName(name.c_str())) != 0) {
+		glGetUniformiv(_handle, location, &unit);
+	} else {
+		unit = owner._nextSamplerUnit++;
+		// Through the id so the owner and all of its variants put the sampler on the same unit
+		owner.SetUniform(UniformId(name), unit);
+	}
+	owner._samplerUnits[name] = unit;
+	return unit;
+}
 
-	// If our entry was not found, we call glGetUniform and store it for next time
-	if (it == _uniformLocs.end()) {
-		result = glGetUniformLocation(_handle, name.c_str());
-		_uniformLocs[name] = result;
+// Defines have to come after #version, then #line puts the line numbers back in step with the file
+static std::string InsertDefines(const std::string& source, const std::string& defines) {
+	size_t version = source.find("#version");
+	size_t lineEnd = version == std::string::npos ? std::string::npos : source.find('\n', version);
+	if (lineEnd == std::string::npos) {
+		return defines + source;
+	}
+	size_t nextLine = std::count(source.begin(), source.begin() + lineEnd + 1, '\n') + 1;
+	return source.substr(0, lineEnd + 1) + defines + "#line " + std::to_string(nextLine) + "\n" + source.substr(lineEnd + 1);
+}
 
-		if (result == -1) {
-			LOG_WARN("Ignoring uniform \"{}\"", name);
+Shader::sptr Shader::GetVariant(const std::vector<std::string>& keywords) {
+	// A keyword the source never mentions can't change anything
+	std::vector<std::string> used;
+	for (const std::string& keyword : keywords) {
+		if (_vertexSource.find(keyword) != std::string::npos || _fragmentSource.find(keyword) != std::string::npos) {
+			used.push_back(keyword);
 		}
 	}
-	// Otherwise, we had a value in the map, return it
-	else {
-		result = it->second;
+	if (used.empty()) {
+		return shared_from_this();
+	}
+	std::sort(used.begin(), used.end());
+	used.erase(std::unique(used.begin(), used.end()), used.end());
+
+	std::string key;
+	std::string defines;
+	for (const std::string& keyword : used) {
+		key += key.empty() ? keyword : " " + keyword;
+		defines += "#define " + keyword + "\n";
+	}
+
+	std::unordered_map<std::string, sptr>::const_iterator it = _variants.find(key);
+	if (it != _variants.end()) {
+		return it->second;
+	}
+
+	sptr variant = Create();
+	variant->LoadShaderPart(InsertDefines(_vertexSource, defines).c_str(), GL_VERTEX_SHADER);
+	variant->LoadShaderPart(InsertDefines(_fragmentSource, defines).c_str(), GL_FRAGMENT_SHADER);
+	variant->Link();
+
+	// Start the variant off in the same state as us, samplers on the same units included
+	if (_Resolve() && variant->_Resolve()) {
+		_CopyUniformsTo(*variant);
+	}
+	// Our values only reach samplers we have too, the units cover ones only the variant has
+	for (const auto& kvp : _samplerUnits) {
+		variant->SetUniform(UniformId(kvp.first), kvp.second);
 	}
+	variant->_base = this;
+
+	LOG_INFO("Built shader variant [{}]", key);
+	_variants[key] = variant;
+	return variant;
+}
 
+void Shader::_CopyUniformsTo(Shader& target) {
+	GLint count = 0;
+	glGetProgramInterfaceiv(_handle, GL_UNIFORM, GL_ACTIVE_RESOURCES, &count);
+
+	const GLenum props[] = { GL_NAME_LENGTH, GL_LOCATION, GL_TYPE, GL_ARRAY_SIZE };
+	std::string name;
+	for (GLint i = 0; i < count; i++) {
+		GLint values[4] = { 0, -1, 0, 0 };
+		glGetProgramResourceiv(_handle, GL_UNIFORM, i, 4, props, 4, nullptr, values);
+		// Block members live in buffers, not in the program
+		if (values[1] == -1) {
+			continue;
+		}
+
+		name.assign(values[0], '\0');
+		glGetProgramResourceName(_handle, GL_UNIFORM, i, values[0], nullptr, &name[0]);
+		name.resize(values[0] > 0 ? values[0] - 1 : 0);
+		if (name.size() > 3 && name.compare(name.size() - 3, 3, "[0]") == 0) {
+			name.resize(name.size() - 3);
+		}
+
+		for (GLint element = 0; element < values[3]; element++) {
+			std::string elementName = values[3] > 1 ? name + "[" + std::to_string(element) + "]" : name;
+			GLint from = element == 0 ? values[1] : glGetUniformLocation(_handle, elementName.c_str());
+			GLint to = glGetUniformLocation(target._handle, elementName.c_str());
+			if (from == -1 || to == -1) {
+				continue;
+			}
+
+			float floats[16];
+			GLint ints[4];
+			switch (values[2]) {
+				case GL_FLOAT:      glGetUniformfv(_handle, from, floats); glProgramUniform1fv(target._handle, to, 1, floats); break;
+				case GL_FLOAT_VEC2: glGetUniformfv(_handle, from, floats); glProgramUniform2fv(target._handle, to, 1, floats); break;
+				case GL_FLOAT_VEC3: glGetUniformfv(_handle, from, floats); glProgramUniform3fv(target._handle, to, 1, floats); break;
+				case GL_FLOAT_VEC4: glGetUniformfv(_handle, from, floats); glProgramUniform4fv(target._handle, to, 1, floats); break;
+				case GL_FLOAT_MAT3: glGetUniformfv(_handle, from, floats); glProgramUniformMatrix3fv(target._handle, to, 1, GL_FALSE, floats); break;
+				case GL_FLOAT_MAT4: glGetUniformfv(_handle, from, floats); glProgramUniformMatrix4fv(target._handle, to, 1, GL_FALSE, floats); break;
+				case GL_INT_VEC2:
+				case GL_BOOL_VEC2:  glGetUniformiv(_handle, from, ints); glProgramUniform2iv(target._handle, to, 1, ints); break;
+				case GL_INT_VEC3:
+				case GL_BOOL_VEC3:  glGetUniformiv(_handle, from, ints); glProgramUniform3iv(target._handle, to, 1, ints); break;
+				case GL_INT_VEC4:
+				case GL_BOOL_VEC4:  glGetUniformiv(_handle, from, ints); glProgramUniform4iv(target._handle, to, 1, ints); break;
+				// Samplers are set as a single int too
+				case GL_INT:
+				case GL_BOOL:
+				case GL_SAMPLER_2D:
+				case GL_SAMPLER_3D:
+				case GL_SAMPLER_CUBE:
+				case GL_SAMPLER_2D_SHADOW:
+				case GL_SAMPLER_2D_ARRAY: glGetUniformiv(_handle, from, ints); glProgramUniform1iv(target._handle, to, 1, ints); break;
+				default:
+					LOG_WARN("Can't copy uniform \"{}\" to a shader variant, its type isn't handled", elementName);
+					break;
+			}
+		}
+	}
+}
+
+void Shader::_IntrospectMaterialBlock() {
+	_materialBlock = MaterialBlockLayout();
+
+	GLuint index = glGetProgramResourceIndex(_handle, GL_UNIFORM_BLOCK, MATERIAL_BLOCK_NAME);
+	if (index == GL_INVALID_INDEX) {
+		return;
+	}
+
+	const GLenum blockProps[] = { GL_BUFFER_BINDING, GL_BUFFER_DATA_SIZE, GL_NUM_ACTIVE_VARIABLES };
+	GLint blockValues[3] = { 0 };
+	glGetProgramResourceiv(_handle, GL_UNIFORM_BLOCK, index, 3, blockProps, 3, nullptr, blockValues);
+	_materialBlock.Binding = blockValues[0];
+	_materialBlock.Size = blockValues[1];
+
+	// The block's members are uniforms like any other, we just need their indices
+	std::vector<GLint> members(blockValues[2]);
+	const GLenum activeProp = GL_ACTIVE_VARIABLES;
+	glGetProgramResourceiv(_handle, GL_UNIFORM_BLOCK, index, 1, &activeProp, (GLsizei)members.size(), nullptr, members.data());
+
+	const GLenum memberProps[] = { GL_OFFSET, GL_TYPE, GL_MATRIX_STRIDE, GL_NAME_LENGTH };
+	for (GLint member : members) {
+		GLint values[4] = { 0 };
+		glGetProgramResourceiv(_handle, GL_UNIFORM, member, 4, memberProps, 4, nullptr, values);
+
+		// The reported length counts the null terminator
+		std::string name(values[3], '\0');
+		glGetProgramResourceName(_handle, GL_UNIFORM, member, values[3], nullptr, &name[0]);
+		name.resize(values[3] > 0 ? values[3] - 1 : 0);
+
+		_materialBlock.Members[name] = { values[0], (GLenum)values[1], values[2] };
+	}
+}
+
+void Shader::_FindBoundSamplers(const std::string& source) {
+	// layout(..., binding = N, ...) uniform <type> <name>
+	static const std::regex declaration(R"(layout\s*\(([^)]*)\)\s*uniform\s+\w+\s+(\w+))");
+	for (std::sregex_iterator it(source.begin(), source.end(), declaration), end; it != end; ++it) {
+		if ((*it)[1].str().find("binding") != std::string::npos) {
+			_boundSamplers.insert(UniformId::HashName((*it)[2].str().c_str()));
+		}
+	}
+}
+
+void Shader::_ReflectUniforms() {
+	_uniformLocs.clear();
+	_missingUniforms.clear();
+	_boundSamplers.clear();
+	_FindBoundSamplers(_vertexSource);
+	_FindBoundSamplers(_fragmentSource);
+
+	GLint count = 0;
+	glGetProgramInterfaceiv(_handle, GL_UNIFORM, GL_ACTIVE_RESOURCES, &count);
+
+	const GLenum props[] = { GL_NAME_LENGTH, GL_LOCATION };
+	std::string name;
+	for (GLint i = 0; i < count; i++) {
+		GLint values[2] = { 0, -1 };
+		glGetProgramResourceiv(_handle, GL_UNIFORM, i, 2, props, 2, nullptr, values);
+		// Uniform block members don't have a location, materials find those through the block layout
+		if (values[1] == -1) {
+			continue;
+		}
+
+		// The reported length counts the null terminator
+		name.assign(values[0], '\0');
+		glGetProgramResourceName(_handle, GL_UNIFORM, i, values[0], nullptr, &name[0]);
+		name.resize(values[0] > 0 ? values[0] - 1 : 0);
+		_uniformLocs.push_back({ UniformId::HashName(name.c_str()), values[1] });
+
+		// Arrays come back as "name[0]", but they get set by their plain name
+		if (name.size() > 3 && name.compare(name.size() - 3, 3, "[0]") == 0) {
+			name.resize(name.size() - 3);
+			_uniformLocs.push_back({ UniformId::HashName(name.c_str()), values[1] });
+		}
+	}
+
+	std::sort(_uniformLocs.begin(), _uniformLocs.end(), [](const UniformLocation& a, const UniformLocation& b) {
+		return a.Hash < b.Hash;
+	});
+	for (size_t i = 1; i < _uniformLocs.size(); i++) {
+		if (_uniformLocs[i].Hash == _uniformLocs[i - 1].Hash) {
+			LOG_WARN("Two uniforms in shader {} hash to the same id, one of them can't be set", _handle);
+		}
+	}
+}
+
+int Shader::GetUniformLocation(UniformId id) {
+	_Resolve();
+	std::vector<UniformLocation>::const_iterator it = std::lower_bound(_uniformLocs.begin(), _uniformLocs.end(), id.Hash,
+		[](const UniformLocation& entry, uint32_t hash) { return entry.Hash < hash; });
+	return (it != _uniformLocs.end() && it->Hash == id.Hash) ? it->Location : -1;
+}
+
+int Shader::GetUniformLocation(const std::string& name) {
+	UniformId id(name);
+	int result = GetUniformLocation(id);
+
+	if (result == -1 && _missingUniforms.insert(id.Hash).second) {
+		LOG_WARN("Ignoring uniform \"{}\"", name);
+	}
 	return result;
 }
\ No newline at end of file
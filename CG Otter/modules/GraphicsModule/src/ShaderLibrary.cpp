@@ -0,0 +1,404 @@
+#include "ShaderLibrary.h"
+#include "Logging.h"
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <chrono>
+#include <cstring>
+#include <cstdio>
+#include <filesystem>
+
+std::unordered_map<uint64_t, GLuint> ShaderLibrary::_stages;
+std::unordered_map<uint64_t, Shader::sptr> ShaderLibrary::_programs;
+std::vector<ShaderLibrary::PendingProgram> ShaderLibrary::_pending;
+bool ShaderLibrary::_batching = false;
+bool ShaderLibrary::_parallelCompile = false;
+std::string ShaderLibrary::_cacheDirectory;
+uint64_t ShaderLibrary::_driverHash = 0;
+bool ShaderLibrary::_binariesSupported = false;
+float ShaderLibrary::_buildTime = 0.0f;
+unsigned ShaderLibrary::_cachedCount = 0;
+unsigned ShaderLibrary::_compiledCount = 0;
+unsigned ShaderLibrary::_sharedStageCount = 0;
+
+// What gets written in front of each program binary
+struct CacheHeader {
+	uint32_t Magic;
+	GLenum   Format;
+	uint64_t DriverHash;
+	uint64_t Key;
+	uint32_t Length;
+};
+
+// glMaxShaderCompilerThreadsKHR, isn't in our glad so we look it up ourselves
+typedef void (APIENTRYP PFNGLMAXSHADERCOMPILERTHREADSPROC)(GLuint count);
+
+void ShaderLibrary::Init(const std::string& cacheDirectory, GLADloadproc loader) {
+	// Both versions of the extension work the same way, just with different suffixes
+	GLint extensionCount = 0;
+	glGetIntegerv(GL_NUM_EXTENSIONS, &extensionCount);
+	for (GLint i = 0; i < extensionCount && loader != nullptr && !_parallelCompile; i++) {
+		const char* extension = reinterpret_cast<const char*>(glGetStringi(GL_EXTENSIONS, i));
+		const char* function = nullptr;
+		if (strcmp(extension, "GL_KHR_parallel_shader_compile") == 0) {
+			function = "glMaxShaderCompilerThreadsKHR";
+		} else if (strcmp(extension, "GL_ARB_parallel_shader_compile") == 0) {
+			function = "glMaxShaderCompilerThreadsARB";
+		}
+		if (function != nullptr) {
+			PFNGLMAXSHADERCOMPILERTHREADSPROC maxThreads = (PFNGLMAXSHADERCOMPILERTHREADSPROC)loader(function);
+			if (maxThreads != nullptr) {
+				// All ones lets the driver pick how many threads to use
+				maxThreads(0xFFFFFFFF);
+				_parallelCompile = true;
+			}
+		}
+	}
+	LOG_INFO("Parallel shader compile {}", _parallelCompile ? "enabled" : "not supported");
+
+	GLint formatCount = 0;
+	glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formatCount);
+	_binariesSupported = formatCount > 0;
+	if (!_binariesSupported) {
+		LOG_WARN("Driver doesn't support program binaries, shaders will compile from source every run");
+		return;
+	}
+
+	// A driver update can change what it accepts, so everything that identifies it goes into the key
+	uint64_t hash = Hash(nullptr, 0);
+	for (GLenum name : { GL_VENDOR, GL_RENDERER, GL_VERSION }) {
+		const char* value = reinterpret_cast<const char*>(glGetString(name));
+		if (value != nullptr) {
+			hash = Hash(value, strlen(value), hash);
+		}
+	}
+	_driverHash = hash;
+
+	_cacheDirectory = cacheDirectory;
+	std::error_code error;
+	std::filesystem::create_directories(_cacheDirectory, error);
+	if (error) {
+		LOG_WARN("Couldn't create shader cache folder \"{}\": {}", _cacheDirectory, error.message());
+		_binariesSupported = false;
+	}
+}
+
+void ShaderLibrary::Unload() {
+	EndBatch();
+	ReleaseStages();
+	_programs.clear();
+}
+
+Shader::sptr ShaderLibrary::LoadFromFiles(const char* vertexPath, const char* fragmentPath) {
+	return LoadFromSource(ReadSource(vertexPath), ReadSource(fragmentPath));
+}
+
+Shader::sptr ShaderLibrary::LoadFromSource(const std::string& vertexSource, const std::string& fragmentSource) {
+	uint64_t key = Hash(fragmentSource.data(), fragmentSource.size(), Hash(vertexSource.data(), vertexSource.size()));
+	auto it = _programs.find(key);
+	if (it != _programs.end()) {
+		return it->second;
+	}
+
+	Shader::sptr result = Shader::Create();
+	result->LoadShaderPart(vertexSource.c_str(), GL_VERTEX_SHADER);
+	result->LoadShaderPart(fragmentSource.c_str(), GL_FRAGMENT_SHADER);
+	result->Link();
+	_programs[key] = result;
+	return result;
+}
+
+void ShaderLibrary::BeginBatch() {
+	_batching = true;
+}
+
+void ShaderLibrary::EndBatch() {
+	_batching = false;
+
+	auto start = std::chrono::high_resolution_clock::now();
+	while (!_pending.empty()) {
+		// Take whatever's done first, and only block when nothing is
+		size_t next = 0;
+		for (size_t i = 0; i < _pending.size(); i++) {
+			if (_IsComplete(_pending[i].Program)) {
+				next = i;
+				break;
+			}
+		}
+		PendingProgram pending = _pending[next];
+		_pending.erase(_pending.begin() + next);
+		_Finish(pending);
+	}
+	_buildTime += std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+}
+
+void ShaderLibrary::SubmitProgram(GLuint program, const std::string& vertexSource, const std::string& fragmentSource) {
+	auto start = std::chrono::high_resolution_clock::now();
+
+	PendingProgram pending;
+	pending.Program = program;
+	pending.Key = Hash(fragmentSource.data(), fragmentSource.size(), Hash(vertexSource.data(), vertexSource.size()));
+	pending.VertexStage = 0;
+	pending.FragmentStage = 0;
+
+	if (_LoadBinary(program, pending.Key)) {
+		_cachedCount++;
+	} else {
+		pending.VertexStage = _GetStage(vertexSource, GL_VERTEX_SHADER);
+		pending.FragmentStage = _GetStage(fragmentSource, GL_FRAGMENT_SHADER);
+
+		// Has to be set before linking or the driver is free to throw the binary away
+		if (_binariesSupported) {
+			glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+		}
+
+		// Linking doesn't wait on the stages, if one of them failed the link fails and we find out in _Finish
+		glAttachShader(program, pending.VertexStage);
+		glAttachShader(program, pending.FragmentStage);
+		glLinkProgram(program);
+		// The stages stay alive in the library for the next program that needs them
+		glDetachShader(program, pending.VertexStage);
+		glDetachShader(program, pending.FragmentStage);
+		_compiledCount++;
+	}
+	_pending.push_back(pending);
+
+	_buildTime += std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+}
+
+bool ShaderLibrary::FinishProgram(GLuint program) {
+	for (size_t i = 0; i < _pending.size(); i++) {
+		if (_pending[i].Program == program) {
+			auto start = std::chrono::high_resolution_clock::now();
+			PendingProgram pending = _pending[i];
+			_pending.erase(_pending.begin() + i);
+			bool linked = _Finish(pending);
+			_buildTime += std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+			return linked;
+		}
+	}
+
+	// Already finished, the status is cheap to ask for now
+	GLint status = 0;
+	glGetProgramiv(program, GL_LINK_STATUS, &status);
+	return status != GL_FALSE;
+}
+
+void ShaderLibrary::CancelProgram(GLuint program) {
+	for (size_t i = 0; i < _pending.size(); i++) {
+		if (_pending[i].Program == program) {
+			_pending.erase(_pending.begin() + i);
+			return;
+		}
+	}
+}
+
+void ShaderLibrary::ReleaseStages() {
+	for (auto& kvp : _stages) {
+		glDeleteShader(kvp.second);
+	}
+	_stages.clear();
+}
+
+std::string ShaderLibrary::ReadSource(const char* path) {
+	return _ReadSource(path, 0);
+}
+
+std::string ShaderLibrary::_ReadSource(const std::string& path, int depth) {
+	if (depth > MAX_INCLUDE_DEPTH) {
+		LOG_ERROR("Shader includes nested too deep at {}, is something including itself?", path);
+		throw std::runtime_error("Shader include loop, see logs for more information");
+	}
+
+	std::ifstream file(path);
+	if (!file.is_open()) {
+		LOG_ERROR("File not found: {}", path);
+		throw std::runtime_error("File not found, see logs for more information");
+	}
+
+	std::filesystem::path directory = std::filesystem::path(path).parent_path();
+	std::stringstream result;
+	std::string line;
+	int lineNumber = 0;
+	while (std::getline(file, line)) {
+		lineNumber++;
+
+		size_t start = line.find_first_not_of(" \t");
+		if (start != std::string::npos && line.compare(start, 8, "#include") == 0) {
+			size_t open = line.find('"', start + 8);
+			size_t close = open == std::string::npos ? std::string::npos : line.find('"', open + 1);
+			if (close == std::string::npos) {
+				LOG_ERROR("Bad #include on line {} of {}", lineNumber, path);
+				throw std::runtime_error("Bad shader include, see logs for more information");
+			}
+			std::string included = (directory / line.substr(open + 1, close - open - 1)).string();
+			result << _ReadSource(included, depth + 1);
+			// Puts the line numbers in compile errors back in step with this file
+			result << "#line " << lineNumber + 1 << "\n";
+		} else {
+			result << line << "\n";
+		}
+	}
+	return result.str();
+}
+
+uint64_t ShaderLibrary::Hash(const void* data, size_t size, uint64_t seed) {
+	const uint8_t* bytes = static_cast<const uint8_t*>(data);
+	uint64_t hash = seed;
+	for (size_t i = 0; i < size; i++) {
+		hash = (hash ^ bytes[i]) * 1099511628211ull;
+	}
+	return hash;
+}
+
+GLuint ShaderLibrary::_GetStage(const std::string& source, GLenum type) {
+	uint64_t key = Hash(&type, sizeof(GLenum), Hash(source.data(), source.size()));
+	auto it = _stages.find(key);
+	if (it != _stages.end()) {
+		_sharedStageCount++;
+		return it->second;
+	}
+
+	// No status check here, that would make us wait for the compile to finish
+	GLuint handle = glCreateShader(type);
+	const char* text = source.c_str();
+	glShaderSource(handle, 1, &text, nullptr);
+	glCompileShader(handle);
+
+	_stages[key] = handle;
+	return handle;
+}
+
+void ShaderLibrary::_ReportStage(GLuint stage) {
+	// Another program that shared the stage may have already reported and deleted it
+	if (!glIsShader(stage)) {
+		return;
+	}
+	GLint status = 0;
+	glGetShaderiv(stage, GL_COMPILE_STATUS, &status);
+	if (status != GL_FALSE) {
+		return;
+	}
+
+	GLint logSize = 0;
+	glGetShaderiv(stage, GL_INFO_LOG_LENGTH, &logSize);
+	std::vector<char> log(logSize > 0 ? logSize : 1, '\0');
+	glGetShaderInfoLog(stage, logSize, &logSize, log.data());
+	LOG_ERROR("Failed to compile shader part:\n{}", log.data());
+
+	// Broken stages aren't kept, so fixing the file and reloading tries again
+	for (auto it = _stages.begin(); it != _stages.end(); ++it) {
+		if (it->second == stage) {
+			_stages.erase(it);
+			break;
+		}
+	}
+	glDeleteShader(stage);
+}
+
+bool ShaderLibrary::_IsComplete(GLuint program) {
+	if (!_parallelCompile) {
+		return false;
+	}
+	GLint complete = GL_FALSE;
+	glGetProgramiv(program, COMPLETION_STATUS, &complete);
+	return complete != GL_FALSE;
+}
+
+bool ShaderLibrary::_Finish(const PendingProgram& pending) {
+	GLint status = 0;
+	glGetProgramiv(pending.Program, GL_LINK_STATUS, &status);
+	bool linked = status != GL_FALSE;
+
+	// Programs from the cache were already checked when we loaded them
+	if (pending.VertexStage == 0) {
+		return linked;
+	}
+
+	if (!linked) {
+		// The stage logs say more than the link log when it's a compile error
+		_ReportStage(pending.VertexStage);
+		_ReportStage(pending.FragmentStage);
+
+		// Get the length of the log
+		GLint length = 0;
+		glGetProgramiv(pending.Program, GL_INFO_LOG_LENGTH, &length);
+
+		if (length > 0) {
+			// Read the log from openGL
+			std::vector<char> log(length);
+			glGetProgramInfoLog(pending.Program, length, &length, log.data());
+			LOG_ERROR("Shader failed to link:\n{}", log.data());
+		} else {
+			LOG_ERROR("Shader failed to link for an unknown reason!");
+		}
+	} else {
+		_SaveBinary(pending.Program, pending.Key);
+	}
+	return linked;
+}
+
+std::string ShaderLibrary::_CachePath(uint64_t key) {
+	char name[32];
+	snprintf(name, sizeof(name), "%016llx.bin", (unsigned long long)key);
+	return (std::filesystem::path(_cacheDirectory) / name).string();
+}
+
+bool ShaderLibrary::_LoadBinary(GLuint program, uint64_t key) {
+	if (!_binariesSupported) {
+		return false;
+	}
+
+	std::ifstream file(_CachePath(key), std::ios::binary);
+	if (!file.is_open()) {
+		return false;
+	}
+
+	CacheHeader header;
+	if (!file.read(reinterpret_cast<char*>(&header), sizeof(CacheHeader)) ||
+		header.Magic != CACHE_MAGIC || header.DriverHash != _driverHash || header.Key != key) {
+		return false;
+	}
+	std::vector<char> binary(header.Length);
+	if (!file.read(binary.data(), header.Length)) {
+		return false;
+	}
+
+	glProgramBinary(program, header.Format, binary.data(), (GLsizei)header.Length);
+	GLint status = 0;
+	glGetProgramiv(program, GL_LINK_STATUS, &status);
+	if (status == GL_FALSE) {
+		// Drivers can reject a binary for any reason, we just build it again and overwrite the file
+		LOG_INFO("Cached shader program {:016x} was rejected, recompiling", key);
+		return false;
+	}
+	return true;
+}
+
+void ShaderLibrary::_SaveBinary(GLuint program, uint64_t key) {
+	if (!_binariesSupported) {
+		return;
+	}
+
+	GLint length = 0;
+	glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+	if (length <= 0) {
+		return;
+	}
+
+	CacheHeader header;
+	header.Magic = CACHE_MAGIC;
+	header.DriverHash = _driverHash;
+	header.Key = key;
+	std::vector<char> binary(length);
+	glGetProgramBinary(program, length, &length, &header.Format, binary.data());
+	header.Length = (uint32_t)length;
+
+	std::ofstream file(_CachePath(key), std::ios::binary | std::ios::trunc);
+	if (!file.is_open()) {
+		LOG_WARN("Couldn't write shader cache file {}", _CachePath(key));
+		return;
+	}
+	file.write(reinterpret_cast<const char*>(&header), sizeof(CacheHeader));
+	file.write(binary.data(), length);
+}
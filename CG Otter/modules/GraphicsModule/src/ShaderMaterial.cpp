@@ -1,92 +1,220 @@
 #include "ShaderMaterial.h"
+#include "GLState.h"
+#include <cstring>
+#include <algorithm>
 
-template<typename T>
-void SubmitUniforms(const Shader::sptr& shader, const std::unordered_map<ShaderParamName, T>& values) {
-	for (auto& kvp : values) {
-		shader->SetUniform(kvp.first.Location, kvp.second);
-	}
-}
-
-template<typename T>
-void SubmitUniformsMat(const Shader::sptr& shader, const std::unordered_map<ShaderParamName, T>& values) {
-	for (auto& kvp : values) {
-		shader->SetUniformMatrix(kvp.first.Location, kvp.second);
-	}
-}
+uint32_t ShaderMaterial::_nextId = 0;
+std::vector<std::string> ShaderMaterial::_globalKeywords;
+uint32_t ShaderMaterial::_globalKeywordVersion = 0;
 
 ShaderMaterial::ShaderMaterial()
-	: Shader(nullptr),  RenderLayer(0)
+	: Shader(nullptr),  RenderLayer(0), _id(_nextId++),
+	_blockBuffer(0), _blockBinding(-1), _blockDirty(false), _layoutShader(nullptr),
+	_program(nullptr), _programShader(nullptr), _programKeywordVersion(0), _keywordsChanged(false)
 {
 }
 
 ShaderMaterial::~ShaderMaterial() {
 	LOG_INFO("Deleting material");
+	if (_blockBuffer != 0) {
+		GLState::OnBufferDeleted(_blockBuffer);
+		glDeleteBuffers(1, &_blockBuffer);
+		_blockBuffer = 0;
+	}
 }
 
 void ShaderMaterial::Apply()
-{	
-	int slot = 1;
-	for (auto& kvp : Textures) {
-		if (kvp.first.Location != -1 && kvp.second != nullptr) {
-			Shader->SetUniform(kvp.first.Location, slot);
-			kvp.second->Bind(slot);
-			slot++;
+{
+	if (_blockBinding != -1) {
+		if (_blockDirty) {
+			_UploadBlock();
+		}
+		GLState::BindUniformBuffer(_blockBinding, _blockBuffer, 0, (GLsizeiptr)_block.size());
+	}
+
+	// Picks the variant first, a keyword change can give a texture the unit it was missing
+	const Shader::sptr& program = GetProgram();
+
+	// Every material on a shader puts a given sampler on the same unit, so these are
+	// elided by GLState unless the texture is actually different from the last material's
+	for (const TextureBinding& binding : _textures) {
+		if (binding.Texture != nullptr && binding.Unit != -1) {
+			binding.Texture->Bind(binding.Unit);
 		}
 	}
 
-	SubmitUniforms(Shader, FloatParams);
-	SubmitUniforms(Shader, Vec2Params);
-	SubmitUniforms(Shader, Vec3Params);
-	SubmitUniforms(Shader, Vec4Params);
-	SubmitUniformsMat(Shader, Mat4Params);
-	SubmitUniformsMat(Shader, Mat3Params);
+	if (_looseParams.empty()) {
+		return;
+	}
+	for (const LooseParam& param : _looseParams) {
+		if (param.Location == -1) {
+			continue;
+		}
+		switch (param.Type) {
+			case GL_FLOAT:      program->SetUniform(param.Location, param.Data); break;
+			case GL_FLOAT_VEC2: program->SetUniform(param.Location, reinterpret_cast<const glm::vec2*>(param.Data)); break;
+			case GL_FLOAT_VEC3: program->SetUniform(param.Location, reinterpret_cast<const glm::vec3*>(param.Data)); break;
+			case GL_FLOAT_VEC4: program->SetUniform(param.Location, reinterpret_cast<const glm::vec4*>(param.Data)); break;
+			case GL_FLOAT_MAT3: program->SetUniformMatrix(param.Location, reinterpret_cast<const glm::mat3*>(param.Data)); break;
+			case GL_FLOAT_MAT4: program->SetUniformMatrix(param.Location, reinterpret_cast<const glm::mat4*>(param.Data)); break;
+			default: break;
+		}
+	}
+}
+
+const Shader::sptr& ShaderMaterial::GetProgram() {
+	if (_program == nullptr || _programShader != Shader.get() || _keywordsChanged || _programKeywordVersion != _globalKeywordVersion) {
+		_programShader = Shader.get();
+		_programKeywordVersion = _globalKeywordVersion;
+		_keywordsChanged = false;
+
+		if (Shader == nullptr) {
+			_program = nullptr;
+			return _program;
+		}
+
+		std::vector<std::string> keywords = _keywords;
+		keywords.insert(keywords.end(), _globalKeywords.begin(), _globalKeywords.end());
+		_program = Shader->GetVariant(keywords);
+
+		// Variants lay their uniforms out however they like, so find the loose ones again
+		for (LooseParam& param : _looseParams) {
+			param.Location = _program->GetUniformLocation(UniformId(param.Name));
+		}
+		// Samplers behind a keyword are only in the variants that turn it on
+		for (TextureBinding& binding : _textures) {
+			binding.Unit = _program->GetSamplerUnit(binding.Name);
+		}
+	}
+	return _program;
+}
+
+void ShaderMaterial::SetKeyword(const std::string& keyword, bool enabled) {
+	if (_SetKeyword(_keywords, keyword, enabled)) {
+		_keywordsChanged = true;
+	}
+}
+
+void ShaderMaterial::SetGlobalKeyword(const std::string& keyword, bool enabled) {
+	if (_SetKeyword(_globalKeywords, keyword, enabled)) {
+		_globalKeywordVersion++;
+	}
+}
+
+bool ShaderMaterial::_SetKeyword(std::vector<std::string>& keywords, const std::string& keyword, bool enabled) {
+	auto it = std::find(keywords.begin(), keywords.end(), keyword);
+	if (enabled && it == keywords.end()) {
+		keywords.push_back(keyword);
+		return true;
+	}
+	if (!enabled && it != keywords.end()) {
+		keywords.erase(it);
+		return true;
+	}
+	return false;
 }
 
 void ShaderMaterial::Set(const std::string& name, const ITexture::sptr& texture) {
 	LOG_ASSERT(Shader != nullptr, "Must set Material shader before setting params");
-	ShaderParamName pName = name;
-	pName.Location = Shader->GetUniformLocation(name);
-	Textures[pName] = texture;
+	_ResolveLayout();
+
+	for (TextureBinding& binding : _textures) {
+		if (binding.Name == name) {
+			binding.Texture = texture;
+			return;
+		}
+	}
+	// Kept even if the current variant doesn't have the sampler, GetProgram looks the unit up again when the variant changes
+	_textures.push_back({ name, GetProgram()->GetSamplerUnit(name), texture });
 }
 
 void ShaderMaterial::Set(const std::string& name, float value) {
-	LOG_ASSERT(Shader != nullptr, "Must set Material shader before setting params");
-	ShaderParamName pName = name;
-	pName.Location = Shader->GetUniformLocation(name);
-	FloatParams[pName] = value;
+	_SetParam(name, GL_FLOAT, 1, 1, &value);
 }
 
 void ShaderMaterial::Set(const std::string& name, const glm::vec2& value) {
-	LOG_ASSERT(Shader != nullptr, "Must set Material shader before setting params");
-	ShaderParamName pName = name;
-	pName.Location = Shader->GetUniformLocation(name);
-	Vec2Params[pName] = value;
+	_SetParam(name, GL_FLOAT_VEC2, 1, 2, glm::value_ptr(value));
 }
 
 void ShaderMaterial::Set(const std::string& name, const glm::vec3& value) {
-	LOG_ASSERT(Shader != nullptr, "Must set Material shader before setting params");
-	ShaderParamName pName = name;
-	pName.Location = Shader->GetUniformLocation(name);
-	Vec3Params[pName] = value;
+	_SetParam(name, GL_FLOAT_VEC3, 1, 3, glm::value_ptr(value));
 }
 
 void ShaderMaterial::Set(const std::string& name, const glm::vec4& value) {
-	LOG_ASSERT(Shader != nullptr, "Must set Material shader before setting params");
-	ShaderParamName pName = name;
-	pName.Location = Shader->GetUniformLocation(name);
-	Vec4Params[pName] = value;
+	_SetParam(name, GL_FLOAT_VEC4, 1, 4, glm::value_ptr(value));
 }
 
 void ShaderMaterial::Set(const std::string& name, const glm::mat4& value) {
-	LOG_ASSERT(Shader != nullptr, "Must set Material shader before setting params");
-	ShaderParamName pName = name;
-	pName.Location = Shader->GetUniformLocation(name);
-	Mat4Params[pName] = value;
+	_SetParam(name, GL_FLOAT_MAT4, 4, 4, glm::value_ptr(value));
 }
 
 void ShaderMaterial::Set(const std::string& name, const glm::mat3& value) {
+	_SetParam(name, GL_FLOAT_MAT3, 3, 3, glm::value_ptr(value));
+}
+
+void ShaderMaterial::_ResolveLayout() {
+	if (_layoutShader == Shader.get()) {
+		return;
+	}
+	LOG_ASSERT(_layoutShader == nullptr, "Material shader can't change once params have been set");
+	_layoutShader = Shader.get();
+
+	const MaterialBlockLayout& layout = Shader->GetMaterialBlockLayout();
+	_blockBinding = layout.Binding;
+	if (_blockBinding != -1) {
+		// Anything the material never sets stays zero, same as an unset uniform
+		_block.assign(layout.Size, 0);
+		_blockDirty = true;
+	}
+}
+
+void ShaderMaterial::_SetParam(const std::string& name, GLenum type, int columns, int rows, const float* data) {
 	LOG_ASSERT(Shader != nullptr, "Must set Material shader before setting params");
-	ShaderParamName pName = name;
-	pName.Location = Shader->GetUniformLocation(name);
-	Mat3Params[pName] = value;
+	_ResolveLayout();
+
+	const MaterialBlockLayout& layout = Shader->GetMaterialBlockLayout();
+	auto it = layout.Members.find(name);
+	if (it != layout.Members.end()) {
+		const MaterialBlockMember& member = it->second;
+		if (member.Type != type) {
+			LOG_WARN("Material param \"{}\" doesn't match the type declared in the shader", name);
+			return;
+		}
+		// std140 gives every matrix column its own stride, vectors and scalars are just one column
+		for (int column = 0; column < columns; column++) {
+			memcpy(&_block[member.Offset + column * member.MatrixStride], data + column * rows, rows * sizeof(float));
+		}
+		_blockDirty = true;
+		return;
+	}
+
+	// Warns once here if the shader doesn't have the uniform at all
+	if (Shader->GetUniformLocation(name) == -1) {
+		return;
+	}
+	LooseParam* param = nullptr;
+	for (LooseParam& existing : _looseParams) {
+		if (existing.Name == name) {
+			param = &existing;
+			break;
+		}
+	}
+	if (param == nullptr) {
+		_looseParams.emplace_back();
+		param = &_looseParams.back();
+		param->Name = name;
+		param->Location = GetProgram()->GetUniformLocation(UniformId(name));
+	}
+	param->Type = type;
+	memcpy(param->Data, data, columns * rows * sizeof(float));
+}
+
+void ShaderMaterial::_UploadBlock() {
+	if (_blockBuffer == 0) {
+		glCreateBuffers(1, &_blockBuffer);
+		glNamedBufferStorage(_blockBuffer, (GLsizeiptr)_block.size(), _block.data(), GL_DYNAMIC_STORAGE_BIT);
+	} else {
+		glNamedBufferSubData(_blockBuffer, 0, (GLsizeiptr)_block.size(), _block.data());
+	}
+	_blockDirty = false;
 }
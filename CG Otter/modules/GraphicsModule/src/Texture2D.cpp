@@ -1,4 +1,5 @@
 #include "Texture2D.h"
+#include "GLState.h"
 
 Texture2D::Texture2D(const Texture2DDescription& description) :
 	ITexture(), _description(description)
@@ -9,6 +10,7 @@ Texture2D::Texture2D(const Texture2DDescription& description) :
 
 void Texture2D::_RecreateTexture() {
 	if (_handle != 0) {
+		GLState::OnTextureDeleted(_handle);
 		glDeleteTextures(1, &_handle);
 		_handle = 0;
 	}
@@ -1,4 +1,5 @@
 #include "TextureCubeMap.h"
+#include "GLState.h"
 
 TextureCubeMap::TextureCubeMap(const TextureCubeDesc& description) :
 	ITexture(), _description(description)
@@ -9,6 +10,7 @@ TextureCubeMap::TextureCubeMap(const TextureCubeDesc& description) :
 
 void TextureCubeMap::_RecreateTexture() {
 	if (_handle != 0) {
+		GLState::OnTextureDeleted(_handle);
 		glDeleteTextures(1, &_handle);
 		_handle = 0;
 	}
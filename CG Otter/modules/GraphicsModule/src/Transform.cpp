@@ -6,44 +6,69 @@
 
 #include "Logging.h"
 
-const glm::mat4 IDENTITY = glm::mat4(1.0f);
+Transform::Transform(const Transform& other) :
+	_slot(TransformSystem::Allocate()),
+	_parent(other._parent),
+	_gameObject(other._gameObject)
+{
+	TransformSystem::CopyLocal(_slot, other._slot);
+	TransformSystem::SetParent(_slot, TransformSystem::GetParent(other._slot));
+}
+
+Transform::Transform(Transform&& other) noexcept :
+	_slot(other._slot),
+	_parent(other._parent),
+	_gameObject(other._gameObject)
+{
+	other._slot = TransformSystem::NULL_SLOT;
+}
+
+Transform& Transform::operator=(const Transform& other) {
+	if (this != &other) {
+		_parent = other._parent;
+		_gameObject = other._gameObject;
+		TransformSystem::CopyLocal(_slot, other._slot);
+		TransformSystem::SetParent(_slot, TransformSystem::GetParent(other._slot));
+	}
+	return *this;
+}
+
+Transform& Transform::operator=(Transform&& other) noexcept {
+	// Swapping hands our old slot to other, so it gets freed when other is destroyed
+	std::swap(_slot, other._slot);
+	std::swap(_parent, other._parent);
+	std::swap(_gameObject, other._gameObject);
+	return *this;
+}
+
+Transform::~Transform() {
+	if (_slot != TransformSystem::NULL_SLOT) {
+		TransformSystem::Free(_slot);
+	}
+}
 
 Transform& Transform::SetLocalRotation(const glm::vec3 eulerDegrees) {
-	_rotationEulerDeg = eulerDegrees;
-	_rotation = glm::quat(glm::radians(eulerDegrees));
-	_isLocalDirty = true;
+	TransformSystem::SetRotation(_slot, eulerDegrees);
 	return *this;
 }
 
 Transform& Transform::SetLocalRotation(const glm::quat& quaternion) {
-	_rotation = quaternion;
-	_rotationEulerDeg = glm::degrees(glm::eulerAngles(_rotation));
-	_isLocalDirty = true;
+	TransformSystem::SetRotation(_slot, quaternion);
 	return *this;
 }
 
 Transform& Transform::SetLocalRotation(float yawDeg, float pitchDeg, float rollDeg) {
-	_rotationEulerDeg.x = yawDeg;
-	_rotationEulerDeg.y = pitchDeg;
-	_rotationEulerDeg.z = rollDeg;
-	_rotation = glm::quat(glm::radians(_rotationEulerDeg));
-	_isLocalDirty = true;
+	TransformSystem::SetRotation(_slot, glm::vec3(yawDeg, pitchDeg, rollDeg));
 	return *this;
 }
 
 Transform& Transform::SetLocalPosition(float x, float y, float z) {
-	_position.x = x;
-	_position.y = y;
-	_position.z = z;
-	_isLocalDirty = true;
+	TransformSystem::SetPosition(_slot, glm::vec3(x, y, z));
 	return *this;
 }
 
 Transform& Transform::SetLocalScale(float x, float y, float z) {
-	_scale.x = x;
-	_scale.y = y;
-	_scale.z = z;
-	_isLocalDirty = true;
+	TransformSystem::SetScale(_slot, glm::vec3(x, y, z));
 	return *this;
 }
 
@@ -53,9 +78,8 @@ Transform& Transform::RotateLocal(float yawDeg, float pitchDeg, float rollDeg) {
 }
 
 Transform& Transform::RotateLocalFixed(const glm::vec3& rotationDeg) {
-	_rotation = glm::quat(glm::radians(rotationDeg)) * _rotation;
-	_rotationEulerDeg = glm::degrees(glm::eulerAngles(_rotation));
-	_isLocalDirty = true;
+	// The euler angles are only worked out again if someone asks for them
+	TransformSystem::SetRotation(_slot, glm::quat(glm::radians(rotationDeg)) * TransformSystem::GetRotation(_slot));
 	return *this;
 }
 
@@ -65,28 +89,23 @@ Transform& Transform::RotateLocalFixed(float yawDeg, float pitchDeg, float rollD
 }
 
 Transform& Transform::SetLocalPosition(const glm::vec3 value) {
-	_position = value;
-	_isLocalDirty = true;
+	TransformSystem::SetPosition(_slot, value);
 	return *this;
 }
 
 Transform& Transform::SetLocalScale(const glm::vec3 value) {
-	_scale = value;
-	_isLocalDirty = true;
+	TransformSystem::SetScale(_slot, value);
 	return *this;
 }
 
 Transform& Transform::RotateLocal(const glm::vec3& rotation) {
-	_rotation = _rotation * glm::quat(glm::radians(rotation));
-	_rotationEulerDeg = glm::degrees(glm::eulerAngles(_rotation));
-	_isLocalDirty = true;
+	TransformSystem::SetRotation(_slot, TransformSystem::GetRotation(_slot) * glm::quat(glm::radians(rotation)));
 	return *this;
 }
 
 Transform& Transform::MoveLocal(const glm::vec3& localMovement)
 {
-	_position += _rotation * localMovement;
-	_isLocalDirty = true;
+	TransformSystem::SetPosition(_slot, TransformSystem::GetPosition(_slot) + TransformSystem::GetRotation(_slot) * localMovement);
 	return *this;
 }
 
@@ -97,81 +116,51 @@ Transform& Transform::MoveLocal(float x, float y, float z) {
 
 Transform& Transform::MoveLocalFixed(const glm::vec3& localMovement)
 {
-	_position += localMovement;
-	_isLocalDirty = true;
+	TransformSystem::SetPosition(_slot, TransformSystem::GetPosition(_slot) + localMovement);
 	return *this;
 }
 
 Transform& Transform::MoveLocalFixed(float x, float y, float z) {
-	_position.x += x;
-	_position.y += y;
-	_position.z += z;
-	_isLocalDirty = true;
+	MoveLocalFixed(glm::vec3(x, y, z));
 	return *this;
 }
 
 Transform& Transform::LookAt(const glm::vec3& localSpace)
 {
-	_rotation = glm::quatLookAt(-glm::normalize(_position - localSpace), glm::normalize(_rotation * glm::vec3(0, 0, 1)));
-	_rotationEulerDeg = glm::degrees(glm::eulerAngles(_rotation));
-	_isLocalDirty = true;
+	glm::vec3 position = TransformSystem::GetPosition(_slot);
+	glm::quat rotation = TransformSystem::GetRotation(_slot);
+	TransformSystem::SetRotation(_slot, glm::quatLookAt(-glm::normalize(position - localSpace), glm::normalize(rotation * glm::vec3(0, 0, 1))));
 	return *this;
 }
 
 void Transform::Recalculate() const {
-	_UpdateLocalTransformIfDirty();
+	TransformSystem::GetLocal(_slot);
 }
 
 const glm::mat4& Transform::LocalTransform() const {
-	_UpdateLocalTransformIfDirty();
-	return _localTransform;
+	return TransformSystem::GetLocal(_slot);
 }
 
 const glm::mat3& Transform::NormalMatrix() const {
-	_UpdateLocalTransformIfDirty();
-	return _normalMatrix;	
+	return TransformSystem::GetLocalNormal(_slot);
 }
 
 void Transform::SetParent(entt::handle parent)
 {
 	_parent = parent;
+	uint32_t parentSlot = TransformSystem::NULL_SLOT;
 	// If we passed in a handle, make sure it has a transform and belongs to the same scene
 	if (&parent.registry() != nullptr && parent.entity() != entt::null) {
 		LOG_ASSERT(parent.has<Transform>(), "Parent entity must have a transform component");
 		LOG_ASSERT(&parent.registry() == &_gameObject.registry(), "Parent entity must be in same registry!");
-		_hierarchyDepth = parent.get<Transform>()._hierarchyDepth + 1;
-	} else {
-		_hierarchyDepth = 0;
-	}
-	
-	// Re-calculate hierarchy depth for all children recursively
-	_gameObject.registry().view<Transform>().each([&](entt::entity entity, Transform& t) {
-		if (t._parent == _gameObject) {
-			t.SetParent(entt::handle(parent.registry(), _gameObject));
-		}
-	});
-	// Re-sort components
-	_gameObject.registry().sort<Transform>([](const Transform& l, const Transform& r) {
-		return l.GetHierarchyDepth() < r.GetHierarchyDepth();
-	});
-}
-
-void Transform::UpdateWorldMatrix() const {
-	if (_parent != entt::null) {
-		_worldTransform = _gameObject.registry().get<Transform>(_parent)._worldTransform * LocalTransform();
-		_worldNormalMatrix = glm::mat3(glm::transpose(glm::inverse(_worldTransform)));
-	} else {
-		_worldTransform = LocalTransform();
-		_worldNormalMatrix = _normalMatrix;
+		parentSlot = parent.get<Transform>()._slot;
+		LOG_ASSERT(!TransformSystem::IsInSubtree(parentSlot, _slot), "Can't parent a transform to itself or one of its children");
 	}
+	// The system keeps the child links, our children follow along without being touched.
+	// Update order gets fixed up once on the next update, instead of re-sorting the pool every call
+	TransformSystem::SetParent(_slot, parentSlot);
 }
 
-void Transform::_UpdateLocalTransformIfDirty() const {
-	if (_isLocalDirty) {
-		// TRS
-		_localTransform = glm::translate(IDENTITY, _position) * glm::toMat4(_rotation) * glm::scale(IDENTITY, _scale);
-		_normalMatrix = glm::mat3(glm::transpose(glm::inverse(_localTransform)));
-
-		_isLocalDirty = false;
-	}
+bool Transform::UpdateWorldMatrix() const {
+	return TransformSystem::UpdateWorld(_slot);
 }
@@ -0,0 +1,492 @@
+#include "TransformSystem.h"
+
+#include <algorithm>
+#include <cstring>
+#include <xmmintrin.h>
+#define GLM_ENABLE_EXPERIMENTAL
+#include <GLM/gtx/quaternion.hpp>
+
+std::vector<float> TransformSystem::_px, TransformSystem::_py, TransformSystem::_pz;
+std::vector<float> TransformSystem::_qx, TransformSystem::_qy, TransformSystem::_qz, TransformSystem::_qw;
+std::vector<float> TransformSystem::_sx, TransformSystem::_sy, TransformSystem::_sz;
+std::vector<uint8_t> TransformSystem::_localDirty;
+std::vector<uint8_t> TransformSystem::_worldDirty;
+std::vector<glm::vec3> TransformSystem::_euler;
+std::vector<uint8_t> TransformSystem::_eulerDirty;
+std::vector<glm::mat4> TransformSystem::_local;
+std::vector<glm::mat3> TransformSystem::_localNormal;
+std::vector<glm::mat4> TransformSystem::_world;
+std::vector<glm::mat3> TransformSystem::_worldNormal;
+std::vector<uint32_t> TransformSystem::_worldVersion;
+std::vector<uint32_t> TransformSystem::_parentVersion;
+std::vector<uint32_t> TransformSystem::_parent;
+std::vector<uint32_t> TransformSystem::_firstChild;
+std::vector<uint32_t> TransformSystem::_nextSibling;
+std::vector<uint32_t> TransformSystem::_prevSibling;
+std::vector<int> TransformSystem::_depth;
+std::vector<uint8_t> TransformSystem::_alive;
+std::vector<uint32_t> TransformSystem::_free;
+std::vector<uint32_t> TransformSystem::_order;
+bool TransformSystem::_orderDirty = false;
+TransformSystem::LocalState TransformSystem::_fixedPrevious;
+std::vector<uint8_t> TransformSystem::_fixedValid;
+std::vector<uint8_t> TransformSystem::_moved;
+std::vector<uint32_t> TransformSystem::_fixedMoved;
+std::vector<TransformSystem::Stash> TransformSystem::_interpolated;
+
+// Writes the first three lanes of v, for the columns of a mat3
+static inline void StoreVec3(float* dest, __m128 v) {
+	_mm_storel_pi(reinterpret_cast<__m64*>(dest), v);
+	_mm_store_ss(dest + 2, _mm_movehl_ps(v, v));
+}
+
+// a * b for column major 4x4 matrices, each column of the result is the columns of a weighted by a column of b
+static inline void MultiplyMat4(const glm::mat4& a, const glm::mat4& b, glm::mat4& result) {
+	const float* pa = &a[0][0];
+	const float* pb = &b[0][0];
+	__m128 a0 = _mm_loadu_ps(pa);
+	__m128 a1 = _mm_loadu_ps(pa + 4);
+	__m128 a2 = _mm_loadu_ps(pa + 8);
+	__m128 a3 = _mm_loadu_ps(pa + 12);
+	for (int column = 0; column < 4; column++) {
+		const float* bc = pb + column * 4;
+		__m128 r = _mm_mul_ps(a0, _mm_set1_ps(bc[0]));
+		r = _mm_add_ps(r, _mm_mul_ps(a1, _mm_set1_ps(bc[1])));
+		r = _mm_add_ps(r, _mm_mul_ps(a2, _mm_set1_ps(bc[2])));
+		r = _mm_add_ps(r, _mm_mul_ps(a3, _mm_set1_ps(bc[3])));
+		_mm_storeu_ps(&result[column][0], r);
+	}
+}
+
+uint32_t TransformSystem::Allocate() {
+	if (_free.empty()) {
+		_Grow();
+	}
+	uint32_t slot = _free.back();
+	_free.pop_back();
+	_Reset(slot);
+	_alive[slot] = 1;
+	_orderDirty = true;
+	return slot;
+}
+
+void TransformSystem::Free(uint32_t slot) {
+	_Unlink(slot);
+	// Anything still parented to us becomes a root
+	uint32_t child = _firstChild[slot];
+	while (child != NULL_SLOT) {
+		uint32_t next = _nextSibling[child];
+		_parent[child] = NULL_SLOT;
+		_nextSibling[child] = _prevSibling[child] = NULL_SLOT;
+		_worldDirty[child] = 1;
+		_UpdateDepths(child, 0);
+		child = next;
+	}
+	_firstChild[slot] = NULL_SLOT;
+
+	_Reset(slot);
+	// Reset marks it dirty, a dead slot never needs building
+	_localDirty[slot] = 0;
+	_worldDirty[slot] = 0;
+	_alive[slot] = 0;
+	_free.push_back(slot);
+	_orderDirty = true;
+}
+
+void TransformSystem::CopyLocal(uint32_t destination, uint32_t source) {
+	_px[destination] = _px[source]; _py[destination] = _py[source]; _pz[destination] = _pz[source];
+	_qx[destination] = _qx[source]; _qy[destination] = _qy[source]; _qz[destination] = _qz[source]; _qw[destination] = _qw[source];
+	_sx[destination] = _sx[source]; _sy[destination] = _sy[source]; _sz[destination] = _sz[source];
+	_euler[destination] = _euler[source];
+	_eulerDirty[destination] = _eulerDirty[source];
+	_MarkDirty(destination);
+}
+
+const glm::vec3& TransformSystem::GetEulerDegrees(uint32_t slot) {
+	if (_eulerDirty[slot]) {
+		_euler[slot] = glm::degrees(glm::eulerAngles(GetRotation(slot)));
+		_eulerDirty[slot] = 0;
+	}
+	return _euler[slot];
+}
+
+void TransformSystem::SetPosition(uint32_t slot, const glm::vec3& position) {
+	_px[slot] = position.x; _py[slot] = position.y; _pz[slot] = position.z;
+	_MarkDirty(slot);
+}
+
+void TransformSystem::SetRotation(uint32_t slot, const glm::quat& rotation) {
+	_qx[slot] = rotation.x; _qy[slot] = rotation.y; _qz[slot] = rotation.z; _qw[slot] = rotation.w;
+	_eulerDirty[slot] = 1;
+	_MarkDirty(slot);
+}
+
+void TransformSystem::SetRotation(uint32_t slot, const glm::vec3& eulerDegrees) {
+	glm::quat rotation = glm::quat(glm::radians(eulerDegrees));
+	_qx[slot] = rotation.x; _qy[slot] = rotation.y; _qz[slot] = rotation.z; _qw[slot] = rotation.w;
+	_euler[slot] = eulerDegrees;
+	_eulerDirty[slot] = 0;
+	_MarkDirty(slot);
+}
+
+void TransformSystem::SetScale(uint32_t slot, const glm::vec3& scale) {
+	_sx[slot] = scale.x; _sy[slot] = scale.y; _sz[slot] = scale.z;
+	_MarkDirty(slot);
+}
+
+void TransformSystem::SetParent(uint32_t slot, uint32_t parent) {
+	// Whatever we were relative to before doesn't apply anymore
+	_worldDirty[slot] = 1;
+	if (_parent[slot] == parent) {
+		return;
+	}
+
+	_Unlink(slot);
+	if (parent != NULL_SLOT) {
+		// Push onto the front of the parent's children
+		_parent[slot] = parent;
+		_nextSibling[slot] = _firstChild[parent];
+		if (_firstChild[parent] != NULL_SLOT) {
+			_prevSibling[_firstChild[parent]] = slot;
+		}
+		_firstChild[parent] = slot;
+	}
+
+	int depth = parent != NULL_SLOT ? _depth[parent] + 1 : 0;
+	if (_depth[slot] != depth) {
+		_UpdateDepths(slot, depth);
+	}
+	_orderDirty = true;
+}
+
+bool TransformSystem::IsInSubtree(uint32_t slot, uint32_t root) {
+	for (; slot != NULL_SLOT; slot = _parent[slot]) {
+		if (slot == root) {
+			return true;
+		}
+	}
+	return false;
+}
+
+const glm::mat4& TransformSystem::GetLocal(uint32_t slot) {
+	if (_localDirty[slot]) {
+		_ComposeLocal(slot);
+	}
+	return _local[slot];
+}
+
+const glm::mat3& TransformSystem::GetLocalNormal(uint32_t slot) {
+	if (_localDirty[slot]) {
+		_ComposeLocal(slot);
+	}
+	return _localNormal[slot];
+}
+
+bool TransformSystem::UpdateWorld(uint32_t slot) {
+	uint32_t parent = _parent[slot];
+	if (parent == NULL_SLOT) {
+		if (!_worldDirty[slot]) {
+			return false;
+		}
+		_world[slot] = GetLocal(slot);
+		_worldNormal[slot] = GetLocalNormal(slot);
+	} else {
+		if (!_worldDirty[slot] && _parentVersion[slot] == _worldVersion[parent]) {
+			return false;
+		}
+		MultiplyMat4(_world[parent], GetLocal(slot), _world[slot]);
+		// (AB)^-T = A^-T * B^-T, so normal matrices chain down the hierarchy the same way transforms do
+		_worldNormal[slot] = _worldNormal[parent] * GetLocalNormal(slot);
+		_parentVersion[slot] = _worldVersion[parent];
+	}
+	_worldDirty[slot] = 0;
+	_worldVersion[slot]++;
+	return true;
+}
+
+unsigned TransformSystem::Update() {
+	_ComposeLocals();
+	if (_orderDirty) {
+		_RebuildOrder();
+	}
+
+	unsigned updated = 0;
+	for (uint32_t slot : _order) {
+		if (UpdateWorld(slot)) {
+			updated++;
+		}
+	}
+	return updated;
+}
+
+void TransformSystem::BeginFixedStep() {
+	_fixedPrevious.Px = _px; _fixedPrevious.Py = _py; _fixedPrevious.Pz = _pz;
+	_fixedPrevious.Qx = _qx; _fixedPrevious.Qy = _qy; _fixedPrevious.Qz = _qz; _fixedPrevious.Qw = _qw;
+	_fixedPrevious.Sx = _sx; _fixedPrevious.Sy = _sy; _fixedPrevious.Sz = _sz;
+	_fixedValid = _alive;
+	std::fill(_moved.begin(), _moved.end(), uint8_t(0));
+}
+
+void TransformSystem::EndFixedStep() {
+	_fixedMoved.clear();
+	for (uint32_t slot = 0; slot < (uint32_t)_moved.size(); slot++) {
+		// Slots made during the step have nothing to blend from
+		if (_moved[slot] && _fixedValid[slot]) {
+			_fixedMoved.push_back(slot);
+		}
+	}
+}
+
+void TransformSystem::Interpolate(float alpha) {
+	_interpolated.clear();
+	for (uint32_t slot : _fixedMoved) {
+		// Freed (and maybe reused) since the step
+		if (!_fixedValid[slot]) {
+			continue;
+		}
+		Stash stash;
+		stash.Slot = slot;
+		stash.Position = GetPosition(slot);
+		stash.Rotation = GetRotation(slot);
+		stash.Scale = GetScale(slot);
+		stash.Euler = _euler[slot];
+		stash.EulerDirty = _eulerDirty[slot];
+		_interpolated.push_back(stash);
+
+		glm::vec3 position = glm::mix(glm::vec3(_fixedPrevious.Px[slot], _fixedPrevious.Py[slot], _fixedPrevious.Pz[slot]), stash.Position, alpha);
+		glm::quat rotation = glm::slerp(glm::quat(_fixedPrevious.Qw[slot], _fixedPrevious.Qx[slot], _fixedPrevious.Qy[slot], _fixedPrevious.Qz[slot]), stash.Rotation, alpha);
+		glm::vec3 scale = glm::mix(glm::vec3(_fixedPrevious.Sx[slot], _fixedPrevious.Sy[slot], _fixedPrevious.Sz[slot]), stash.Scale, alpha);
+		// Written straight in, the setters would count this as the slot being moved
+		_px[slot] = position.x; _py[slot] = position.y; _pz[slot] = position.z;
+		_qx[slot] = rotation.x; _qy[slot] = rotation.y; _qz[slot] = rotation.z; _qw[slot] = rotation.w;
+		_sx[slot] = scale.x; _sy[slot] = scale.y; _sz[slot] = scale.z;
+		_localDirty[slot] = 1;
+		_worldDirty[slot] = 1;
+		_moved[slot] = 0;
+	}
+}
+
+void TransformSystem::EndInterpolation() {
+	for (const Stash& stash : _interpolated) {
+		uint32_t slot = stash.Slot;
+		// Something set it on purpose since, or it was freed
+		if (_moved[slot] || !_fixedValid[slot]) {
+			continue;
+		}
+		_px[slot] = stash.Position.x; _py[slot] = stash.Position.y; _pz[slot] = stash.Position.z;
+		_qx[slot] = stash.Rotation.x; _qy[slot] = stash.Rotation.y; _qz[slot] = stash.Rotation.z; _qw[slot] = stash.Rotation.w;
+		_sx[slot] = stash.Scale.x; _sy[slot] = stash.Scale.y; _sz[slot] = stash.Scale.z;
+		// Someone may have asked for the angles of the blended rotation
+		_euler[slot] = stash.Euler;
+		_eulerDirty[slot] = stash.EulerDirty;
+		_localDirty[slot] = 1;
+		_worldDirty[slot] = 1;
+	}
+	_interpolated.clear();
+}
+
+void TransformSystem::_Grow() {
+	size_t first = _alive.size();
+	size_t capacity = std::max<size_t>(64, first * 2);
+
+	_px.resize(capacity, 0.0f); _py.resize(capacity, 0.0f); _pz.resize(capacity, 0.0f);
+	// Unused slots still get built when they share a group with a dirty one, so they need a sane rotation and scale
+	_qx.resize(capacity, 0.0f); _qy.resize(capacity, 0.0f); _qz.resize(capacity, 0.0f); _qw.resize(capacity, 1.0f);
+	_sx.resize(capacity, 1.0f); _sy.resize(capacity, 1.0f); _sz.resize(capacity, 1.0f);
+	_localDirty.resize(capacity, 0);
+	_worldDirty.resize(capacity, 0);
+	_euler.resize(capacity, glm::vec3(0.0f));
+	_eulerDirty.resize(capacity, 0);
+	_local.resize(capacity, glm::mat4(1.0f));
+	_localNormal.resize(capacity, glm::mat3(1.0f));
+	_world.resize(capacity, glm::mat4(1.0f));
+	_worldNormal.resize(capacity, glm::mat3(1.0f));
+	_worldVersion.resize(capacity, 0);
+	_parentVersion.resize(capacity, 0);
+	_parent.resize(capacity, NULL_SLOT);
+	_firstChild.resize(capacity, NULL_SLOT);
+	_nextSibling.resize(capacity, NULL_SLOT);
+	_prevSibling.resize(capacity, NULL_SLOT);
+	_depth.resize(capacity, 0);
+	_alive.resize(capacity, 0);
+	_fixedValid.resize(capacity, 0);
+	_moved.resize(capacity, 0);
+
+	// Backwards, so the lowest slots get handed out first
+	for (size_t slot = capacity; slot > first; slot--) {
+		_free.push_back(uint32_t(slot - 1));
+	}
+}
+
+void TransformSystem::_Reset(uint32_t slot) {
+	_px[slot] = _py[slot] = _pz[slot] = 0.0f;
+	_qx[slot] = _qy[slot] = _qz[slot] = 0.0f;
+	_qw[slot] = 1.0f;
+	_sx[slot] = _sy[slot] = _sz[slot] = 1.0f;
+	_euler[slot] = glm::vec3(0.0f);
+	_eulerDirty[slot] = 0;
+	_parent[slot] = NULL_SLOT;
+	_firstChild[slot] = NULL_SLOT;
+	_nextSibling[slot] = NULL_SLOT;
+	_prevSibling[slot] = NULL_SLOT;
+	_depth[slot] = 0;
+	_parentVersion[slot] = 0;
+	_fixedValid[slot] = 0;
+	_MarkDirty(slot);
+}
+
+void TransformSystem::_Unlink(uint32_t slot) {
+	uint32_t parent = _parent[slot];
+	if (parent == NULL_SLOT) {
+		return;
+	}
+	if (_prevSibling[slot] != NULL_SLOT) {
+		_nextSibling[_prevSibling[slot]] = _nextSibling[slot];
+	} else {
+		_firstChild[parent] = _nextSibling[slot];
+	}
+	if (_nextSibling[slot] != NULL_SLOT) {
+		_prevSibling[_nextSibling[slot]] = _prevSibling[slot];
+	}
+	_parent[slot] = NULL_SLOT;
+	_nextSibling[slot] = NULL_SLOT;
+	_prevSibling[slot] = NULL_SLOT;
+}
+
+uint32_t TransformSystem::_NextInSubtree(uint32_t slot, uint32_t root) {
+	if (_firstChild[slot] != NULL_SLOT) {
+		return _firstChild[slot];
+	}
+	// Out of children, back up until there's a sibling we haven't been to
+	for (; slot != root; slot = _parent[slot]) {
+		if (_nextSibling[slot] != NULL_SLOT) {
+			return _nextSibling[slot];
+		}
+	}
+	return NULL_SLOT;
+}
+
+void TransformSystem::_UpdateDepths(uint32_t root, int depth) {
+	_depth[root] = depth;
+	// Depth first, so every parent is done before its children
+	for (uint32_t slot = _NextInSubtree(root, root); slot != NULL_SLOT; slot = _NextInSubtree(slot, root)) {
+		_depth[slot] = _depth[_parent[slot]] + 1;
+	}
+}
+
+void TransformSystem::_ComposeLocal(uint32_t slot) {
+	float x = _qx[slot], y = _qy[slot], z = _qz[slot], w = _qw[slot];
+	float xx = x * x, yy = y * y, zz = z * z;
+	float xy = x * y, xz = x * z, yz = y * z;
+	float wx = w * x, wy = w * y, wz = w * z;
+
+	// Rotation matrix, [column][row] like glm
+	glm::mat3 rotation;
+	rotation[0] = glm::vec3(1.0f - 2.0f * (yy + zz), 2.0f * (xy + wz), 2.0f * (xz - wy));
+	rotation[1] = glm::vec3(2.0f * (xy - wz), 1.0f - 2.0f * (xx + zz), 2.0f * (yz + wx));
+	rotation[2] = glm::vec3(2.0f * (xz + wy), 2.0f * (yz - wx), 1.0f - 2.0f * (xx + yy));
+
+	// TRS, the rotation's columns scaled and the position tacked on the end
+	glm::mat4& local = _local[slot];
+	local[0] = glm::vec4(rotation[0] * _sx[slot], 0.0f);
+	local[1] = glm::vec4(rotation[1] * _sy[slot], 0.0f);
+	local[2] = glm::vec4(rotation[2] * _sz[slot], 0.0f);
+	local[3] = glm::vec4(_px[slot], _py[slot], _pz[slot], 1.0f);
+
+	// The inverse transpose of R * S is R * S^-1, no need for a general inverse
+	glm::mat3& normal = _localNormal[slot];
+	normal[0] = rotation[0] * (1.0f / _sx[slot]);
+	normal[1] = rotation[1] * (1.0f / _sy[slot]);
+	normal[2] = rotation[2] * (1.0f / _sz[slot]);
+
+	_localDirty[slot] = 0;
+}
+
+void TransformSystem::_ComposeLocals() {
+	const __m128 one = _mm_set1_ps(1.0f);
+	const __m128 two = _mm_set1_ps(2.0f);
+	const __m128 zero = _mm_setzero_ps();
+
+	for (size_t base = 0; base < _alive.size(); base += GROUP_SIZE) {
+		// All four dirty flags at once
+		uint32_t dirty;
+		memcpy(&dirty, &_localDirty[base], sizeof(dirty));
+		if (dirty == 0) {
+			continue;
+		}
+
+		// Each register holds the same component for four transforms
+		__m128 x = _mm_loadu_ps(&_qx[base]);
+		__m128 y = _mm_loadu_ps(&_qy[base]);
+		__m128 z = _mm_loadu_ps(&_qz[base]);
+		__m128 w = _mm_loadu_ps(&_qw[base]);
+		__m128 xx = _mm_mul_ps(x, x), yy = _mm_mul_ps(y, y), zz = _mm_mul_ps(z, z);
+		__m128 xy = _mm_mul_ps(x, y), xz = _mm_mul_ps(x, z), yz = _mm_mul_ps(y, z);
+		__m128 wx = _mm_mul_ps(w, x), wy = _mm_mul_ps(w, y), wz = _mm_mul_ps(w, z);
+
+		// Rotation matrix, r[column][row]
+		__m128 r[3][3];
+		r[0][0] = _mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(yy, zz)));
+		r[0][1] = _mm_mul_ps(two, _mm_add_ps(xy, wz));
+		r[0][2] = _mm_mul_ps(two, _mm_sub_ps(xz, wy));
+		r[1][0] = _mm_mul_ps(two, _mm_sub_ps(xy, wz));
+		r[1][1] = _mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(xx, zz)));
+		r[1][2] = _mm_mul_ps(two, _mm_add_ps(yz, wx));
+		r[2][0] = _mm_mul_ps(two, _mm_add_ps(xz, wy));
+		r[2][1] = _mm_mul_ps(two, _mm_sub_ps(yz, wx));
+		r[2][2] = _mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(xx, yy)));
+
+		__m128 scale[3] = { _mm_loadu_ps(&_sx[base]), _mm_loadu_ps(&_sy[base]), _mm_loadu_ps(&_sz[base]) };
+
+		for (int column = 0; column < 3; column++) {
+			// Transposing turns one row per register into one transform's column per register
+			__m128 c0 = _mm_mul_ps(r[column][0], scale[column]);
+			__m128 c1 = _mm_mul_ps(r[column][1], scale[column]);
+			__m128 c2 = _mm_mul_ps(r[column][2], scale[column]);
+			__m128 c3 = zero;
+			_MM_TRANSPOSE4_PS(c0, c1, c2, c3);
+			_mm_storeu_ps(&_local[base + 0][column][0], c0);
+			_mm_storeu_ps(&_local[base + 1][column][0], c1);
+			_mm_storeu_ps(&_local[base + 2][column][0], c2);
+			_mm_storeu_ps(&_local[base + 3][column][0], c3);
+
+			// Same as the scalar path, R * S^-1
+			__m128 inverse = _mm_div_ps(one, scale[column]);
+			__m128 n0 = _mm_mul_ps(r[column][0], inverse);
+			__m128 n1 = _mm_mul_ps(r[column][1], inverse);
+			__m128 n2 = _mm_mul_ps(r[column][2], inverse);
+			__m128 n3 = zero;
+			_MM_TRANSPOSE4_PS(n0, n1, n2, n3);
+			StoreVec3(&_localNormal[base + 0][column][0], n0);
+			StoreVec3(&_localNormal[base + 1][column][0], n1);
+			StoreVec3(&_localNormal[base + 2][column][0], n2);
+			StoreVec3(&_localNormal[base + 3][column][0], n3);
+		}
+
+		__m128 t0 = _mm_loadu_ps(&_px[base]);
+		__m128 t1 = _mm_loadu_ps(&_py[base]);
+		__m128 t2 = _mm_loadu_ps(&_pz[base]);
+		__m128 t3 = one;
+		_MM_TRANSPOSE4_PS(t0, t1, t2, t3);
+		_mm_storeu_ps(&_local[base + 0][3][0], t0);
+		_mm_storeu_ps(&_local[base + 1][3][0], t1);
+		_mm_storeu_ps(&_local[base + 2][3][0], t2);
+		_mm_storeu_ps(&_local[base + 3][3][0], t3);
+
+		memset(&_localDirty[base], 0, GROUP_SIZE);
+	}
+}
+
+void TransformSystem::_RebuildOrder() {
+	// Linear in the number of transforms, no matter how many were reparented since last time
+	_order.clear();
+	for (uint32_t root = 0; root < (uint32_t)_alive.size(); root++) {
+		if (!_alive[root] || _parent[root] != NULL_SLOT) {
+			continue;
+		}
+		for (uint32_t slot = root; slot != NULL_SLOT; slot = _NextInSubtree(slot, root)) {
+			_order.push_back(slot);
+		}
+	}
+	_orderDirty = false;
+}
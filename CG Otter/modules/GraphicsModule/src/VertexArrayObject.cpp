@@ -1,12 +1,21 @@
 #include "VertexArrayObject.h"
 #include "IndexBuffer.h"
 #include "Logging.h"
+#include "GLState.h"
 #include "VertexBuffer.h"
 
 VertexArrayObject::VertexArrayObject() :
 	_indexBuffer(nullptr),
 	_handle(0),
-	_vertexCount(0)
+	_vertexCount(0),
+	_firstIndex(0),
+	_indexCount(0),
+	_baseVertex(0),
+	_arenaVao(nullptr),
+	_hasBounds(false),
+	_boundsMin(glm::vec3(0.0f)),
+	_boundsMax(glm::vec3(0.0f)),
+	_boundingRadius(0.0f)
 {
 	glCreateVertexArrays(1, &_handle);
 }
@@ -14,6 +23,7 @@ VertexArrayObject::VertexArrayObject() :
 VertexArrayObject::~VertexArrayObject()
 {
 	if (_handle != 0) {
+		GLState::OnVertexArrayDeleted(_handle);
 		glDeleteVertexArrays(1, &_handle);
 		_handle = 0;
 	}
@@ -53,20 +63,76 @@ void VertexArrayObject::AddVertexBuffer(const VertexBuffer::sptr& buffer, const
 
 }
 
+void VertexArrayObject::AddInstanceBuffer(const VertexBuffer::sptr& buffer, const std::vector<BufferAttribute>& attributes)
+{
+	// Instance buffers are sized by the number of instances, not vertices, so we don't check the element count here
+	VertexBufferBinding binding;
+	binding.Buffer = buffer;
+	binding.Attributes = attributes;
+	_instanceBuffers.push_back(binding);
+
+	Bind();
+	buffer->Bind();
+	for (const BufferAttribute& attrib : attributes) {
+		glEnableVertexArrayAttrib(_handle, attrib.Slot);
+		glVertexAttribPointer(attrib.Slot, attrib.Size, attrib.Type, attrib.Normalized, attrib.Stride, (void*)attrib.Offset);
+		glVertexAttribDivisor(attrib.Slot, 1);
+	}
+	UnBind();
+}
+
+void VertexArrayObject::SetArenaRange(GLuint firstIndex, GLsizei indexCount, GLint baseVertex, const sptr& arenaVao)
+{
+	_firstIndex = firstIndex;
+	_indexCount = indexCount;
+	_baseVertex = baseVertex;
+	_arenaVao = arenaVao;
+}
+
+void VertexArrayObject::SetBounds(const glm::vec3& min, const glm::vec3& max, float radius)
+{
+	_hasBounds = true;
+	_boundsMin = min;
+	_boundsMax = max;
+	_boundingRadius = radius;
+}
+
+GLsizei VertexArrayObject::GetIndexCount() const {
+	if (_arenaVao != nullptr) {
+		return _indexCount;
+	}
+	return _indexBuffer != nullptr ? _indexBuffer->GetElementCount() : 0;
+}
+
 void VertexArrayObject::Bind() const {
-	glBindVertexArray(_handle);
+	GLState::BindVertexArray(_handle);
 }
 
 void VertexArrayObject::UnBind() {
-	glBindVertexArray(0);
+	GLState::BindVertexArray(0);
 }
 
 void VertexArrayObject::Render() const {
 	Bind();
-	if (_indexBuffer != nullptr) {
+	if (_arenaVao != nullptr) {
+		// Arena indices are always 32 bit
+		glDrawElementsBaseVertex(GL_TRIANGLES, _indexCount, GL_UNSIGNED_INT, (void*)(_firstIndex * sizeof(uint32_t)), _baseVertex);
+	} else if (_indexBuffer != nullptr) {
 		glDrawElements(GL_TRIANGLES, _indexBuffer->GetElementCount(), _indexBuffer->GetElementType(), nullptr);
 	} else {
 		glDrawArrays(GL_TRIANGLES, 0, _vertexCount / 3);
 	}
-	UnBind();
+	// No unbind, the next draw usually uses the same VAO and GLState will skip the bind
+}
+
+void VertexArrayObject::RenderInstanced(GLsizei instanceCount, GLuint baseInstance) const {
+	Bind();
+	if (_arenaVao != nullptr) {
+		glDrawElementsInstancedBaseVertexBaseInstance(GL_TRIANGLES, _indexCount, GL_UNSIGNED_INT, (void*)(_firstIndex * sizeof(uint32_t)),
+			instanceCount, _baseVertex, baseInstance);
+	} else if (_indexBuffer != nullptr) {
+		glDrawElementsInstancedBaseInstance(GL_TRIANGLES, _indexBuffer->GetElementCount(), _indexBuffer->GetElementType(), nullptr, instanceCount, baseInstance);
+	} else {
+		glDrawArraysInstancedBaseInstance(GL_TRIANGLES, 0, _vertexCount / 3, instanceCount, baseInstance);
+	}
 }
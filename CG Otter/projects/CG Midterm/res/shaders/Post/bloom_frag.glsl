@@ -6,11 +6,11 @@ uniform float u_threshold;
 
 out vec4 fragColor;
 
-in vec2 TexCoords;
+layout(location = 0) in vec2 inUV;
 
 void main()
 {
-	vec4 color = texture(uTex, TexCoords);
+	vec4 color = texture(uTex, inUV);
 
 	float bright = (color.r + color.g + color.b) / 3.0;
 	
@@ -0,0 +1,58 @@
+#version 420
+
+layout(location = 0) in vec2 inUV;
+
+out vec4 frag_color;
+
+layout (binding = 0) uniform sampler2D s_depth;
+layout (binding = 1) uniform sampler2D s_ao;
+
+//Fraction of the textures that holds the image
+uniform vec2 u_UVScale = vec2(1.0);
+uniform mat4 u_InvProjection;
+
+//One AO texel along the blur axis
+uniform vec2 u_Direction;
+
+//How quickly samples lose weight as depth gets further from the centre (relative to distance)
+const float DEPTH_SHARPNESS = 16.0;
+
+float LinearDepth(vec2 uv)
+{
+	float depth = texture(s_depth, uv).r;
+	vec4 pos = u_InvProjection * vec4(vec3(uv / u_UVScale, depth) * 2.0 - 1.0, 1.0);
+	return -pos.z / pos.w;
+}
+
+void main() 
+{
+	vec2 texel = 1.0 / vec2(textureSize(s_ao, 0));
+	vec2 minUV = texel * 0.5;
+	vec2 maxUV = u_UVScale - texel * 0.5;
+
+	//Gaussian weights for offsets 0 to 3
+	const float weights[4] = float[](0.2, 0.17, 0.12, 0.07);
+
+	float centreDepth = LinearDepth(inUV);
+
+	float total = texture(s_ao, inUV).r * weights[0];
+	float totalWeight = weights[0];
+
+	for (int i = 1; i < 4; i++)
+	{
+		for (int side = -1; side <= 1; side += 2)
+		{
+			vec2 uv = clamp(inUV + u_Direction * float(i * side), minUV, maxUV);
+
+			//Anything on a different surface barely counts
+			float depthDifference = abs(LinearDepth(uv) - centreDepth) / max(centreDepth, 0.0001);
+			float weight = weights[i] * exp(-depthDifference * DEPTH_SHARPNESS);
+
+			total += texture(s_ao, uv).r * weight;
+			totalWeight += weight;
+		}
+	}
+
+	float ao = total / totalWeight;
+	frag_color = vec4(ao, ao, ao, 1.0);
+}
@@ -0,0 +1,85 @@
+#version 420
+
+layout(location = 0) in vec2 inUV;
+
+out vec4 frag_color;
+
+layout (binding = 0) uniform sampler2D s_depth;
+//Random rotations, tiles every 4 pixels
+layout (binding = 1) uniform sampler2D s_noise;
+
+//Fraction of the textures that holds the image
+uniform vec2 u_UVScale = vec2(1.0);
+
+uniform mat4 u_Projection;
+uniform mat4 u_InvProjection;
+
+//Hemisphere of offsets around +z
+const int KERNEL_SIZE = 16;
+uniform vec3 u_Kernel[KERNEL_SIZE];
+
+//View space radius of the hemisphere
+uniform float u_Radius = 0.5;
+//Stops flat surfaces from occluding themselves
+uniform float u_Bias = 0.025;
+//Contrast of the final AO
+uniform float u_Power = 1.5;
+
+//Rebuilds the view space position from the depth buffer
+vec3 ViewPos(vec2 uv)
+{
+	float depth = texture(s_depth, uv).r;
+	vec4 pos = u_InvProjection * vec4(vec3(uv / u_UVScale, depth) * 2.0 - 1.0, 1.0);
+	return pos.xyz / pos.w;
+}
+
+void main() 
+{
+	vec2 texel = 1.0 / vec2(textureSize(s_depth, 0));
+	vec2 minUV = texel * 0.5;
+	vec2 maxUV = u_UVScale - texel * 0.5;
+
+	//Nothing to occlude the sky
+	if (texture(s_depth, inUV).r >= 1.0)
+	{
+		frag_color = vec4(1.0);
+		return;
+	}
+
+	vec3 position = ViewPos(inUV);
+
+	//Normal from the depth, taking the neighbour on the same surface on each side so edges stay sharp
+	vec3 right = ViewPos(inUV + vec2(texel.x, 0.0)) - position;
+	vec3 left = position - ViewPos(inUV - vec2(texel.x, 0.0));
+	vec3 up = ViewPos(inUV + vec2(0.0, texel.y)) - position;
+	vec3 down = position - ViewPos(inUV - vec2(0.0, texel.y));
+
+	vec3 dx = abs(right.z) < abs(left.z) ? right : left;
+	vec3 dy = abs(up.z) < abs(down.z) ? up : down;
+	vec3 normal = normalize(cross(dx, dy));
+
+	//Spin the kernel around the normal per pixel, the blur cleans up the pattern after
+	vec3 random = vec3(texture(s_noise, gl_FragCoord.xy / vec2(textureSize(s_noise, 0))).xy, 0.0);
+	vec3 tangent = normalize(random - normal * dot(random, normal));
+	vec3 bitangent = cross(normal, tangent);
+	mat3 TBN = mat3(tangent, bitangent, normal);
+
+	float occlusion = 0.0;
+	for (int i = 0; i < KERNEL_SIZE; i++)
+	{
+		vec3 samplePos = position + TBN * u_Kernel[i] * u_Radius;
+
+		//Project the sample onto the screen to find what's actually there
+		vec4 offset = u_Projection * vec4(samplePos, 1.0);
+		vec2 sampleUV = clamp((offset.xy / offset.w * 0.5 + 0.5) * u_UVScale, minUV, maxUV);
+
+		float sceneDepth = ViewPos(sampleUV).z;
+
+		//Fade out occluders that are way in front, they're not actually near this point
+		float range = smoothstep(0.0, 1.0, u_Radius / abs(position.z - sceneDepth));
+		occlusion += (sceneDepth >= samplePos.z + u_Bias ? 1.0 : 0.0) * range;
+	}
+
+	float ao = pow(1.0 - occlusion / KERNEL_SIZE, u_Power);
+	frag_color = vec4(ao, ao, ao, 1.0);
+}
@@ -0,0 +1,56 @@
+#version 420
+
+layout(location = 0) in vec2 inUV;
+
+out vec4 frag_color;
+
+layout (binding = 0) uniform sampler2D s_depth;
+//Half res AO
+layout (binding = 1) uniform sampler2D s_ao;
+
+//Fraction of the textures that holds the image
+uniform vec2 u_UVScale = vec2(1.0);
+uniform mat4 u_InvProjection;
+
+float LinearDepth(vec2 uv)
+{
+	float depth = texture(s_depth, uv).r;
+	vec4 pos = u_InvProjection * vec4(vec3(uv / u_UVScale, depth) * 2.0 - 1.0, 1.0);
+	return -pos.z / pos.w;
+}
+
+void main() 
+{
+	vec2 aoSize = vec2(textureSize(s_ao, 0));
+	//Last AO texel inside the render region
+	ivec2 maxCoord = max(ivec2(ceil(aoSize * u_UVScale)) - 1, ivec2(0));
+
+	//The 2x2 half res texels around this pixel and how far we are between them
+	vec2 coord = inUV * aoSize - 0.5;
+	ivec2 base = ivec2(floor(coord));
+	vec2 f = fract(coord);
+
+	float centreDepth = LinearDepth(inUV);
+
+	float total = 0.0;
+	float totalWeight = 0.0;
+
+	for (int y = 0; y <= 1; y++)
+	{
+		for (int x = 0; x <= 1; x++)
+		{
+			ivec2 texelCoord = clamp(base + ivec2(x, y), ivec2(0), maxCoord);
+
+			//Bilinear weight, cut down by how far this texel's depth is from ours
+			float bilinear = (x == 0 ? 1.0 - f.x : f.x) * (y == 0 ? 1.0 - f.y : f.y);
+			float sampleDepth = LinearDepth((vec2(texelCoord) + 0.5) / aoSize);
+			float weight = bilinear / (0.0001 + abs(sampleDepth - centreDepth) / max(centreDepth, 0.0001));
+
+			total += texelFetch(s_ao, texelCoord, 0).r * weight;
+			totalWeight += weight;
+		}
+	}
+
+	float ao = totalWeight > 0.0 ? total / totalWeight : texelFetch(s_ao, clamp(base, ivec2(0), maxCoord), 0).r;
+	frag_color = vec4(ao, ao, ao, 1.0);
+}
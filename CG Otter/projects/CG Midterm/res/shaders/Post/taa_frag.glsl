@@ -0,0 +1,125 @@
+#version 420
+
+layout(location = 0) in vec2 inUV;
+
+out vec4 frag_color;
+
+//This frame (jittered)
+layout (binding = 0) uniform sampler2D s_screenTex;
+//Last frame's resolved output
+layout (binding = 1) uniform sampler2D s_history;
+//Scene motion vectors and depth
+layout (binding = 2) uniform sampler2D s_velocity;
+layout (binding = 3) uniform sampler2D s_depth;
+
+//Fraction of the textures that holds the image
+uniform vec2 u_UVScale = vec2(1.0);
+//How much of the history we keep each frame
+uniform float u_Feedback = 0.9;
+//Set when the history is garbage (first frame, resize, resolution change)
+uniform int u_ResetHistory = 0;
+
+//Clamping works better in YCoCg, the box hugs the colours tighter than in RGB
+vec3 RGBToYCoCg(vec3 rgb)
+{
+	return vec3(
+		 0.25 * rgb.r + 0.5 * rgb.g + 0.25 * rgb.b,
+		 0.5  * rgb.r                - 0.5  * rgb.b,
+		-0.25 * rgb.r + 0.5 * rgb.g - 0.25 * rgb.b);
+}
+
+vec3 YCoCgToRGB(vec3 ycocg)
+{
+	return vec3(
+		ycocg.x + ycocg.y - ycocg.z,
+		ycocg.x           + ycocg.z,
+		ycocg.x - ycocg.y - ycocg.z);
+}
+
+//Pulls the history towards the centre of the box until it's inside, instead of clamping each channel
+vec3 ClipToBox(vec3 history, vec3 boxMin, vec3 boxMax)
+{
+	vec3 centre = 0.5 * (boxMax + boxMin);
+	vec3 extents = 0.5 * (boxMax - boxMin) + 0.0001;
+
+	vec3 offset = history - centre;
+	vec3 units = abs(offset / extents);
+	float largest = max(units.x, max(units.y, units.z));
+
+	return largest > 1.0 ? centre + offset / largest : history;
+}
+
+void main() 
+{
+	vec2 texel = 1.0 / vec2(textureSize(s_screenTex, 0));
+	vec2 maxUV = u_UVScale - texel * 0.5;
+
+	vec4 source = texture(s_screenTex, inUV);
+
+	if (u_ResetHistory == 1)
+	{
+		frag_color = source;
+		return;
+	}
+
+	//Look over the 3x3 neighbourhood for the colour box and the closest surface
+	vec3 moment1 = vec3(0.0);
+	vec3 moment2 = vec3(0.0);
+	vec3 boxMin = vec3(1.0e5);
+	vec3 boxMax = vec3(-1.0e5);
+	float closestDepth = 1.0;
+	vec2 closestUV = inUV;
+
+	for (int y = -1; y <= 1; y++)
+	{
+		for (int x = -1; x <= 1; x++)
+		{
+			vec2 uv = clamp(inUV + vec2(x, y) * texel, texel * 0.5, maxUV);
+
+			vec3 colour = RGBToYCoCg(texture(s_screenTex, uv).rgb);
+			moment1 += colour;
+			moment2 += colour * colour;
+			boxMin = min(boxMin, colour);
+			boxMax = max(boxMax, colour);
+
+			//Using the closest velocity keeps edges of moving objects from smearing
+			float depth = texture(s_depth, uv).r;
+			if (depth < closestDepth)
+			{
+				closestDepth = depth;
+				closestUV = uv;
+			}
+		}
+	}
+
+	//Velocity is in screen UVs, our textures only use the render region
+	vec2 velocity = texture(s_velocity, closestUV).rg * u_UVScale;
+	vec2 historyUV = inUV - velocity;
+
+	//Off screen last frame, nothing to blend with
+	if (any(lessThan(historyUV, vec2(0.0))) || any(greaterThan(historyUV, u_UVScale)))
+	{
+		frag_color = source;
+		return;
+	}
+
+	//Tighten the box to mean +- standard deviation (variance clipping), still inside the min/max
+	vec3 mean = moment1 / 9.0;
+	vec3 deviation = sqrt(max(moment2 / 9.0 - mean * mean, vec3(0.0)));
+	boxMin = max(boxMin, mean - deviation * 1.25);
+	boxMax = min(boxMax, mean + deviation * 1.25);
+
+	vec3 history = RGBToYCoCg(texture(s_history, clamp(historyUV, texel * 0.5, maxUV)).rgb);
+	history = YCoCgToRGB(ClipToBox(history, boxMin, boxMax));
+
+	//Trust the history less the faster things move, resampling it blurs
+	float motion = length(velocity / texel);
+	float feedback = mix(u_Feedback, u_Feedback - 0.15, clamp(motion / 8.0, 0.0, 1.0));
+
+	//Weigh by inverse luminance so bright flickering pixels don't dominate
+	float currentWeight = (1.0 - feedback) / (1.0 + dot(source.rgb, vec3(0.299, 0.587, 0.114)));
+	float historyWeight = feedback / (1.0 + dot(history, vec3(0.299, 0.587, 0.114)));
+
+	frag_color.rgb = (source.rgb * currentWeight + history * historyWeight) / (currentWeight + historyWeight);
+	frag_color.a = source.a;
+}
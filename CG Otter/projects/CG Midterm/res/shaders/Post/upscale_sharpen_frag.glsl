@@ -0,0 +1,40 @@
+#version 420
+
+layout(location = 0) in vec2 inUV;
+
+out vec4 frag_color;
+
+layout (binding = 0) uniform sampler2D s_screenTex;
+
+//Fraction of the source texture that holds the image
+uniform vec2 u_UVScale = vec2(1.0);
+//How hard to sharpen, 0 is just a bilinear upscale
+uniform float u_Sharpness = 0.5;
+
+void main() 
+{
+	vec2 texel = 1.0 / vec2(textureSize(s_screenTex, 0));
+
+	//Keep every tap inside the render region, anything past it is stale
+	vec2 minUV = texel * 0.5;
+	vec2 maxUV = u_UVScale - texel * 0.5;
+	vec2 uv = clamp(inUV, minUV, maxUV);
+
+	vec4 source = texture(s_screenTex, uv);
+
+	vec3 north = texture(s_screenTex, clamp(uv + vec2(0.0, texel.y), minUV, maxUV)).rgb;
+	vec3 south = texture(s_screenTex, clamp(uv - vec2(0.0, texel.y), minUV, maxUV)).rgb;
+	vec3 east = texture(s_screenTex, clamp(uv + vec2(texel.x, 0.0), minUV, maxUV)).rgb;
+	vec3 west = texture(s_screenTex, clamp(uv - vec2(texel.x, 0.0), minUV, maxUV)).rgb;
+
+	//Unsharp mask against the cross average
+	vec3 blurred = (north + south + east + west) * 0.25;
+	vec3 sharpened = source.rgb + (source.rgb - blurred) * u_Sharpness;
+
+	//Clamp to the neighbourhood so edges don't ring
+	vec3 lowest = min(source.rgb, min(min(north, south), min(east, west)));
+	vec3 highest = max(source.rgb, max(max(north, south), max(east, west)));
+
+	frag_color.rgb = clamp(sharpened, lowest, highest);
+	frag_color.a = source.a;
+}
@@ -1,4 +1,4 @@
-#version 410
+#version 420
 
 layout(location = 0) in vec3 inPos;
 layout(location = 1) in vec3 inColor;
@@ -13,7 +13,7 @@ uniform float u_AmbientLightStrength;
 uniform float u_SpecularLightStrength;
 uniform float u_Shininess;
 
-uniform vec3  u_CamPos;
+#include "include/frame_data.glsl"
 
 out vec4 frag_color;
 
@@ -1,12 +1,24 @@
-#version 410
+#version 420
 
 layout(location = 0) in vec3 inPos;
 layout(location = 1) in vec3 inColor;
 layout(location = 2) in vec3 inNormal;
 layout(location = 3) in vec2 inUV;
+layout(location = 4) in vec4 inClipPos;
+layout(location = 5) in vec4 inPrevClipPos;
+
+// Keywords, each combination is its own shader variant (see Shader::GetVariant)
+//  TEXTURE_MIX            - blends s_Diffuse2 over s_Diffuse by u_TextureMix, set per material
+//  LIGHTING_UNLIT         - texture and vertex color only
+//  LIGHTING_AMBIENT_ONLY  - only the light's ambient term
+//  LIGHTING_SPECULAR_ONLY - only the light's specular term
+//  LIGHTING_AMBIENT_SPECULAR - ambient and specular, no diffuse
+//  LIGHTING_TEXTURES_OFF  - full lighting on the vertex color, no textures
 
 uniform sampler2D s_Diffuse;
+#ifdef TEXTURE_MIX
 uniform sampler2D s_Diffuse2;
+#endif
 uniform sampler2D s_Specular;
 
 uniform vec3  u_AmbientCol;
@@ -16,30 +28,35 @@ uniform vec3  u_LightPos;
 uniform vec3  u_LightCol;
 uniform float u_AmbientLightStrength;
 uniform float u_SpecularLightStrength;
-uniform float u_Shininess;
 // NEW in week 7, see https://learnopengl.com/Lighting/Light-casters for a good reference on how this all works, or
 // https://developer.valvesoftware.com/wiki/Constant-Linear-Quadratic_Falloff
 uniform float u_LightAttenuationConstant;
 uniform float u_LightAttenuationLinear;
 uniform float u_LightAttenuationQuadratic;
 
-uniform float u_TextureMix;
+// Per-material parameters, each material keeps its own copy of this block (see ShaderMaterial)
+layout(std140, binding = 4) uniform MaterialBlock {
+	float u_Shininess;
+	float u_TextureMix;
+};
 
-uniform vec3  u_CamPos;
+// Screen space ambient occlusion, one texel per pixel
+uniform sampler2D s_AmbientOcclusion;
+uniform float u_AOStrength;
 
-out vec4 frag_color;
+#include "include/frame_data.glsl"
 
-uniform int u_lightingValue;
-uniform int u_ambientOnly;
-uniform int u_specularOnly;
-uniform int u_ambientSpecular;
-uniform int u_ambientspecularBloom;
-uniform int u_textureoff;
+layout(location = 0) out vec4 frag_color;
+// Screen space motion since last frame (in UV units)
+layout(location = 1) out vec2 frag_velocity;
 
 // https://learnopengl.com/Advanced-Lighting/Advanced-Lighting
 void main() {
+	// AO only darkens the ambient light, direct light has its own shadowing (or lack of it)
+	float ao = mix(1.0, texelFetch(s_AmbientOcclusion, ivec2(gl_FragCoord.xy), 0).r, u_AOStrength);
+
 	// Lecture 5
-	vec3 ambient = u_AmbientLightStrength * u_LightCol;
+	vec3 ambient = u_AmbientLightStrength * u_LightCol * ao;
 
 	// Diffuse
 	vec3 N = normalize(inNormal);
@@ -65,44 +82,32 @@ void main() {
 	vec3 specular = u_SpecularLightStrength * texSpec * spec * u_LightCol; // Can also use a specular color
 
 	// Get the albedo from the diffuse / albedo map
-	vec4 textureColor1 = texture(s_Diffuse, inUV);
-	vec4 textureColor2 = texture(s_Diffuse2, inUV);
-	vec4 textureColor = mix(textureColor1, textureColor2, u_TextureMix);
-
+	vec4 textureColor = texture(s_Diffuse, inUV);
+#ifdef TEXTURE_MIX
+	textureColor = mix(textureColor, texture(s_Diffuse2, inUV), u_TextureMix);
+#endif
+
+#if defined(LIGHTING_UNLIT)
+	vec3 result = inColor * textureColor.rgb;
+#elif defined(LIGHTING_AMBIENT_ONLY)
+	vec3 result = (ambient * attenuation) * inColor * textureColor.rgb;
+#elif defined(LIGHTING_SPECULAR_ONLY)
+	vec3 result = (specular * attenuation) * inColor * textureColor.rgb;
+#elif defined(LIGHTING_AMBIENT_SPECULAR)
+	vec3 result = ((ambient + specular) * attenuation) * inColor * textureColor.rgb;
+#elif defined(LIGHTING_TEXTURES_OFF)
+	vec3 result = (ambient + diffuse + specular) * inColor;
+#else
 	vec3 result = (
-		(u_AmbientCol * u_AmbientStrength) + // global ambient light
+		(u_AmbientCol * u_AmbientStrength * ao) + // global ambient light
 		(ambient + diffuse + specular) * attenuation // light factors from our single light
 		) * inColor * textureColor.rgb; // Object color
-
-		if (u_lightingValue == 1)
-		{
-			result = inColor * textureColor.rgb;
-		}
-
-
-		if (u_ambientOnly == 1)
-		{
-			result = (ambient * attenuation) * inColor * textureColor.rgb;
-		}
-
-
-		if (u_specularOnly == 1)
-		{
-			result = (specular * attenuation) * inColor * textureColor.rgb;
-		}
-
-
-		if (u_ambientSpecular == 1)
-		{
-			result = ((ambient + specular) * attenuation) * inColor * textureColor.rgb;
-		}
-
-
-		if (u_textureoff == 1)
-		{
-			result = (ambient + diffuse + specular) * inColor;
-		}
-		
+#endif
 
 	frag_color = vec4(result, textureColor.a);
+
+	// Take the jitter back out so still objects have no motion
+	vec2 current = inClipPos.xy / inClipPos.w - u_TAAJitter.xy;
+	vec2 previous = inPrevClipPos.xy / inPrevClipPos.w - u_TAAJitter.zw;
+	frag_velocity = (current - previous) * 0.5;
 }
\ No newline at end of file
@@ -1,4 +1,4 @@
-#version 410
+#version 420
 
 layout(location = 0) in vec3 inPos;
 layout(location = 1) in vec3 inColor;
@@ -8,7 +8,7 @@ layout(location = 3) in vec2 inUV;
 uniform samplerCube s_Environment;
 uniform mat3 u_EnvironmentRotation;
 
-uniform vec3  u_CamPos;
+#include "include/frame_data.glsl"
 
 out vec4 frag_color;
 
@@ -0,0 +1,13 @@
+// Pulled into the scene shaders with #include, so there's only one copy to keep in step with FrameBlock
+// Per-frame camera data, written once a frame into the uniform ring (see UniformBlocks.h)
+layout(std140, binding = 0) uniform FrameData {
+	mat4 u_View;
+	mat4 u_ViewProjection;
+	mat4 u_SkyboxMatrix;
+	// Last frame's camera, for motion vectors
+	mat4 u_PrevViewProjection;
+	mat4 u_PrevSkyboxMatrix;
+	vec3 u_CamPos;
+	// Camera jitter in NDC, this frame in xy and last frame in zw
+	vec4 u_TAAJitter;
+};
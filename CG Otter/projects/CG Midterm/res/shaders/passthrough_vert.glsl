@@ -5,8 +5,11 @@ layout (location = 1) in vec2 inUV;
 
 layout(location = 0) out vec2 outUV;
 
+//Fraction of the source texture that holds the image (dynamic resolution)
+uniform vec2 u_UVScale = vec2(1.0);
+
 void main()
 { 
-	outUV = inUV;
+	outUV = inUV * u_UVScale;
 	gl_Position = vec4(inPosition, 1.0);
 }
\ No newline at end of file
@@ -1,13 +1,22 @@
-#version 410
+#version 420
 
 layout(location = 0) in vec3 inNormal;
+layout(location = 1) in vec4 inClipPos;
+layout(location = 2) in vec4 inPrevClipPos;
 
 uniform samplerCube s_Environment;
 
-out vec4 frag_color;
+#include "include/frame_data.glsl"
+
+layout(location = 0) out vec4 frag_color;
+layout(location = 1) out vec2 frag_velocity;
 
 void main() {
     vec3 norm = normalize(inNormal);
 
     frag_color = vec4(texture(s_Environment, norm).rgb, 1.0);
+
+    vec2 current = inClipPos.xy / inClipPos.w - u_TAAJitter.xy;
+    vec2 previous = inPrevClipPos.xy / inPrevClipPos.w - u_TAAJitter.zw;
+    frag_velocity = (current - previous) * 0.5;
 }
\ No newline at end of file
@@ -1,16 +1,26 @@
-#version 410
+#version 420
 
 layout(location = 0) in vec3 inPosition;
 
 layout(location = 0) out vec3 outNormal;
+layout(location = 1) out vec4 outClipPos;
+layout(location = 2) out vec4 outPrevClipPos;
 
-uniform mat4 u_SkyboxMatrix;
-uniform mat3 u_EnvironmentRotation;
+#include "include/frame_data.glsl"
+
+// Per-material parameters, each material keeps its own copy of this block (see ShaderMaterial)
+layout(std140, binding = 4) uniform MaterialBlock {
+    mat3 u_EnvironmentRotation;
+};
 
 void main() {
     vec4 pos = u_SkyboxMatrix * vec4(inPosition, 1.0);
     gl_Position = pos.xyww;
 
+    // The sky only moves when the camera turns
+    outClipPos = gl_Position;
+    outPrevClipPos = (u_PrevSkyboxMatrix * vec4(inPosition, 1.0)).xyww;
+
     // Normals
     outNormal = u_EnvironmentRotation * inPosition;
 }
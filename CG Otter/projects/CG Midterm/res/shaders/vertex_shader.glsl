@@ -1,4 +1,4 @@
-#version 410
+#version 420
 
 layout(location = 0) in vec3 inPosition;
 layout(location = 1) in vec3 inColor;
@@ -9,18 +9,34 @@ layout(location = 0) out vec3 outPos;
 layout(location = 1) out vec3 outColor;
 layout(location = 2) out vec3 outNormal;
 layout(location = 3) out vec2 outUV;
+// Clip positions for this frame and last frame, for motion vectors
+layout(location = 4) out vec4 outClipPos;
+layout(location = 5) out vec4 outPrevClipPos;
+
+#include "include/frame_data.glsl"
+
+// Per-object transforms, each draw binds its own slice of the uniform ring
+layout(std140, binding = 1) uniform ObjectData {
+	mat4 u_ModelViewProjection;
+	mat4 u_Model;
+	// World matrix from last frame, for motion vectors
+	mat4 u_PrevModel;
+	mat3 u_NormalMatrix;
+};
 
-uniform mat4 u_ModelViewProjection;
-uniform mat4 u_View;
-uniform mat4 u_Model;
-uniform mat3 u_NormalMatrix;
 uniform vec3 u_LightPos;
 
+// The depth pre-pass uses this shader too, both passes have to land on exactly the same depth
+invariant gl_Position;
 
 void main() {
 
 	gl_Position = u_ModelViewProjection * vec4(inPosition, 1.0);
 
+	// Where this vertex was on screen last frame
+	outClipPos = gl_Position;
+	outPrevClipPos = u_PrevViewProjection * u_PrevModel * vec4(inPosition, 1.0);
+
 	// Lecture 5
 	// Pass vertex pos in world space to frag shader
 	outPos = (u_Model * vec4(inPosition, 1.0)).xyz;
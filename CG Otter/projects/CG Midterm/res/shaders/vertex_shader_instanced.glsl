@@ -0,0 +1,61 @@
+#version 460
+
+layout(location = 0) in vec3 inPosition;
+layout(location = 1) in vec3 inColor;
+layout(location = 2) in vec3 inNormal;
+layout(location = 3) in vec2 inUV;
+
+// Per-instance transforms from the InstanceBatcher, for every object drawn this frame
+struct InstanceData {
+	mat4 World;
+	mat4 PrevWorld;
+	mat3 NormalMatrix;
+};
+layout(std430, binding = 2) readonly buffer InstanceBuffer {
+	InstanceData u_Instances[];
+};
+// The first instance of each draw in the multi-draw, indexed by gl_DrawID
+layout(std430, binding = 3) readonly buffer DrawData {
+	uint u_DrawFirstInstance[];
+};
+// gl_DrawID restarts at 0 every multi-draw call, this is where this call's draws start
+uniform int u_FirstDraw;
+
+layout(location = 0) out vec3 outPos;
+layout(location = 1) out vec3 outColor;
+layout(location = 2) out vec3 outNormal;
+layout(location = 3) out vec2 outUV;
+// Clip positions for this frame and last frame, for motion vectors
+layout(location = 4) out vec4 outClipPos;
+layout(location = 5) out vec4 outPrevClipPos;
+
+#include "include/frame_data.glsl"
+
+uniform vec3 u_LightPos;
+
+// The depth pre-pass uses this shader too, both passes have to land on exactly the same depth
+invariant gl_Position;
+
+void main() {
+
+	InstanceData instance = u_Instances[u_DrawFirstInstance[u_FirstDraw + gl_DrawID] + gl_InstanceID];
+
+	vec4 worldPos = instance.World * vec4(inPosition, 1.0);
+	gl_Position = u_ViewProjection * worldPos;
+
+	// Where this vertex was on screen last frame
+	outClipPos = gl_Position;
+	outPrevClipPos = u_PrevViewProjection * instance.PrevWorld * vec4(inPosition, 1.0);
+
+	// Pass vertex pos in world space to frag shader
+	outPos = worldPos.xyz;
+
+	// Normals
+	outNormal = instance.NormalMatrix * inNormal;
+
+	// Pass our UV coords to the fragment shader
+	outUV = inUV;
+
+	outColor = inColor;
+
+}
@@ -0,0 +1,177 @@
+#include "DynamicResolution.h"
+#include <GLM/glm.hpp>
+
+DynamicResolution::DynamicResolution()
+{
+}
+
+DynamicResolution::~DynamicResolution()
+{
+	Unload();
+}
+
+void DynamicResolution::Init()
+{
+	glGenQueries(NUM_QUERIES, _queries);
+
+	for (int i = 0; i < NUM_QUERIES; i++)
+	{
+		_pending[i] = false;
+	}
+}
+
+void DynamicResolution::Unload()
+{
+	if (_queries[0] != GL_NONE)
+	{
+		glDeleteQueries(NUM_QUERIES, _queries);
+
+		for (int i = 0; i < NUM_QUERIES; i++)
+		{
+			_queries[i] = GL_NONE;
+		}
+	}
+}
+
+void DynamicResolution::BeginFrame()
+{
+	//If the ring is full the GPU is way behind, just skip timing this frame
+	_timing = _queries[0] != GL_NONE && !_pending[_writeIndex];
+
+	if (_timing)
+	{
+		glBeginQuery(GL_TIME_ELAPSED, _queries[_writeIndex]);
+	}
+}
+
+void DynamicResolution::EndFrame()
+{
+	if (!_timing)
+		return;
+
+	glEndQuery(GL_TIME_ELAPSED);
+
+	_pending[_writeIndex] = true;
+	_writeIndex = (_writeIndex + 1) % NUM_QUERIES;
+	_timing = false;
+}
+
+float DynamicResolution::Update()
+{
+	//Read back everything that's finished, oldest first
+	while (_pending[_readIndex])
+	{
+		GLint available = GL_FALSE;
+		glGetQueryObjectiv(_queries[_readIndex], GL_QUERY_RESULT_AVAILABLE, &available);
+
+		//Still running, try again next frame
+		if (!available)
+			break;
+
+		GLuint64 elapsed = 0;
+		glGetQueryObjectui64v(_queries[_readIndex], GL_QUERY_RESULT, &elapsed);
+
+		_pending[_readIndex] = false;
+		_readIndex = (_readIndex + 1) % NUM_QUERIES;
+
+		//Nanoseconds to milliseconds
+		AddSample(float(double(elapsed) / 1000000.0));
+	}
+
+	return _scale;
+}
+
+void DynamicResolution::AddSample(float milliseconds)
+{
+	//Smooth the time out so one slow frame doesn't drop the resolution
+	_gpuTime = _gpuTime <= 0.0f ? milliseconds : glm::mix(_gpuTime, milliseconds, _smoothing);
+
+	if (!_enabled)
+		return;
+
+	if (_cooldown > 0)
+	{
+		_cooldown--;
+		return;
+	}
+
+	//Inside the band, leave it alone
+	if (_gpuTime <= _targetTime * (1.0f + _hysteresis) && _gpuTime >= _targetTime * (1.0f - 2.0f * _hysteresis))
+		return;
+
+	//Pixel count goes with scale squared
+	float wanted = _scale * glm::sqrt(_targetTime / _gpuTime);
+
+	//Drop quickly when we're over budget, creep back up slowly
+	wanted = glm::clamp(wanted, _scale - 0.1f, _scale + 0.05f);
+	wanted = glm::clamp(wanted, _minScale, _maxScale);
+
+	//Not worth a change
+	if (glm::abs(wanted - _scale) < 0.01f)
+		return;
+
+	//Guess what the new scale will cost so the smoothing doesn't lag behind the change
+	_gpuTime *= (wanted * wanted) / (_scale * _scale);
+	_scale = wanted;
+	_cooldown = NUM_QUERIES;
+}
+
+bool DynamicResolution::GetEnabled() const
+{
+	return _enabled;
+}
+
+float DynamicResolution::GetScale() const
+{
+	return _scale;
+}
+
+float DynamicResolution::GetTargetTime() const
+{
+	return _targetTime;
+}
+
+float DynamicResolution::GetGPUTime() const
+{
+	return _gpuTime;
+}
+
+float DynamicResolution::GetMinScale() const
+{
+	return _minScale;
+}
+
+float DynamicResolution::GetMaxScale() const
+{
+	return _maxScale;
+}
+
+void DynamicResolution::SetEnabled(bool enabled)
+{
+	_enabled = enabled;
+
+	if (!_enabled)
+	{
+		_scale = _maxScale;
+	}
+
+	_cooldown = NUM_QUERIES;
+}
+
+void DynamicResolution::SetScale(float scale)
+{
+	_scale = glm::clamp(scale, _minScale, _maxScale);
+}
+
+void DynamicResolution::SetTargetTime(float milliseconds)
+{
+	_targetTime = glm::max(milliseconds, 0.1f);
+}
+
+void DynamicResolution::SetScaleRange(float minScale, float maxScale)
+{
+	//Framebuffers can't render past their size, so 1.0 is the top
+	_maxScale = glm::clamp(maxScale, 0.1f, 1.0f);
+	_minScale = glm::clamp(minScale, 0.1f, _maxScale);
+	_scale = glm::clamp(_scale, _minScale, _maxScale);
+}
@@ -0,0 +1,79 @@
+#pragma once
+#include <glad/glad.h>
+
+//Picks the resolution we render the scene at based on how long the GPU is taking
+//*Times the scene + post passes with GPU timer queries
+//*Queries are read back a few frames late so we never stall waiting on the GPU
+//*Fill cost goes with pixel count (scale squared), so we move the scale by sqrt(target / measured)
+//*The scale never goes above 1, so the window sized buffers the effects already have are the "oversized" target
+//*and we render into their bottom left corner (see Framebuffer::SetRenderScale). There's no separate target
+//*bigger than the window, so a window resize still reshapes every buffer in the chain like it always did
+class DynamicResolution
+{
+public:
+	DynamicResolution();
+	~DynamicResolution();
+
+	//Creates the timer queries
+	void Init();
+	//Deletes the timer queries
+	void Unload();
+
+	//Wrap the GPU work we want to measure with these
+	//*Can't be nested with any other GL_TIME_ELAPSED query
+	void BeginFrame();
+	void EndFrame();
+
+	//Reads back any finished timers and updates the scale
+	//*Returns the scale to render at this frame
+	float Update();
+
+	//Getters
+	bool GetEnabled() const;
+	float GetScale() const;
+	float GetTargetTime() const;
+	float GetGPUTime() const;
+	float GetMinScale() const;
+	float GetMaxScale() const;
+
+	//Setters
+	//*Turning it off snaps back to the max scale
+	void SetEnabled(bool enabled);
+	//*Only sticks while the governor is off
+	void SetScale(float scale);
+	//*Frame budget in milliseconds
+	void SetTargetTime(float milliseconds);
+	void SetScaleRange(float minScale, float maxScale);
+private:
+	//How many frames of queries we keep in flight
+	static const int NUM_QUERIES = 4;
+
+	//Feeds one GPU time into the governor
+	void AddSample(float milliseconds);
+
+	GLuint _queries[NUM_QUERIES] = { GL_NONE };
+	//Has this query been issued and not read back yet
+	bool _pending[NUM_QUERIES] = { false };
+	//Next query to issue and the oldest one waiting on the GPU
+	int _writeIndex = 0;
+	int _readIndex = 0;
+	//Is there a query running this frame
+	bool _timing = false;
+
+	bool _enabled = true;
+	float _scale = 1.0f;
+	float _minScale = 0.5f;
+	float _maxScale = 1.0f;
+	//16.6ms is 60fps
+	float _targetTime = 16.6f;
+
+	//Smoothed GPU time in milliseconds
+	float _gpuTime = 0.0f;
+	//How quickly the smoothed time follows new samples
+	float _smoothing = 0.1f;
+	//How far off target we can be before we bother changing the scale
+	//*Headroom band is twice as wide so we don't bounce up and straight back down
+	float _hysteresis = 0.05f;
+	//Samples to skip after a change, the ones in flight were measured at the old scale
+	int _cooldown = 0;
+};
@@ -1,4 +1,5 @@
 #include "Framebuffer.h"
+#include <GLState.h>
 
 GLuint Framebuffer::_fullscreenQuadVBO = 0;
 GLuint Framebuffer::_fullscreenQuadVAO = 0;
@@ -15,6 +16,7 @@ DepthTarget::~DepthTarget()
 void DepthTarget::Unload()
 {
 	//Deletes the texture at the specific handle
+	GLState::OnTextureDeleted(_texture.GetHandle());
 	glDeleteTextures(1, &_texture.GetHandle());
 }
 
@@ -26,6 +28,10 @@ ColorTarget::~ColorTarget()
 
 void ColorTarget::Unload()
 {
+	for (unsigned i = 0; i < _numAttachments; i++)
+	{
+		GLState::OnTextureDeleted(_textures[i].GetHandle());
+	}
 	glDeleteTextures(_numAttachments, &_textures[0].GetHandle());
 }
 
@@ -41,6 +47,7 @@ Framebuffer::~Framebuffer()
 void Framebuffer::Unload()
 {
 	//Deletes the framebuffer
+	GLState::OnFramebufferDeleted(_FBO);
 	glDeleteFramebuffers(1, &_FBO);
 	//Sets init to false
 	_isInit = false;
@@ -57,10 +64,8 @@ void Framebuffer::Init(unsigned width, unsigned height)
 
 void Framebuffer::Init()
 {
-	//Generates the FBO
-	glGenFramebuffers(1, &_FBO);
-	//Bind it
-	glBindFramebuffer(GL_FRAMEBUFFER, _FBO);
+	//Generates the FBO, everything here goes through DSA so nothing gets bound
+	glCreateFramebuffers(1, &_FBO);
 
 	if (_depthActive)
 	{
@@ -68,11 +73,9 @@ void Framebuffer::Init()
 		_clearFlag |= GL_DEPTH_BUFFER_BIT;
 
 		//Generate the texture
-		glGenTextures(1, &_depth._texture.GetHandle());
-		//Binds the texture
-		glBindTexture(GL_TEXTURE_2D, _depth._texture.GetHandle());
+		glCreateTextures(GL_TEXTURE_2D, 1, &_depth._texture.GetHandle());
 		//Sets the texture data
-		glTexStorage2D(GL_TEXTURE_2D, 1, GL_DEPTH_COMPONENT24, _width, _height);
+		glTextureStorage2D(_depth._texture.GetHandle(), 1, GL_DEPTH_COMPONENT24, _width, _height);
 
 		//Set texture parameters
 		glTextureParameteri(_depth._texture.GetHandle(), GL_TEXTURE_MIN_FILTER, _filter);
@@ -81,9 +84,7 @@ void Framebuffer::Init()
 		glTextureParameteri(_depth._texture.GetHandle(), GL_TEXTURE_WRAP_T, _wrap);
 
 		//Sets up as a framebuffer texture
-		glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, _depth._texture.GetHandle(), 0);
-
-		glBindTexture(GL_TEXTURE_2D, GL_NONE);
+		glNamedFramebufferTexture(_FBO, GL_DEPTH_ATTACHMENT, _depth._texture.GetHandle(), 0);
 	}
 
 	//If there is more than zero color attachments
@@ -95,17 +96,15 @@ void Framebuffer::Init()
 		//Creates the GLuints to hold the new texture handles;
 		GLuint* textureHandles = new GLuint[_color._numAttachments];
 
-		glGenTextures(_color._numAttachments, textureHandles);
+		glCreateTextures(GL_TEXTURE_2D, _color._numAttachments, textureHandles);
 
 		//Loops through them
 		for (unsigned i = 0; i < _color._numAttachments; i++)
 		{
 			_color._textures[i].GetHandle() = textureHandles[i];
 
-			//Binds the texture
-			glBindTexture(GL_TEXTURE_2D, _color._textures[i].GetHandle());
 			//Sets the texture storage
-			glTexStorage2D(GL_TEXTURE_2D, 1, _color._formats[i], _width, _height);
+			glTextureStorage2D(_color._textures[i].GetHandle(), 1, _color._formats[i], _width, _height);
 
 			//Set texture parameters
 			glTextureParameteri(_color._textures[i].GetHandle(), GL_TEXTURE_MIN_FILTER, _filter);
@@ -114,16 +113,17 @@ void Framebuffer::Init()
 			glTextureParameteri(_color._textures[i].GetHandle(), GL_TEXTURE_WRAP_T, _wrap);
 
 			//Sets up as a framebuffer texture
-			glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0 + i, GL_TEXTURE_2D, _color._textures[i].GetHandle(), 0);
+			glNamedFramebufferTexture(_FBO, GL_COLOR_ATTACHMENT0 + i, _color._textures[i].GetHandle(), 0);
 		}
 
 		delete[] textureHandles;
+
+		//Draw buffers belong to the framebuffer object, so setting them once here is enough
+		glNamedFramebufferDrawBuffers(_FBO, _color._numAttachments, &_color._buffers[0]);
 	}
 
 	//Make sure it's set up right
 	CheckFBO();
-	//Unbind buffer
-	glBindFramebuffer(GL_FRAMEBUFFER, GL_NONE);
 	//Set init to true
 	_isInit = true;
 }
@@ -164,8 +164,22 @@ void Framebuffer::BindColorAsTexture(unsigned colorBuffer, int textureSlot) cons
 void Framebuffer::UnbindTexture(int textureSlot) const
 {
 	//Binds textures to GL_NONE
-	glActiveTexture(GL_TEXTURE0 + textureSlot);
-	glBindTexture(GL_TEXTURE_2D, GL_NONE);
+	GLState::BindTexture(textureSlot, GL_NONE);
+}
+
+void Framebuffer::ReadColorTarget(unsigned colorBuffer, CPUImage& image)
+{
+	image.Resize(_renderWidth, _renderHeight);
+
+	GLsizei bufferSize = GLsizei(image.GetWidth() * image.GetHeight() * 4 * sizeof(float));
+	glGetTextureSubImage(_color._textures[colorBuffer].GetHandle(), 0, 0, 0, 0, _renderWidth, _renderHeight, 1,
+		GL_RGBA, GL_FLOAT, bufferSize, image.GetData());
+}
+
+void Framebuffer::WriteColorTarget(unsigned colorBuffer, const CPUImage& image)
+{
+	glTextureSubImage2D(_color._textures[colorBuffer].GetHandle(), 0, 0, 0, _renderWidth, _renderHeight,
+		GL_RGBA, GL_FLOAT, image.GetData());
 }
 
 void Framebuffer::Reshape(unsigned width, unsigned height)
@@ -187,26 +201,52 @@ void Framebuffer::SetSize(unsigned width, unsigned height)
 	//Sets the width and height
 	_width = width;
 	_height = height;
+	//Keeps the render region in step with the new size
+	UpdateRenderSize();
+}
+
+void Framebuffer::SetRenderScale(float scale)
+{
+	//Can't render into more than the framebuffer we have
+	_renderScale = glm::clamp(scale, 0.0f, 1.0f);
+	UpdateRenderSize();
+}
+
+float Framebuffer::GetRenderScale() const
+{
+	return _renderScale;
+}
+
+unsigned Framebuffer::GetRenderWidth() const
+{
+	return _renderWidth;
+}
+
+unsigned Framebuffer::GetRenderHeight() const
+{
+	return _renderHeight;
+}
+
+void Framebuffer::UpdateRenderSize()
+{
+	//Never let the region collapse to nothing
+	_renderWidth = glm::max(1u, unsigned(_width * _renderScale + 0.5f));
+	_renderHeight = glm::max(1u, unsigned(_height * _renderScale + 0.5f));
 }
 
 void Framebuffer::SetViewport() const
 {
-	glViewport(0, 0, _width, _height);
+	glViewport(0, 0, _renderWidth, _renderHeight);
 }
 
 void Framebuffer::Bind() const
 {
-	glBindFramebuffer(GL_FRAMEBUFFER, _FBO);
-
-	if (_color._numAttachments)
-	{
-		glDrawBuffers(_color._numAttachments, &_color._buffers[0]);
-	}
+	GLState::BindFramebuffer(GL_FRAMEBUFFER, _FBO);
 }
 
 void Framebuffer::Unbind() const
 {
-	glBindFramebuffer(GL_FRAMEBUFFER, GL_NONE);
+	GLState::BindFramebuffer(GL_FRAMEBUFFER, GL_NONE);
 }
 
 void Framebuffer::RenderToFSQ() const
@@ -223,27 +263,21 @@ void Framebuffer::RenderToFSQ() const
 
 void Framebuffer::DrawToBackbuffer()
 {
-	glBindFramebuffer(GL_READ_FRAMEBUFFER, _FBO);
-	glBindFramebuffer(GL_DRAW_FRAMEBUFFER, GL_NONE);
-
 	//Blits the framebuffer to the back buffer
-	glBlitFramebuffer(0, 0, _width, _height, 0, 0, _width, _height, GL_COLOR_BUFFER_BIT, GL_NEAREST);
-	glBindFramebuffer(GL_READ_FRAMEBUFFER, GL_NONE);
+	glBlitNamedFramebuffer(_FBO, GL_NONE, 0, 0, _width, _height, 0, 0, _width, _height, GL_COLOR_BUFFER_BIT, GL_NEAREST);
 }
 
 void Framebuffer::Clear()
 {
-	glBindFramebuffer(GL_FRAMEBUFFER, _FBO);
+	Bind();
 	glClear(_clearFlag);
-	glBindFramebuffer(GL_FRAMEBUFFER, GL_NONE);
+	Unbind();
 }
 
 bool Framebuffer::CheckFBO()
 {
-	//Binds the framebuffer
-	Bind();
 	//Check the framebuffer status
-	if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+	if (glCheckNamedFramebufferStatus(_FBO, GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
 	{
 		printf("Framebuffer is not vibing\n");
 		return false;
@@ -282,7 +316,7 @@ void Framebuffer::InitFullscreenQuad()
 	//Generates vertex array
 	glGenVertexArrays(1, &_fullscreenQuadVAO);
 	//Binds VAO
-	glBindVertexArray(_fullscreenQuadVAO);
+	GLState::BindVertexArray(_fullscreenQuadVAO);
 
 	//Enables 2 vertex attrib array slots
 	glEnableVertexAttribArray(0); //Vertices
@@ -305,14 +339,13 @@ void Framebuffer::InitFullscreenQuad()
 #pragma warning(pop)
 
 	glBindBuffer(GL_ARRAY_BUFFER, GL_NONE);
-	glBindVertexArray(GL_NONE);
+	GLState::BindVertexArray(GL_NONE);
 }
 
 void Framebuffer::DrawFullscreenQuad()
 {
-	glBindVertexArray(_fullscreenQuadVAO);
+	GLState::BindVertexArray(_fullscreenQuadVAO);
 	glDrawArrays(GL_TRIANGLES, 0, 6);
-	glBindVertexArray(GL_NONE);
 }
 
 
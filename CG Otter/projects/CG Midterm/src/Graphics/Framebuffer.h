@@ -2,6 +2,7 @@
 #include <vector>
 #include <Texture2D.h>
 #include <Shader.h>
+#include "Graphics/Post/CPU/CPUImage.h"
 
 struct DepthTarget
 {
@@ -59,12 +60,29 @@ public:
 	//Unbinds texture from a specific texture slot
 	void UnbindTexture(int textureSlot) const;
 
+	//Reads the render region of a color target back into a CPU image
+	//*Stalls until the GPU is done with it, debug use only
+	void ReadColorTarget(unsigned colorBuffer, CPUImage& image);
+	//Copies a CPU image into the render region of a color target
+	//*Image has to be the size of the render region
+	void WriteColorTarget(unsigned colorBuffer, const CPUImage& image);
+
 	//Reshapes the framebuffer
 	void Reshape(unsigned width, unsigned height);
 	//Sets the size of the framebuffer
 	void SetSize(unsigned width, unsigned height);
 
-	//Sets the viewport to fullscreen (using the size of framebuffer)
+	//Sets the fraction of the framebuffer we actually render into
+	//*Scale of 1.0 is the whole framebuffer, below that we only use the bottom left corner
+	//*Doesn't reallocate anything, the textures stay at full size
+	void SetRenderScale(float scale);
+	float GetRenderScale() const;
+	//Size of the region we render into (size * render scale)
+	unsigned GetRenderWidth() const;
+	unsigned GetRenderHeight() const;
+
+	//Sets the viewport to the render region of the framebuffer
+	//*Fullscreen when the render scale is 1.0
 	void SetViewport() const;
 	
 	//Binds the framebuffer
@@ -94,6 +112,15 @@ public:
 	unsigned int _width = 0;
 	unsigned int _height = 0;
 protected:
+	//Updates the render region from the size and render scale
+	void UpdateRenderSize();
+
+	//Fraction of the framebuffer we render into
+	float _renderScale = 1.0f;
+	//Size of the render region
+	unsigned int _renderWidth = 0;
+	unsigned int _renderHeight = 0;
+
 	//OpenGL framebuffer handle
 	GLuint _FBO;
 	//Depth attachment (either one or none)
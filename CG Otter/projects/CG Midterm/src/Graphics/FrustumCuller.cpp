@@ -0,0 +1,190 @@
+#include "FrustumCuller.h"
+#include <emmintrin.h>
+
+FrustumCuller::FrustumCuller()
+{
+}
+
+FrustumCuller::~FrustumCuller()
+{
+}
+
+void FrustumCuller::Begin()
+{
+	_count = 0;
+	_visibleCount = 0;
+
+	for (int i = 0; i < 9; i++)
+		_m[i].clear();
+	for (int i = 0; i < 3; i++)
+	{
+		_t[i].clear();
+		_center[i].clear();
+		_extent[i].clear();
+	}
+	_radius.clear();
+	_alwaysVisible.clear();
+	_visible.clear();
+}
+
+void FrustumCuller::Add(const VertexArrayObject* mesh, const glm::mat4& world)
+{
+	for (int column = 0; column < 3; column++)
+	{
+		for (int row = 0; row < 3; row++)
+		{
+			_m[column * 3 + row].push_back(world[column][row]);
+		}
+		_t[column].push_back(world[3][column]);
+	}
+
+	bool hasBounds = mesh->HasBounds();
+	glm::vec3 center = hasBounds ? (mesh->GetBoundsMin() + mesh->GetBoundsMax()) * 0.5f : glm::vec3(0.0f);
+	glm::vec3 extent = hasBounds ? (mesh->GetBoundsMax() - mesh->GetBoundsMin()) * 0.5f : glm::vec3(0.0f);
+	for (int i = 0; i < 3; i++)
+	{
+		_center[i].push_back(center[i]);
+		_extent[i].push_back(extent[i]);
+	}
+	_radius.push_back(hasBounds ? mesh->GetBoundingRadius() : 0.0f);
+	_alwaysVisible.push_back(hasBounds ? 0 : 1);
+
+	_count++;
+}
+
+void FrustumCuller::Cull(const glm::mat4& viewProjection)
+{
+	Pad();
+	_visible.assign(_count, 0);
+	_visibleCount = 0;
+
+	glm::vec4 planes[6];
+	ExtractPlanes(viewProjection, planes);
+
+	//Splat each plane across the lanes once, the box test wants the absolute normal too
+	__m128 planeX[6], planeY[6], planeZ[6], planeW[6];
+	__m128 absX[6], absY[6], absZ[6];
+	for (int p = 0; p < 6; p++)
+	{
+		planeX[p] = _mm_set1_ps(planes[p].x);
+		planeY[p] = _mm_set1_ps(planes[p].y);
+		planeZ[p] = _mm_set1_ps(planes[p].z);
+		planeW[p] = _mm_set1_ps(planes[p].w);
+		absX[p] = _mm_set1_ps(glm::abs(planes[p].x));
+		absY[p] = _mm_set1_ps(glm::abs(planes[p].y));
+		absZ[p] = _mm_set1_ps(glm::abs(planes[p].z));
+	}
+	const __m128 signMask = _mm_set1_ps(-0.0f);
+
+	for (unsigned i = 0; i < _count; i += 4)
+	{
+		__m128 m[9];
+		for (int j = 0; j < 9; j++)
+		{
+			m[j] = _mm_loadu_ps(&_m[j][i]);
+		}
+		__m128 cx = _mm_loadu_ps(&_center[0][i]);
+		__m128 cy = _mm_loadu_ps(&_center[1][i]);
+		__m128 cz = _mm_loadu_ps(&_center[2][i]);
+		__m128 ex = _mm_loadu_ps(&_extent[0][i]);
+		__m128 ey = _mm_loadu_ps(&_extent[1][i]);
+		__m128 ez = _mm_loadu_ps(&_extent[2][i]);
+
+		//World center = M * c + t
+		__m128 wx = _mm_add_ps(_mm_add_ps(_mm_mul_ps(m[0], cx), _mm_mul_ps(m[3], cy)), _mm_add_ps(_mm_mul_ps(m[6], cz), _mm_loadu_ps(&_t[0][i])));
+		__m128 wy = _mm_add_ps(_mm_add_ps(_mm_mul_ps(m[1], cx), _mm_mul_ps(m[4], cy)), _mm_add_ps(_mm_mul_ps(m[7], cz), _mm_loadu_ps(&_t[1][i])));
+		__m128 wz = _mm_add_ps(_mm_add_ps(_mm_mul_ps(m[2], cx), _mm_mul_ps(m[5], cy)), _mm_add_ps(_mm_mul_ps(m[8], cz), _mm_loadu_ps(&_t[2][i])));
+
+		//World box half size = |M| * e
+		__m128 am[9];
+		for (int j = 0; j < 9; j++)
+		{
+			am[j] = _mm_andnot_ps(signMask, m[j]);
+		}
+		__m128 wex = _mm_add_ps(_mm_add_ps(_mm_mul_ps(am[0], ex), _mm_mul_ps(am[3], ey)), _mm_mul_ps(am[6], ez));
+		__m128 wey = _mm_add_ps(_mm_add_ps(_mm_mul_ps(am[1], ex), _mm_mul_ps(am[4], ey)), _mm_mul_ps(am[7], ez));
+		__m128 wez = _mm_add_ps(_mm_add_ps(_mm_mul_ps(am[2], ex), _mm_mul_ps(am[5], ey)), _mm_mul_ps(am[8], ez));
+
+		//Sphere grows with the biggest axis scale
+		__m128 scale0 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(m[0], m[0]), _mm_mul_ps(m[1], m[1])), _mm_mul_ps(m[2], m[2]));
+		__m128 scale1 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(m[3], m[3]), _mm_mul_ps(m[4], m[4])), _mm_mul_ps(m[5], m[5]));
+		__m128 scale2 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(m[6], m[6]), _mm_mul_ps(m[7], m[7])), _mm_mul_ps(m[8], m[8]));
+		__m128 maxScale = _mm_sqrt_ps(_mm_max_ps(_mm_max_ps(scale0, scale1), scale2));
+		__m128 radius = _mm_mul_ps(_mm_loadu_ps(&_radius[i]), maxScale);
+
+		//All ones while the lane is still inside every plane
+		__m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+		for (int p = 0; p < 6; p++)
+		{
+			__m128 distance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(planeX[p], wx), _mm_mul_ps(planeY[p], wy)),
+				_mm_add_ps(_mm_mul_ps(planeZ[p], wz), planeW[p]));
+			__m128 boxRadius = _mm_add_ps(_mm_add_ps(_mm_mul_ps(absX[p], wex), _mm_mul_ps(absY[p], wey)), _mm_mul_ps(absZ[p], wez));
+
+			//Outside if the closer of the two bounds is fully behind the plane
+			__m128 reach = _mm_min_ps(radius, boxRadius);
+			inside = _mm_and_ps(inside, _mm_cmpge_ps(distance, _mm_sub_ps(_mm_setzero_ps(), reach)));
+		}
+
+		int mask = _mm_movemask_ps(inside);
+		for (unsigned lane = 0; lane < 4 && i + lane < _count; lane++)
+		{
+			bool visible = (mask & (1 << lane)) != 0 || _alwaysVisible[i + lane];
+			_visible[i + lane] = visible ? 1 : 0;
+			_visibleCount += visible ? 1 : 0;
+		}
+	}
+}
+
+bool FrustumCuller::IsVisible(unsigned index) const
+{
+	return _visible[index] != 0;
+}
+
+unsigned FrustumCuller::GetVisibleCount() const
+{
+	return _visibleCount;
+}
+
+unsigned FrustumCuller::GetTotalCount() const
+{
+	return _count;
+}
+
+void FrustumCuller::ExtractPlanes(const glm::mat4& viewProjection, glm::vec4 planes[6])
+{
+	//Rows of the matrix, glm is column major
+	glm::vec4 rows[4];
+	for (int i = 0; i < 4; i++)
+	{
+		rows[i] = glm::vec4(viewProjection[0][i], viewProjection[1][i], viewProjection[2][i], viewProjection[3][i]);
+	}
+
+	//Left, right, bottom, top, near, far
+	planes[0] = rows[3] + rows[0];
+	planes[1] = rows[3] - rows[0];
+	planes[2] = rows[3] + rows[1];
+	planes[3] = rows[3] - rows[1];
+	planes[4] = rows[3] + rows[2];
+	planes[5] = rows[3] - rows[2];
+
+	//Normalize so distances come out in world units
+	for (int i = 0; i < 6; i++)
+	{
+		planes[i] /= glm::length(glm::vec3(planes[i]));
+	}
+}
+
+void FrustumCuller::Pad()
+{
+	//Padding lanes get zeros, they're never read back
+	size_t padded = (_count + 3) & ~size_t(3);
+	for (int i = 0; i < 9; i++)
+		_m[i].resize(padded, 0.0f);
+	for (int i = 0; i < 3; i++)
+	{
+		_t[i].resize(padded, 0.0f);
+		_center[i].resize(padded, 0.0f);
+		_extent[i].resize(padded, 0.0f);
+	}
+	_radius.resize(padded, 0.0f);
+}
@@ -0,0 +1,50 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include <GLM/glm.hpp>
+#include <VertexArrayObject.h>
+
+//Throws out objects that are completely outside the camera frustum
+//*Bounds are stored structure of arrays so SSE can transform and test 4 objects at a time
+//*Tests both the world space bounding sphere and the world space box around the mesh's AABB
+//*An object is culled if either one is fully outside any plane
+class FrustumCuller
+{
+public:
+	FrustumCuller();
+	~FrustumCuller();
+
+	//Clears last frame's objects
+	void Begin();
+	//Queues an object for culling, they're indexed in the order they're added
+	//*Meshes without bounds are always visible
+	void Add(const VertexArrayObject* mesh, const glm::mat4& world);
+	//Tests everything that was added against the frustum
+	void Cull(const glm::mat4& viewProjection);
+
+	//Getters
+	bool IsVisible(unsigned index) const;
+	unsigned GetVisibleCount() const;
+	unsigned GetTotalCount() const;
+
+	//Pulls the 6 planes out of a view projection matrix, normals point inwards
+	static void ExtractPlanes(const glm::mat4& viewProjection, glm::vec4 planes[6]);
+private:
+	//Rounds the arrays up to a whole number of SSE lanes
+	void Pad();
+
+	unsigned _count = 0;
+	unsigned _visibleCount = 0;
+
+	//World matrix, upper 3x3 by column and translation
+	std::vector<float> _m[9];
+	std::vector<float> _t[3];
+	//Local bounds center and half size, the sphere shares the same center
+	std::vector<float> _center[3];
+	std::vector<float> _extent[3];
+	std::vector<float> _radius;
+	//No bounds, skip the test
+	std::vector<uint8_t> _alwaysVisible;
+
+	std::vector<uint8_t> _visible;
+};
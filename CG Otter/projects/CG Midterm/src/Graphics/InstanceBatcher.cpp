@@ -0,0 +1,182 @@
+#include "InstanceBatcher.h"
+#include "Utilities/BackendHandler.h"
+
+//Uniforms set every frame, hashed at compile time
+static constexpr UniformId u_FirstDraw("u_FirstDraw");
+
+InstanceBatcher::InstanceBatcher()
+{
+}
+
+InstanceBatcher::~InstanceBatcher()
+{
+	Unload();
+}
+
+void InstanceBatcher::Init()
+{
+	glCreateBuffers(1, &_instanceBuffer);
+	glCreateBuffers(1, &_drawBuffer);
+	glCreateBuffers(1, &_commandBuffer);
+}
+
+void InstanceBatcher::Unload()
+{
+	if (_instanceBuffer != GL_NONE)
+	{
+		glDeleteBuffers(1, &_instanceBuffer);
+		glDeleteBuffers(1, &_drawBuffer);
+		glDeleteBuffers(1, &_commandBuffer);
+		_instanceBuffer = _drawBuffer = _commandBuffer = GL_NONE;
+	}
+	_instancedShaders.clear();
+}
+
+void InstanceBatcher::Begin()
+{
+	_instances.clear();
+	_draws.clear();
+	_commands.clear();
+	_batches.clear();
+	_buckets.clear();
+	_drawCount = 0;
+}
+
+void InstanceBatcher::Add(MeshHandle mesh, MaterialHandle material, const glm::mat4& world,
+	const glm::mat4& prevWorld, const glm::mat3& normalMatrix)
+{
+	//Start a new batch if this doesn't match the last one
+	//Handles are resolved once per batch, not once per object
+	if (_batches.empty() || _batches.back().MeshId != mesh || _batches.back().MaterialId != material)
+	{
+		InstanceBatch batch;
+		batch.MeshId = mesh;
+		batch.MaterialId = material;
+		batch.Mesh = Resources::Meshes.Get(mesh);
+		batch.Material = Resources::Materials.Get(material);
+		batch.First = unsigned(_instances.size());
+		_batches.push_back(batch);
+	}
+
+	InstanceData instance;
+	instance.World = world;
+	instance.PrevWorld = prevWorld;
+	for (int i = 0; i < 3; i++)
+	{
+		instance.NormalMatrix[i] = glm::vec4(normalMatrix[i], 0.0f);
+	}
+	_instances.push_back(instance);
+	_batches.back().Count++;
+}
+
+void InstanceBatcher::End()
+{
+	if (_instances.empty())
+		return;
+
+	for (unsigned i = 0; i < _batches.size(); i++)
+	{
+		const InstanceBatch& batch = _batches[i];
+		VertexArrayObject* arena = batch.Mesh->GetArenaVAO().get();
+
+		//One command per batch, meshes with their own buffers never get multi-drawn so theirs is never read
+		DrawElementsIndirectCommand command;
+		command.Count = GLuint(batch.Mesh->GetIndexCount());
+		command.InstanceCount = batch.Count;
+		command.FirstIndex = batch.Mesh->GetFirstIndex();
+		command.BaseVertex = batch.Mesh->GetBaseVertex();
+		command.BaseInstance = batch.First;
+		_commands.push_back(command);
+		_draws.push_back(batch.First);
+
+		//Start a new bucket if the material or arena changes
+		if (_buckets.empty() || _buckets.back().Material != batch.Material || _buckets.back().ArenaVAO != arena ||
+			arena == nullptr)
+		{
+			InstanceBucket bucket;
+			bucket.Material = batch.Material;
+			bucket.ArenaVAO = arena;
+			bucket.FirstBatch = i;
+			_buckets.push_back(bucket);
+		}
+		_buckets.back().BatchCount++;
+	}
+
+	//Reallocates the storage, so we don't wait on the GPU still reading last frame's data
+	glNamedBufferData(_instanceBuffer, _instances.size() * sizeof(InstanceData), _instances.data(), GL_STREAM_DRAW);
+	glNamedBufferData(_drawBuffer, _draws.size() * sizeof(GLuint), _draws.data(), GL_STREAM_DRAW);
+	glNamedBufferData(_commandBuffer, _commands.size() * sizeof(DrawElementsIndirectCommand), _commands.data(), GL_STREAM_DRAW);
+}
+
+void InstanceBatcher::Render(const InstanceBucket& bucket, Shader* shader, UniformRing& ring, const glm::mat4& viewProjection)
+{
+	if (IsInstanced(shader))
+	{
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, INSTANCE_BUFFER_BINDING, _instanceBuffer);
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, DRAW_BUFFER_BINDING, _drawBuffer);
+		//gl_DrawID starts at 0 every call, this is where the bucket's draws start
+		shader->SetUniform(u_FirstDraw, int(bucket.FirstBatch));
+
+		if (bucket.ArenaVAO != nullptr)
+		{
+			bucket.ArenaVAO->Bind();
+			glBindBuffer(GL_DRAW_INDIRECT_BUFFER, _commandBuffer);
+			glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT,
+				(void*)(bucket.FirstBatch * sizeof(DrawElementsIndirectCommand)), bucket.BatchCount, 0);
+			glBindBuffer(GL_DRAW_INDIRECT_BUFFER, GL_NONE);
+			_drawCount++;
+		}
+		else
+		{
+			//Mesh isn't in an arena, it's always a bucket of one batch so gl_DrawID of 0 is right
+			const InstanceBatch& batch = _batches[bucket.FirstBatch];
+			batch.Mesh->RenderInstanced(batch.Count, batch.First);
+			_drawCount++;
+		}
+		return;
+	}
+
+	//Old style shader, one object at a time
+	for (unsigned b = bucket.FirstBatch; b < bucket.FirstBatch + bucket.BatchCount; b++)
+	{
+		const InstanceBatch& batch = _batches[b];
+		for (unsigned i = batch.First; i < batch.First + batch.Count; i++)
+		{
+			const InstanceData& instance = _instances[i];
+			glm::mat3 normalMatrix = glm::mat3(glm::vec3(instance.NormalMatrix[0]), glm::vec3(instance.NormalMatrix[1]), glm::vec3(instance.NormalMatrix[2]));
+			BackendHandler::RenderVAO(ring, batch.Mesh, viewProjection, instance.World, normalMatrix, instance.PrevWorld);
+			_drawCount++;
+		}
+	}
+}
+
+bool InstanceBatcher::IsInstanced(const Shader* shader)
+{
+	auto it = _instancedShaders.find(shader);
+	if (it != _instancedShaders.end() && !it->second.Owner.expired())
+		return it->second.Instanced;
+
+	bool instanced = glGetProgramResourceIndex(shader->GetHandle(), GL_SHADER_STORAGE_BLOCK, "DrawData") != GL_INVALID_INDEX;
+	_instancedShaders[shader] = { shader->weak_from_this(), instanced };
+	return instanced;
+}
+
+const std::vector<InstanceBatch>& InstanceBatcher::GetBatches() const
+{
+	return _batches;
+}
+
+const std::vector<InstanceBucket>& InstanceBatcher::GetBuckets() const
+{
+	return _buckets;
+}
+
+unsigned InstanceBatcher::GetInstanceCount() const
+{
+	return unsigned(_instances.size());
+}
+
+unsigned InstanceBatcher::GetDrawCount() const
+{
+	return _drawCount;
+}
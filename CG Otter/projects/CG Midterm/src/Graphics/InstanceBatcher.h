@@ -0,0 +1,120 @@
+#pragma once
+#include <vector>
+#include <unordered_map>
+#include <memory>
+#include <GLM/glm.hpp>
+#include <VertexArrayObject.h>
+#include <ShaderMaterial.h>
+#include <Resources.h>
+#include "Graphics/UniformRing.h"
+
+//Per-instance data, read by vertex_shader_instanced.glsl
+//*std430 layout, matches InstanceData in the shader
+struct InstanceData
+{
+	glm::mat4 World;
+	//World matrix from last frame, for motion vectors
+	glm::mat4 PrevWorld;
+	//std430 stores each column of a mat3 as a vec4
+	glm::vec4 NormalMatrix[3];
+};
+
+//Layout glMultiDrawElementsIndirect reads its commands in
+struct DrawElementsIndirectCommand
+{
+	GLuint Count;
+	GLuint InstanceCount;
+	GLuint FirstIndex;
+	GLint BaseVertex;
+	GLuint BaseInstance;
+};
+
+//A run of objects that share a mesh and material
+//*One command in the multi-draw
+//*The pointers are only good for the frame, Resources owns what they point at
+struct InstanceBatch
+{
+	MeshHandle MeshId;
+	MaterialHandle MaterialId;
+	VertexArrayObject* Mesh = nullptr;
+	ShaderMaterial* Material = nullptr;
+	//First instance in the instance buffer and how many there are
+	unsigned First = 0;
+	unsigned Count = 0;
+};
+
+//A run of batches that share a material and geometry arena
+//*Drawn with one glMultiDrawElementsIndirect call
+struct InstanceBucket
+{
+	ShaderMaterial* Material = nullptr;
+	//VAO of the arena all the meshes live in, nullptr if they have their own buffers
+	VertexArrayObject* ArenaVAO = nullptr;
+	//Batches (and commands, they line up) in this bucket
+	unsigned FirstBatch = 0;
+	unsigned BatchCount = 0;
+};
+
+//Groups objects into batches of the same mesh and material, and batches into multi-draw buckets
+//*Objects have to be added sorted so matching ones sit next to each other
+//*All the instance data for the frame goes into one storage buffer, the shader finds its instance through gl_DrawID
+class InstanceBatcher
+{
+public:
+	InstanceBatcher();
+	~InstanceBatcher();
+
+	//Creates the instance, draw and command buffers
+	void Init();
+	//Deletes the buffers
+	void Unload();
+
+	//Clears last frame's batches
+	void Begin();
+	//Adds an object, joins the last batch if the mesh and material match
+	void Add(MeshHandle mesh, MaterialHandle material, const glm::mat4& world,
+		const glm::mat4& prevWorld, const glm::mat3& normalMatrix);
+	//Builds the buckets and uploads this frame's instances, draws and commands
+	void End();
+
+	//Draws a bucket with whatever shader is bound
+	//*Shaders without the instance buffer fall back to one draw per object, with the transforms pushed into the ring
+	void Render(const InstanceBucket& bucket, Shader* shader, UniformRing& ring, const glm::mat4& viewProjection);
+
+	//Does this shader read its transforms from the instance buffer
+	bool IsInstanced(const Shader* shader);
+
+	//Getters
+	const std::vector<InstanceBatch>& GetBatches() const;
+	const std::vector<InstanceBucket>& GetBuckets() const;
+	unsigned GetInstanceCount() const;
+	//Draw calls made since Begin
+	unsigned GetDrawCount() const;
+private:
+	//Storage buffer binding points the instanced shaders use
+	static const GLuint INSTANCE_BUFFER_BINDING = 2;
+	static const GLuint DRAW_BUFFER_BINDING = 3;
+
+	GLuint _instanceBuffer = GL_NONE;
+	//First instance of each batch, indexed by gl_DrawID
+	GLuint _drawBuffer = GL_NONE;
+	GLuint _commandBuffer = GL_NONE;
+
+	std::vector<InstanceData> _instances;
+	std::vector<GLuint> _draws;
+	std::vector<DrawElementsIndirectCommand> _commands;
+	std::vector<InstanceBatch> _batches;
+	std::vector<InstanceBucket> _buckets;
+
+	//Whether each shader has the instance buffer
+	//*Keyed on the shader object, GL hands out a deleted program's handle again (ex: a rebuilt variant)
+	//*The weak pointer tells us the shader at that address is still the one we asked
+	struct InstancedShader
+	{
+		std::weak_ptr<const Shader> Owner;
+		bool Instanced;
+	};
+	std::unordered_map<const Shader*, InstancedShader> _instancedShaders;
+
+	unsigned _drawCount = 0;
+};
@@ -1,4 +1,5 @@
 #include "LUT.h"
+#include <GLState.h>
 #pragma warning(disable : 4996)
 LUT3D::LUT3D()
 {
@@ -10,6 +11,22 @@ LUT3D::LUT3D(std::string path)
 }
 
 void LUT3D::loadFromFile(std::string path)
+{
+	loadData(path);
+
+	//DSA so we don't disturb whatever is bound on the active texture unit
+	glCreateTextures(GL_TEXTURE_3D, 1, &_handle);
+	glTextureParameteri(_handle, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTextureParameteri(_handle, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTextureParameteri(_handle, GL_TEXTURE_WRAP_S, GL_REPEAT);
+	glTextureParameteri(_handle, GL_TEXTURE_WRAP_T, GL_REPEAT);
+	glTextureParameteri(_handle, GL_TEXTURE_WRAP_R, GL_REPEAT);
+
+	glTextureStorage3D(_handle, 1, GL_RGB8, 64, 64, 64);
+	glTextureSubImage3D(_handle, 0, 0, 0, 0, 64, 64, 64, GL_RGB, GL_FLOAT, &data[0]);
+}
+
+void LUT3D::loadData(std::string path)
 {
 	std::string filePath = path;
 	std::ifstream LUTstream;
@@ -27,41 +44,19 @@ void LUT3D::loadFromFile(std::string path)
 		if (sscanf(_line.c_str(), "%f %f %f", &lineData.x, &lineData.y, &lineData.z) == 3)
 			data.push_back(lineData);
 	}
-
-	glEnable(GL_TEXTURE_3D);
-
-	glGenTextures(1, &_handle);
-	bind();
-	glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-	glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-	glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-	glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-	glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_R, GL_REPEAT);
-
-	glTexImage3D(GL_TEXTURE_3D, 0, GL_RGB, 64, 64, 64, 0, GL_RGB, GL_FLOAT, &data[0]);
-	unbind();
-
-	glDisable(GL_TEXTURE_3D);
-}
-
-void LUT3D::bind()
-{
-	glBindTexture(GL_TEXTURE_3D, _handle);
 }
 
-void LUT3D::unbind()
+const std::vector<glm::vec3>& LUT3D::getData() const
 {
-	glBindTexture(GL_TEXTURE_3D, GL_NONE);
+	return data;
 }
 
 void LUT3D::bind(int textureSlot)
 {
-	glActiveTexture(GL_TEXTURE0 + textureSlot);
-	bind();
+	GLState::BindTexture(textureSlot, _handle);
 }
 
 void LUT3D::unbind(int textureSlot)
 {
-	glActiveTexture(GL_TEXTURE0 + textureSlot);
-	unbind();
+	GLState::BindTexture(textureSlot, GL_NONE);
 }
\ No newline at end of file
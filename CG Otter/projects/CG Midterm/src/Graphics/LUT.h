@@ -11,8 +11,9 @@ public:
 	LUT3D();
 	LUT3D(std::string path);
 	void loadFromFile(std::string path);
-	void bind();
-	void unbind();
+	//Only reads the cube file, doesn't touch OpenGL
+	void loadData(std::string path);
+	const std::vector<glm::vec3>& getData() const;
 
 	void bind(int textureSlot);
 	void unbind(int textureSlot);
@@ -0,0 +1,44 @@
+#pragma once
+#include <vector>
+#include <GLM/glm.hpp>
+#include <VertexArrayObject.h>
+
+//Simplified stand in for a mesh that the occlusion culler draws instead of the real thing
+//*Has to sit inside the real mesh, anything poking out can hide objects that are actually visible
+//*Vertices are in the same local space as the mesh, so the entity's transform applies to both
+class OccluderComponent
+{
+public:
+	std::vector<glm::vec3> Vertices;
+	std::vector<unsigned> Indices;
+
+	//Builds a box from a mesh's bounds, shrunk towards the center by scale
+	//*A scale of 1 is only safe for meshes that fill their bounds, like a plane or a crate
+	static OccluderComponent FromBounds(const VertexArrayObject::sptr& mesh, const glm::vec3& scale = glm::vec3(1.0f))
+	{
+		OccluderComponent result;
+		if (mesh == nullptr || !mesh->HasBounds())
+			return result;
+
+		glm::vec3 center = (mesh->GetBoundsMin() + mesh->GetBoundsMax()) * 0.5f;
+		glm::vec3 extent = (mesh->GetBoundsMax() - mesh->GetBoundsMin()) * 0.5f * scale;
+
+		//Corner i has bit 0 for x, 1 for y, 2 for z
+		for (int i = 0; i < 8; i++)
+		{
+			glm::vec3 sign = glm::vec3(i & 1 ? 1.0f : -1.0f, i & 2 ? 1.0f : -1.0f, i & 4 ? 1.0f : -1.0f);
+			result.Vertices.push_back(center + extent * sign);
+		}
+
+		//Two triangles per face, the culler draws both sides so winding doesn't matter
+		result.Indices = {
+			0, 1, 3,  0, 3, 2, //-z
+			4, 5, 7,  4, 7, 6, //+z
+			0, 1, 5,  0, 5, 4, //-y
+			2, 3, 7,  2, 7, 6, //+y
+			0, 2, 6,  0, 6, 4, //-x
+			1, 3, 7,  1, 7, 5  //+x
+		};
+		return result;
+	}
+};
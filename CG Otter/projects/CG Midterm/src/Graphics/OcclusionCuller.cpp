@@ -0,0 +1,293 @@
+#include "OcclusionCuller.h"
+#include <algorithm>
+#include <cfloat>
+#include <emmintrin.h>
+
+OcclusionCuller::OcclusionCuller()
+{
+	_depth.resize(WIDTH * HEIGHT, 1.0f);
+	_tileMax.resize(TILES_X * TILES_Y, 1.0f);
+}
+
+OcclusionCuller::~OcclusionCuller()
+{
+}
+
+void OcclusionCuller::Begin(const glm::mat4& viewProjection)
+{
+	_viewProjection = viewProjection;
+
+	//Everything starts out at the far plane
+	std::fill(_depth.begin(), _depth.end(), 1.0f);
+	std::fill(_tileMax.begin(), _tileMax.end(), 1.0f);
+
+	_triangles.clear();
+	for (std::vector<unsigned>& bin : _bins)
+	{
+		bin.clear();
+	}
+
+	_testedCount = 0;
+	_occludedCount = 0;
+}
+
+void OcclusionCuller::AddOccluder(const OccluderComponent& occluder, const glm::mat4& world)
+{
+	glm::mat4 mvp = _viewProjection * world;
+
+	_clip.resize(occluder.Vertices.size());
+	for (size_t i = 0; i < occluder.Vertices.size(); i++)
+	{
+		_clip[i] = mvp * glm::vec4(occluder.Vertices[i], 1.0f);
+	}
+
+	for (size_t i = 0; i + 2 < occluder.Indices.size(); i += 3)
+	{
+		//Clip against the near plane (z >= -w), a triangle can come out as up to 4 points
+		glm::vec4 polygon[4];
+		int count = 0;
+		for (int v = 0; v < 3; v++)
+		{
+			const glm::vec4& a = _clip[occluder.Indices[i + v]];
+			const glm::vec4& b = _clip[occluder.Indices[i + (v + 1) % 3]];
+			float distanceA = a.z + a.w;
+			float distanceB = b.z + b.w;
+
+			if (distanceA >= 0.0f)
+			{
+				polygon[count++] = a;
+			}
+			if ((distanceA >= 0.0f) != (distanceB >= 0.0f))
+			{
+				polygon[count++] = glm::mix(a, b, distanceA / (distanceA - distanceB));
+			}
+		}
+
+		//Fan the clipped polygon back out into triangles
+		for (int v = 1; v + 1 < count; v++)
+		{
+			BinTriangle(polygon[0], polygon[v], polygon[v + 1]);
+		}
+	}
+}
+
+void OcclusionCuller::BinTriangle(const glm::vec4& a, const glm::vec4& b, const glm::vec4& c)
+{
+	Triangle triangle;
+	const glm::vec4* clip[3] = { &a, &b, &c };
+	for (int v = 0; v < 3; v++)
+	{
+		glm::vec3 ndc = glm::vec3(*clip[v]) / clip[v]->w;
+		triangle.V[v] = glm::vec3((ndc.x * 0.5f + 0.5f) * WIDTH, (ndc.y * 0.5f + 0.5f) * HEIGHT, ndc.z * 0.5f + 0.5f);
+	}
+
+	//Flip anything clockwise so the edge functions are positive inside
+	glm::vec3* V = triangle.V;
+	float area = (V[1].x - V[0].x) * (V[2].y - V[0].y) - (V[1].y - V[0].y) * (V[2].x - V[0].x);
+	if (glm::abs(area) < 1e-6f)
+		return;
+	if (area < 0.0f)
+	{
+		std::swap(V[1], V[2]);
+	}
+
+	int minX = glm::max(0, int(glm::floor(glm::min(glm::min(V[0].x, V[1].x), V[2].x))));
+	int maxX = glm::min(WIDTH, int(glm::ceil(glm::max(glm::max(V[0].x, V[1].x), V[2].x))));
+	int minY = glm::max(0, int(glm::floor(glm::min(glm::min(V[0].y, V[1].y), V[2].y))));
+	int maxY = glm::min(HEIGHT, int(glm::ceil(glm::max(glm::max(V[0].y, V[1].y), V[2].y))));
+	if (minX >= maxX || minY >= maxY)
+		return;
+
+	unsigned index = unsigned(_triangles.size());
+	_triangles.push_back(triangle);
+
+	for (int ty = minY / TILE_HEIGHT; ty <= (maxY - 1) / TILE_HEIGHT; ty++)
+	{
+		for (int tx = minX / TILE_WIDTH; tx <= (maxX - 1) / TILE_WIDTH; tx++)
+		{
+			_bins[ty * TILES_X + tx].push_back(index);
+		}
+	}
+}
+
+void OcclusionCuller::Rasterize(JobSystem& jobs)
+{
+	jobs.ParallelFor(TILES_X * TILES_Y, 1, [&](unsigned begin, unsigned end) {
+		for (unsigned tile = begin; tile < end; tile++)
+		{
+			RasterizeTile(int(tile));
+		}
+	});
+}
+
+bool OcclusionCuller::TestBox(const glm::vec3& min, const glm::vec3& max)
+{
+	_testedCount++;
+
+	glm::vec2 screenMin = glm::vec2(FLT_MAX);
+	glm::vec2 screenMax = glm::vec2(-FLT_MAX);
+	float nearest = FLT_MAX;
+	for (int i = 0; i < 8; i++)
+	{
+		glm::vec3 corner = glm::vec3(i & 1 ? max.x : min.x, i & 2 ? max.y : min.y, i & 4 ? max.z : min.z);
+		glm::vec4 clip = _viewProjection * glm::vec4(corner, 1.0f);
+		//Box crosses the near plane, the camera is basically inside it
+		if (clip.w <= 0.0f || clip.z < -clip.w)
+			return true;
+
+		glm::vec3 ndc = glm::vec3(clip) / clip.w;
+		glm::vec2 screen = glm::vec2((ndc.x * 0.5f + 0.5f) * WIDTH, (ndc.y * 0.5f + 0.5f) * HEIGHT);
+		screenMin = glm::min(screenMin, screen);
+		screenMax = glm::max(screenMax, screen);
+		nearest = glm::min(nearest, ndc.z * 0.5f + 0.5f);
+	}
+
+	int minX = glm::max(0, int(glm::floor(screenMin.x)));
+	int maxX = glm::min(WIDTH, int(glm::ceil(screenMax.x)));
+	int minY = glm::max(0, int(glm::floor(screenMin.y)));
+	int maxY = glm::min(HEIGHT, int(glm::ceil(screenMax.y)));
+	//Off screen, that's the frustum culler's call
+	if (minX >= maxX || minY >= maxY)
+		return true;
+
+	const __m128 nearestDepth = _mm_set1_ps(nearest);
+	const __m128i laneOffsets = _mm_set_epi32(3, 2, 1, 0);
+	const __m128i firstColumn = _mm_set1_epi32(minX - 1);
+	const __m128i lastColumn = _mm_set1_epi32(maxX);
+
+	for (int ty = minY / TILE_HEIGHT; ty <= (maxY - 1) / TILE_HEIGHT; ty++)
+	{
+		for (int tx = minX / TILE_WIDTH; tx <= (maxX - 1) / TILE_WIDTH; tx++)
+		{
+			//Box is behind the farthest thing in this tile, no need to look closer
+			if (nearest > _tileMax[ty * TILES_X + tx])
+				continue;
+
+			int startX = glm::max(minX, tx * TILE_WIDTH) & ~3;
+			int endX = glm::min(maxX, (tx + 1) * TILE_WIDTH);
+			int startY = glm::max(minY, ty * TILE_HEIGHT);
+			int endY = glm::min(maxY, (ty + 1) * TILE_HEIGHT);
+
+			for (int y = startY; y < endY; y++)
+			{
+				const float* row = &_depth[y * WIDTH];
+				for (int x = startX; x < endX; x += 4)
+				{
+					//Mask off lanes that fall outside the box's columns
+					__m128i columns = _mm_add_epi32(_mm_set1_epi32(x), laneOffsets);
+					__m128 inRange = _mm_castsi128_ps(_mm_and_si128(_mm_cmpgt_epi32(columns, firstColumn), _mm_cmplt_epi32(columns, lastColumn)));
+
+					__m128 inFront = _mm_cmple_ps(nearestDepth, _mm_loadu_ps(row + x));
+					if (_mm_movemask_ps(_mm_and_ps(inFront, inRange)))
+						return true;
+				}
+			}
+		}
+	}
+
+	_occludedCount++;
+	return false;
+}
+
+unsigned OcclusionCuller::GetTriangleCount() const
+{
+	return unsigned(_triangles.size());
+}
+
+unsigned OcclusionCuller::GetTestedCount() const
+{
+	return _testedCount;
+}
+
+unsigned OcclusionCuller::GetOccludedCount() const
+{
+	return _occludedCount;
+}
+
+const std::vector<float>& OcclusionCuller::GetDepthBuffer() const
+{
+	return _depth;
+}
+
+void OcclusionCuller::RasterizeTile(int tile)
+{
+	int tileX = (tile % TILES_X) * TILE_WIDTH;
+	int tileY = (tile / TILES_X) * TILE_HEIGHT;
+
+	const __m128 laneOffsets = _mm_set_ps(3.0f, 2.0f, 1.0f, 0.0f);
+	const __m128 zero = _mm_setzero_ps();
+
+	for (unsigned index : _bins[tile])
+	{
+		const glm::vec3* V = _triangles[index].V;
+
+		//Clip the triangle's bounds to the tile, x gets snapped out to whole SSE lanes
+		int minX = glm::max(tileX, int(glm::floor(glm::min(glm::min(V[0].x, V[1].x), V[2].x)))) & ~3;
+		int maxX = glm::min(tileX + TILE_WIDTH, (int(glm::ceil(glm::max(glm::max(V[0].x, V[1].x), V[2].x))) + 3) & ~3);
+		int minY = glm::max(tileY, int(glm::floor(glm::min(glm::min(V[0].y, V[1].y), V[2].y))));
+		int maxY = glm::min(tileY + TILE_HEIGHT, int(glm::ceil(glm::max(glm::max(V[0].y, V[1].y), V[2].y))));
+		if (minX >= maxX || minY >= maxY)
+			continue;
+
+		//Edge i is opposite vertex i, so edge i over the area is vertex i's barycentric weight
+		float area = (V[1].x - V[0].x) * (V[2].y - V[0].y) - (V[1].y - V[0].y) * (V[2].x - V[0].x);
+		__m128 invArea = _mm_set1_ps(1.0f / area);
+		float stepX[3], stepY[3], start[3];
+		float originX = minX + 0.5f;
+		float originY = minY + 0.5f;
+		for (int i = 0; i < 3; i++)
+		{
+			const glm::vec3& a = V[(i + 1) % 3];
+			const glm::vec3& b = V[(i + 2) % 3];
+			stepX[i] = -(b.y - a.y);
+			stepY[i] = b.x - a.x;
+			start[i] = (b.x - a.x) * (originY - a.y) - (b.y - a.y) * (originX - a.x);
+		}
+
+		__m128 z0 = _mm_set1_ps(V[0].z);
+		__m128 z1 = _mm_set1_ps(V[1].z);
+		__m128 z2 = _mm_set1_ps(V[2].z);
+		__m128 step0 = _mm_set1_ps(stepX[0] * 4.0f);
+		__m128 step1 = _mm_set1_ps(stepX[1] * 4.0f);
+		__m128 step2 = _mm_set1_ps(stepX[2] * 4.0f);
+
+		for (int y = minY; y < maxY; y++)
+		{
+			float rowOffset = float(y - minY);
+			__m128 e0 = _mm_add_ps(_mm_set1_ps(start[0] + stepY[0] * rowOffset), _mm_mul_ps(_mm_set1_ps(stepX[0]), laneOffsets));
+			__m128 e1 = _mm_add_ps(_mm_set1_ps(start[1] + stepY[1] * rowOffset), _mm_mul_ps(_mm_set1_ps(stepX[1]), laneOffsets));
+			__m128 e2 = _mm_add_ps(_mm_set1_ps(start[2] + stepY[2] * rowOffset), _mm_mul_ps(_mm_set1_ps(stepX[2]), laneOffsets));
+
+			float* row = &_depth[y * WIDTH];
+			for (int x = minX; x < maxX; x += 4)
+			{
+				__m128 inside = _mm_and_ps(_mm_and_ps(_mm_cmpge_ps(e0, zero), _mm_cmpge_ps(e1, zero)), _mm_cmpge_ps(e2, zero));
+				if (_mm_movemask_ps(inside))
+				{
+					__m128 z = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(e0, z0), _mm_mul_ps(e1, z1)), _mm_mul_ps(e2, z2)), invArea);
+					__m128 depth = _mm_loadu_ps(row + x);
+					__m128 nearer = _mm_min_ps(depth, z);
+					_mm_storeu_ps(row + x, _mm_or_ps(_mm_and_ps(inside, nearer), _mm_andnot_ps(inside, depth)));
+				}
+
+				e0 = _mm_add_ps(e0, step0);
+				e1 = _mm_add_ps(e1, step1);
+				e2 = _mm_add_ps(e2, step2);
+			}
+		}
+	}
+
+	//Farthest depth left in the tile, lets the box test skip whole tiles
+	__m128 farthest = _mm_setzero_ps();
+	for (int y = tileY; y < tileY + TILE_HEIGHT; y++)
+	{
+		const float* row = &_depth[y * WIDTH];
+		for (int x = tileX; x < tileX + TILE_WIDTH; x += 4)
+		{
+			farthest = _mm_max_ps(farthest, _mm_loadu_ps(row + x));
+		}
+	}
+	float lanes[4];
+	_mm_storeu_ps(lanes, farthest);
+	_tileMax[tile] = glm::max(glm::max(lanes[0], lanes[1]), glm::max(lanes[2], lanes[3]));
+}
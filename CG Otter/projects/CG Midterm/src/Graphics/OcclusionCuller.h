@@ -0,0 +1,66 @@
+#pragma once
+#include <vector>
+#include <GLM/glm.hpp>
+#include "Graphics/OccluderComponent.h"
+#include <JobSystem.h>
+
+//Software occlusion culling on the CPU
+//*Occluders get rasterized into a small depth buffer, then bounding boxes are tested against it
+//*Triangles are binned into screen tiles first so each worker thread owns whole tiles and never shares pixels
+//*Rasterizing and testing both go 4 pixels at a time with SSE
+//*Every tile keeps its farthest depth too, so most tests never have to look at single pixels
+class OcclusionCuller
+{
+public:
+	OcclusionCuller();
+	~OcclusionCuller();
+
+	//Clears the depth buffer and bins for a new frame
+	void Begin(const glm::mat4& viewProjection);
+	//Transforms an occluder, clips it to the near plane and drops its triangles into the tiles they touch
+	void AddOccluder(const OccluderComponent& occluder, const glm::mat4& world);
+	//Rasterizes every binned triangle, one tile per task
+	void Rasterize(JobSystem& jobs);
+
+	//Is any part of the world space box in front of the depth buffer
+	bool TestBox(const glm::vec3& min, const glm::vec3& max);
+
+	//Getters
+	unsigned GetTriangleCount() const;
+	unsigned GetTestedCount() const;
+	unsigned GetOccludedCount() const;
+	const std::vector<float>& GetDepthBuffer() const;
+
+	//Depth buffer size, has to be a whole number of tiles
+	static const int WIDTH = 256;
+	static const int HEIGHT = 128;
+	//Tile size, the width has to be a multiple of 4 for the SSE lanes
+	static const int TILE_WIDTH = 64;
+	static const int TILE_HEIGHT = 32;
+	static const int TILES_X = WIDTH / TILE_WIDTH;
+	static const int TILES_Y = HEIGHT / TILE_HEIGHT;
+private:
+	//Screen space triangle, x and y in pixels and z in 0 to 1, always counter clockwise
+	struct Triangle
+	{
+		glm::vec3 V[3];
+	};
+
+	//Projects a clip space triangle to the screen and adds it to every tile its bounds touch
+	void BinTriangle(const glm::vec4& a, const glm::vec4& b, const glm::vec4& c);
+	//Rasterizes one tile's bin and works out its farthest depth
+	void RasterizeTile(int tile);
+
+	glm::mat4 _viewProjection = glm::mat4(1.0f);
+
+	std::vector<float> _depth;
+	std::vector<float> _tileMax;
+
+	std::vector<Triangle> _triangles;
+	std::vector<unsigned> _bins[TILES_X * TILES_Y];
+	//Clip space scratch for the occluder being added
+	std::vector<glm::vec4> _clip;
+
+	unsigned _testedCount = 0;
+	unsigned _occludedCount = 0;
+};
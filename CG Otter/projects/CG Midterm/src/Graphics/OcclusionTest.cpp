@@ -0,0 +1,69 @@
+#include "OcclusionTest.h"
+#include "Graphics/OcclusionCuller.h"
+#include <GLM/gtc/matrix_transform.hpp>
+#include <cstdio>
+
+int OcclusionTest::Run()
+{
+	//Camera at the origin looking down -z, same aspect as the depth buffer so nothing gets stretched
+	glm::mat4 projection = glm::perspective(glm::radians(90.0f), float(OcclusionCuller::WIDTH) / float(OcclusionCuller::HEIGHT), 0.1f, 100.0f);
+	glm::mat4 view = glm::mat4(1.0f);
+
+	//4x4 quad facing the camera, 5 units out
+	OccluderComponent quad;
+	quad.Vertices = {
+		glm::vec3(-2.0f, -2.0f, -5.0f),
+		glm::vec3( 2.0f, -2.0f, -5.0f),
+		glm::vec3( 2.0f,  2.0f, -5.0f),
+		glm::vec3(-2.0f,  2.0f, -5.0f)
+	};
+	quad.Indices = { 0, 1, 2,  0, 2, 3 };
+
+	//A few workers so the tiles really do get split up
+	JobSystem jobs(3);
+	OcclusionCuller culler;
+	int failed = 0;
+
+	printf("Occlusion test: %dx%d depth buffer, %u threads\n", OcclusionCuller::WIDTH, OcclusionCuller::HEIGHT, jobs.GetThreadCount());
+
+	//Nothing rasterized yet, so even a box that'll end up behind the quad has to be visible
+	culler.Begin(projection * view);
+	culler.Rasterize(jobs);
+	failed += Check(culler, "behind, no occluders", glm::vec3(-0.5f, -0.5f, -10.0f), glm::vec3(0.5f, 0.5f, -9.0f), true) ? 0 : 1;
+
+	culler.Begin(projection * view);
+	culler.AddOccluder(quad, glm::mat4(1.0f));
+	culler.Rasterize(jobs);
+
+	if (culler.GetTriangleCount() != 2)
+	{
+		printf("FAIL triangle count: %u, expected 2\n", culler.GetTriangleCount());
+		failed++;
+	}
+
+	failed += Check(culler, "behind", glm::vec3(-0.5f, -0.5f, -10.0f), glm::vec3(0.5f, 0.5f, -9.0f), false) ? 0 : 1;
+	failed += Check(culler, "in front", glm::vec3(-0.5f, -0.5f, -3.0f), glm::vec3(0.5f, 0.5f, -2.0f), true) ? 0 : 1;
+	failed += Check(culler, "touching the front", glm::vec3(-0.5f, -0.5f, -5.0f), glm::vec3(0.5f, 0.5f, -4.0f), true) ? 0 : 1;
+	failed += Check(culler, "beside", glm::vec3(6.0f, -0.5f, -10.0f), glm::vec3(7.0f, 0.5f, -9.0f), true) ? 0 : 1;
+	failed += Check(culler, "behind, poking out the side", glm::vec3(1.0f, -0.5f, -10.0f), glm::vec3(6.0f, 0.5f, -9.0f), true) ? 0 : 1;
+	failed += Check(culler, "crossing the near plane", glm::vec3(-0.5f, -0.5f, -10.0f), glm::vec3(0.5f, 0.5f, 1.0f), true) ? 0 : 1;
+
+	//Only the box that really is hidden should have been counted
+	if (culler.GetOccludedCount() != 1)
+	{
+		printf("FAIL occluded count: %u, expected 1\n", culler.GetOccludedCount());
+		failed++;
+	}
+
+	printf(failed == 0 ? "All occlusion cases passed\n" : "%d occlusion cases failed\n", failed);
+	return failed;
+}
+
+bool OcclusionTest::Check(OcclusionCuller& culler, const std::string& name, const glm::vec3& min, const glm::vec3& max, bool expectVisible)
+{
+	bool visible = culler.TestBox(min, max);
+	bool passed = visible == expectVisible;
+	printf("%s %s: %s, expected %s\n", passed ? "PASS" : "FAIL", name.c_str(),
+		visible ? "visible" : "occluded", expectVisible ? "visible" : "occluded");
+	return passed;
+}
@@ -0,0 +1,19 @@
+#pragma once
+#include <string>
+#include <GLM/glm.hpp>
+
+class OcclusionCuller;
+
+//Headless check of the software occlusion culler
+//*Rasterizes one known occluder quad and asserts what TestBox says about boxes around it
+//*Needs no window or GPU, start the exe with --occlusion-test
+class OcclusionTest
+{
+public:
+	//Runs every case and prints the results to the console
+	//*Returns the number of cases that failed, so it can be used straight as the exit code
+	static int Run();
+private:
+	//Tests one box and prints whether it got the answer we expected
+	static bool Check(OcclusionCuller& culler, const std::string& name, const glm::vec3& min, const glm::vec3& max, bool expectVisible);
+};
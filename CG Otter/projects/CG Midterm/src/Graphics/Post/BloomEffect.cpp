@@ -1,5 +1,9 @@
 #include "BloomEffect.h"
 
+//Uniforms set every frame, hashed at compile time
+static constexpr UniformId u_threshold("u_threshold");
+static constexpr UniformId u_direction("u_direction");
+
 void BloomEffect::Init(unsigned width, unsigned height)
 {
 	int index = int(_buffers.size());
@@ -27,45 +31,15 @@ void BloomEffect::Init(unsigned width, unsigned height)
 	_buffers[index]->AddColorTarget(GL_RGBA8);
 	_buffers[index]->Init(width, height);
 
-	//loads shaders
-	index = int(_shaders.size());
-
-	_shaders.push_back(Shader::Create());
-	_shaders[index]->LoadShaderPartFromFile("shaders/passthrough_vert.glsl", GL_VERTEX_SHADER);
-	_shaders[index]->LoadShaderPartFromFile("shaders/passthrough_frag.glsl", GL_FRAGMENT_SHADER);
-	_shaders[index]->Link();
-
-	index++;
-
-	_shaders.push_back(Shader::Create());
-	_shaders[index]->LoadShaderPartFromFile("shaders/passthrough_vert.glsl", GL_VERTEX_SHADER);
-	_shaders[index]->LoadShaderPartFromFile("shaders/Post/bloom_frag.glsl", GL_FRAGMENT_SHADER);
-	_shaders[index]->Link();
-
-	index++;
-
-	_shaders.push_back(Shader::Create());
-	_shaders[index]->LoadShaderPartFromFile("shaders/passthrough_vert.glsl", GL_VERTEX_SHADER);
-	_shaders[index]->LoadShaderPartFromFile("shaders/Post/blur_horizontal_frag.glsl", GL_FRAGMENT_SHADER);
-	_shaders[index]->Link();
-
-	index++;
-
-	_shaders.push_back(Shader::Create());
-	_shaders[index]->LoadShaderPartFromFile("shaders/passthrough_vert.glsl", GL_VERTEX_SHADER);
-	_shaders[index]->LoadShaderPartFromFile("shaders/Post/blur_vertical_frag.glsl", GL_FRAGMENT_SHADER);
-	_shaders[index]->Link();
-
-	index++;
-
-	_shaders.push_back(Shader::Create());
-	_shaders[index]->LoadShaderPartFromFile("shaders/passthrough_vert.glsl", GL_VERTEX_SHADER);
-	_shaders[index]->LoadShaderPartFromFile("shaders/Post/bloom_composite_frag.glsl", GL_FRAGMENT_SHADER);
-	_shaders[index]->Link();
-
-	index++;
+	//loads shaders, the library shares passthrough_vert.glsl between all of them
+	_shaders.push_back(ShaderLibrary::LoadFromFiles("shaders/passthrough_vert.glsl", "shaders/passthrough_frag.glsl"));
+	_shaders.push_back(ShaderLibrary::LoadFromFiles("shaders/passthrough_vert.glsl", "shaders/Post/bloom_frag.glsl"));
+	_shaders.push_back(ShaderLibrary::LoadFromFiles("shaders/passthrough_vert.glsl", "shaders/Post/blur_horizontal_frag.glsl"));
+	_shaders.push_back(ShaderLibrary::LoadFromFiles("shaders/passthrough_vert.glsl", "shaders/Post/blur_vertical_frag.glsl"));
+	_shaders.push_back(ShaderLibrary::LoadFromFiles("shaders/passthrough_vert.glsl", "shaders/Post/bloom_composite_frag.glsl"));
 
-	direction = glm::vec2(1.0f / width, 1.0f / height);
+	//One texel of the downscaled buffers we blur in
+	direction = glm::vec2(1.0f / _buffers[1]->_width, 1.0f / _buffers[1]->_height);
 }
 
 void BloomEffect::ApplyEffect(PostEffect* buffer)
@@ -81,7 +55,7 @@ void BloomEffect::ApplyEffect(PostEffect* buffer)
 	UnbindShader();
 
 	BindShader(1);
-	_shaders[1]->SetUniform("u_threshold", m_threshold);
+	_shaders[1]->SetUniform(u_threshold, m_threshold);
 
 	BindColorAsTexture(0, 0, 0);
 
@@ -95,7 +69,7 @@ void BloomEffect::ApplyEffect(PostEffect* buffer)
 	{
 		//Horizontal
 		BindShader(2);
-		_shaders[2]->SetUniform("u_direction", direction.x);
+		_shaders[2]->SetUniform(u_direction, direction.x);
 
 		BindColorAsTexture(1, 0, 0);
 
@@ -107,7 +81,7 @@ void BloomEffect::ApplyEffect(PostEffect* buffer)
 
 		//Vertical
 		BindShader(3);
-		_shaders[3]->SetUniform("u_direction", direction.y);
+		_shaders[3]->SetUniform(u_direction, direction.y);
 
 		BindColorAsTexture(2, 0, 0);
 
@@ -130,6 +104,16 @@ void BloomEffect::ApplyEffect(PostEffect* buffer)
 	UnbindShader();
 }
 
+void BloomEffect::Reshape(unsigned width, unsigned height)
+{
+	_buffers[0]->Reshape(width, height);
+	_buffers[1]->Reshape(unsigned(width / m_downscale), unsigned(height / m_downscale));
+	_buffers[2]->Reshape(unsigned(width / m_downscale), unsigned(height / m_downscale));
+	_buffers[3]->Reshape(width, height);
+
+	direction = glm::vec2(1.0f / _buffers[1]->_width, 1.0f / _buffers[1]->_height);
+}
+
 float BloomEffect::Getdownscale() const
 {
 	return m_downscale;
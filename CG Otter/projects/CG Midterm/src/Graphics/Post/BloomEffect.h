@@ -9,6 +9,9 @@ public:
 
 	void ApplyEffect(PostEffect* buffer) override;
 
+	//Keeps the blur buffers downscaled
+	void Reshape(unsigned width, unsigned height) override;
+
 	float Getdownscale() const;
 	float Getthreshold() const;
 	unsigned Getpassthrough() const;
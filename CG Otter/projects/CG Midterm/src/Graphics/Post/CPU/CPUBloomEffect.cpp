@@ -0,0 +1,74 @@
+#include "CPUBloomEffect.h"
+#include <algorithm>
+
+void CPUBloomEffect::ApplyEffect(const CPUImage& in, CPUImage& out, JobSystem& jobs)
+{
+	unsigned width = in.GetWidth();
+	unsigned height = in.GetHeight();
+	unsigned smallWidth = std::max(1u, unsigned(width / m_downscale));
+	unsigned smallHeight = std::max(1u, unsigned(height / m_downscale));
+
+	_scene.Resize(width, height);
+	_bright.Resize(smallWidth, smallHeight);
+	_blurred.Resize(smallWidth, smallHeight);
+	out.Resize(width, height);
+
+	//Passthrough into our own buffer first, just like the GPU version
+	jobs.ParallelFor(height, ROWS_PER_TILE, [&](unsigned begin, unsigned end) {
+		CPUKernels::Copy(in, _scene, begin, end);
+	});
+	FinishPass(_scene, jobs);
+
+	jobs.ParallelFor(smallHeight, ROWS_PER_TILE, [&](unsigned begin, unsigned end) {
+		CPUKernels::Threshold(_scene, _bright, m_threshold, begin, end);
+	});
+	FinishPass(_bright, jobs);
+
+	for (unsigned i = 0; i < m_passthrough; i++)
+	{
+		jobs.ParallelFor(smallHeight, ROWS_PER_TILE, [&](unsigned begin, unsigned end) {
+			CPUKernels::BlurHorizontal(_bright, _blurred, begin, end);
+		});
+		FinishPass(_blurred, jobs);
+
+		jobs.ParallelFor(smallHeight, ROWS_PER_TILE, [&](unsigned begin, unsigned end) {
+			CPUKernels::BlurVertical(_blurred, _bright, begin, end);
+		});
+		FinishPass(_bright, jobs);
+	}
+
+	jobs.ParallelFor(height, ROWS_PER_TILE, [&](unsigned begin, unsigned end) {
+		CPUKernels::ScreenComposite(_scene, _bright, out, begin, end);
+	});
+	FinishPass(out, jobs);
+}
+
+float CPUBloomEffect::Getdownscale() const
+{
+	return m_downscale;
+}
+
+float CPUBloomEffect::Getthreshold() const
+{
+	return m_threshold;
+}
+
+unsigned CPUBloomEffect::Getpassthrough() const
+{
+	return m_passthrough;
+}
+
+void CPUBloomEffect::Setdownscale(float downscale)
+{
+	m_downscale = downscale;
+}
+
+void CPUBloomEffect::Setthreshold(float threshold)
+{
+	m_threshold = threshold;
+}
+
+void CPUBloomEffect::Setpassthrough(unsigned passthrough)
+{
+	m_passthrough = passthrough;
+}
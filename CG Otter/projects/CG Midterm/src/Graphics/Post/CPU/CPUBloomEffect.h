@@ -0,0 +1,28 @@
+#pragma once
+
+#include "Graphics/Post/CPU/CPUPostEffect.h"
+
+class CPUBloomEffect : public CPUPostEffect
+{
+public:
+	//Applies the effect from in to out
+	void ApplyEffect(const CPUImage& in, CPUImage& out, JobSystem& jobs) override;
+
+	float Getdownscale() const;
+	float Getthreshold() const;
+	unsigned Getpassthrough() const;
+
+	void Setdownscale(float downscale);
+	void Setthreshold(float threshold);
+	void Setpassthrough(unsigned passthrough);
+
+private:
+	//Same as the buffers in BloomEffect
+	CPUImage _scene;
+	CPUImage _bright;
+	CPUImage _blurred;
+
+	float m_downscale = 5.0f;
+	float m_threshold = 0.05f;
+	unsigned m_passthrough = 10;
+};
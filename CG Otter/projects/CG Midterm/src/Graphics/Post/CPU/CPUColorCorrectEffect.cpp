@@ -0,0 +1,29 @@
+#include "CPUColorCorrectEffect.h"
+#include <cmath>
+
+void CPUColorCorrectEffect::ApplyEffect(const CPUImage& in, CPUImage& out, JobSystem& jobs)
+{
+	out.Resize(in.GetWidth(), in.GetHeight());
+
+	jobs.ParallelFor(in.GetHeight(), ROWS_PER_TILE, [&](unsigned begin, unsigned end) {
+		if (_lutSize > 1)
+			CPUKernels::ColorCorrect(in, out, _lut, _lutSize, begin, end);
+		else
+			CPUKernels::Copy(in, out, begin, end);
+	});
+
+	FinishPass(out, jobs);
+}
+
+void CPUColorCorrectEffect::SetLUT(const LUT3D& cube)
+{
+	_lut = cube.getData();
+
+	//Cube files hold size^3 entries
+	_lutSize = unsigned(std::round(std::cbrt(double(_lut.size()))));
+	if (size_t(_lutSize) * _lutSize * _lutSize != _lut.size())
+	{
+		_lut.clear();
+		_lutSize = 0;
+	}
+}
@@ -0,0 +1,20 @@
+#pragma once
+
+#include "Graphics/Post/CPU/CPUPostEffect.h"
+#include "Graphics/LUT.h"
+
+class CPUColorCorrectEffect : public CPUPostEffect
+{
+public:
+	//Applies the effect from in to out
+	//*Does nothing but copy if there's no LUT
+	void ApplyEffect(const CPUImage& in, CPUImage& out, JobSystem& jobs) override;
+
+	//Setters
+	//*Only uses the LUT's data, works on a LUT loaded with loadData (no OpenGL)
+	void SetLUT(const LUT3D& cube);
+private:
+	std::vector<glm::vec3> _lut;
+	//Cube is _lutSize on each side
+	unsigned _lutSize = 0;
+};
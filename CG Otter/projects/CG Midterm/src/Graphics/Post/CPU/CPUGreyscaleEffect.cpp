@@ -0,0 +1,22 @@
+#include "CPUGreyscaleEffect.h"
+
+void CPUGreyscaleEffect::ApplyEffect(const CPUImage& in, CPUImage& out, JobSystem& jobs)
+{
+	out.Resize(in.GetWidth(), in.GetHeight());
+
+	jobs.ParallelFor(in.GetHeight(), ROWS_PER_TILE, [&](unsigned begin, unsigned end) {
+		CPUKernels::Greyscale(in, out, _intensity, begin, end);
+	});
+
+	FinishPass(out, jobs);
+}
+
+float CPUGreyscaleEffect::GetIntensity() const
+{
+	return _intensity;
+}
+
+void CPUGreyscaleEffect::SetIntensity(float intensity)
+{
+	_intensity = intensity;
+}
@@ -0,0 +1,101 @@
+#include "CPUImage.h"
+#include <stb_image.h>
+#include <stb_image_write.h>
+#include <algorithm>
+#include <cmath>
+
+CPUImage::CPUImage()
+{
+}
+
+CPUImage::CPUImage(unsigned width, unsigned height)
+{
+	Resize(width, height);
+}
+
+void CPUImage::Resize(unsigned width, unsigned height)
+{
+	_width = width;
+	_height = height;
+	_pixels.resize(size_t(width) * height * 4);
+}
+
+bool CPUImage::LoadFromFile(const std::string& path)
+{
+	int width, height, numChannels;
+	stbi_set_flip_vertically_on_load(true);
+	unsigned char* data = stbi_load(path.c_str(), &width, &height, &numChannels, 4);
+
+	if (data == nullptr)
+		return false;
+
+	Resize(width, height);
+	for (size_t i = 0; i < _pixels.size(); i++)
+	{
+		_pixels[i] = data[i] / 255.0f;
+	}
+
+	stbi_image_free(data);
+	return true;
+}
+
+bool CPUImage::SaveToFile(const std::string& path) const
+{
+	std::vector<unsigned char> data(_pixels.size());
+	for (size_t i = 0; i < _pixels.size(); i++)
+	{
+		data[i] = (unsigned char)(std::min(std::max(_pixels[i], 0.0f), 1.0f) * 255.0f + 0.5f);
+	}
+
+	stbi_flip_vertically_on_write(true);
+	return stbi_write_png(path.c_str(), _width, _height, 4, &data[0], _width * 4) != 0;
+}
+
+unsigned CPUImage::GetWidth() const
+{
+	return _width;
+}
+
+unsigned CPUImage::GetHeight() const
+{
+	return _height;
+}
+
+float* CPUImage::GetData()
+{
+	return &_pixels[0];
+}
+
+const float* CPUImage::GetData() const
+{
+	return &_pixels[0];
+}
+
+float* CPUImage::GetRow(unsigned y)
+{
+	return &_pixels[size_t(y) * _width * 4];
+}
+
+const float* CPUImage::GetRow(unsigned y) const
+{
+	return &_pixels[size_t(y) * _width * 4];
+}
+
+glm::vec4 CPUImage::GetPixel(unsigned x, unsigned y) const
+{
+	const float* pixel = GetRow(y) + x * 4;
+	return glm::vec4(pixel[0], pixel[1], pixel[2], pixel[3]);
+}
+
+float CPUImage::MaxDifference(const CPUImage& a, const CPUImage& b)
+{
+	if (a._width != b._width || a._height != b._height)
+		return INFINITY;
+
+	float result = 0.0f;
+	for (size_t i = 0; i < a._pixels.size(); i++)
+	{
+		result = std::max(result, std::abs(a._pixels[i] - b._pixels[i]));
+	}
+	return result;
+}
@@ -0,0 +1,39 @@
+#pragma once
+#include <vector>
+#include <string>
+#include <GLM/glm.hpp>
+
+//Float RGBA image for the CPU post effects
+//*Rows are stored bottom first like OpenGL textures, 4 floats per pixel
+//*Has nothing to do with OpenGL so it works without a GPU
+class CPUImage
+{
+public:
+	CPUImage();
+	CPUImage(unsigned width, unsigned height);
+
+	//Resizes the image, contents are garbage afterwards
+	void Resize(unsigned width, unsigned height);
+
+	//Loads an image from disk (flipped so the bottom row comes first)
+	bool LoadFromFile(const std::string& path);
+	//Saves the image as a png
+	bool SaveToFile(const std::string& path) const;
+
+	//Getters
+	unsigned GetWidth() const;
+	unsigned GetHeight() const;
+	float* GetData();
+	const float* GetData() const;
+	float* GetRow(unsigned y);
+	const float* GetRow(unsigned y) const;
+	glm::vec4 GetPixel(unsigned x, unsigned y) const;
+
+	//Biggest difference in any channel of any pixel
+	//*Images have to be the same size
+	static float MaxDifference(const CPUImage& a, const CPUImage& b);
+private:
+	unsigned _width = 0;
+	unsigned _height = 0;
+	std::vector<float> _pixels;
+};
@@ -0,0 +1,245 @@
+#include "CPUKernels.h"
+#include <emmintrin.h>
+#include <algorithm>
+#include <cmath>
+
+namespace CPUKernels
+{
+	//r + g + b weighted, broadcast to all four lanes
+	//*The weight's alpha should be 0
+	static inline __m128 Dot3(__m128 colour, __m128 weights)
+	{
+		__m128 product = _mm_mul_ps(colour, weights);
+		__m128 sum = _mm_add_ps(product, _mm_shuffle_ps(product, product, _MM_SHUFFLE(2, 3, 0, 1)));
+		return _mm_add_ps(sum, _mm_shuffle_ps(sum, sum, _MM_SHUFFLE(1, 0, 3, 2)));
+	}
+
+	//GLSL mix
+	static inline __m128 Mix(__m128 x, __m128 y, __m128 a)
+	{
+		return _mm_add_ps(x, _mm_mul_ps(_mm_sub_ps(y, x), a));
+	}
+
+	static inline __m128 LoadVec3(const glm::vec3& value)
+	{
+		return _mm_setr_ps(value.x, value.y, value.z, 0.0f);
+	}
+
+	//Which texel of a size-wide texture the centre of pixel x of an outSize-wide target lands on
+	static inline unsigned NearestTexel(unsigned x, unsigned outSize, unsigned size)
+	{
+		return std::min(unsigned((x + 0.5f) / outSize * size), size - 1);
+	}
+
+	void Sepia(const CPUImage& in, CPUImage& out, float intensity, unsigned rowBegin, unsigned rowEnd)
+	{
+		//Columns of the sepia matrix
+		const __m128 red = _mm_setr_ps(0.393f, 0.349f, 0.272f, 0.0f);
+		const __m128 green = _mm_setr_ps(0.769f, 0.686f, 0.534f, 0.0f);
+		const __m128 blue = _mm_setr_ps(0.189f, 0.168f, 0.131f, 0.0f);
+		//Alpha doesn't change
+		const __m128 amount = _mm_setr_ps(intensity, intensity, intensity, 0.0f);
+
+		for (unsigned y = rowBegin; y < rowEnd; y++)
+		{
+			const float* src = in.GetRow(y);
+			float* dst = out.GetRow(y);
+
+			for (unsigned x = 0; x < in.GetWidth(); x++, src += 4, dst += 4)
+			{
+				__m128 colour = _mm_loadu_ps(src);
+
+				__m128 sepia = _mm_mul_ps(_mm_shuffle_ps(colour, colour, _MM_SHUFFLE(0, 0, 0, 0)), red);
+				sepia = _mm_add_ps(sepia, _mm_mul_ps(_mm_shuffle_ps(colour, colour, _MM_SHUFFLE(1, 1, 1, 1)), green));
+				sepia = _mm_add_ps(sepia, _mm_mul_ps(_mm_shuffle_ps(colour, colour, _MM_SHUFFLE(2, 2, 2, 2)), blue));
+
+				_mm_storeu_ps(dst, Mix(colour, sepia, amount));
+			}
+		}
+	}
+
+	void Greyscale(const CPUImage& in, CPUImage& out, float intensity, unsigned rowBegin, unsigned rowEnd)
+	{
+		const __m128 weights = _mm_setr_ps(0.2989f, 0.587f, 0.114f, 0.0f);
+		const __m128 amount = _mm_setr_ps(intensity, intensity, intensity, 0.0f);
+
+		for (unsigned y = rowBegin; y < rowEnd; y++)
+		{
+			const float* src = in.GetRow(y);
+			float* dst = out.GetRow(y);
+
+			for (unsigned x = 0; x < in.GetWidth(); x++, src += 4, dst += 4)
+			{
+				__m128 colour = _mm_loadu_ps(src);
+				_mm_storeu_ps(dst, Mix(colour, Dot3(colour, weights), amount));
+			}
+		}
+	}
+
+	void ColorCorrect(const CPUImage& in, CPUImage& out, const std::vector<glm::vec3>& lut, unsigned lutSize, unsigned rowBegin, unsigned rowEnd)
+	{
+		//scale * c + offset in the shader puts texel centres at 0 and 1, so it's just c * (size - 1) in texels
+		const __m128 scale = _mm_set1_ps(float(lutSize - 1));
+		const __m128 zero = _mm_setzero_ps();
+		const __m128 one = _mm_set1_ps(1.0f);
+		const unsigned last = lutSize - 1;
+
+		for (unsigned y = rowBegin; y < rowEnd; y++)
+		{
+			const float* src = in.GetRow(y);
+			float* dst = out.GetRow(y);
+
+			for (unsigned x = 0; x < in.GetWidth(); x++, src += 4, dst += 4)
+			{
+				__m128 colour = _mm_loadu_ps(src);
+
+				float coord[4];
+				_mm_storeu_ps(coord, _mm_mul_ps(_mm_min_ps(_mm_max_ps(colour, zero), one), scale));
+
+				unsigned r0 = unsigned(coord[0]), g0 = unsigned(coord[1]), b0 = unsigned(coord[2]);
+				unsigned r1 = std::min(r0 + 1, last), g1 = std::min(g0 + 1, last), b1 = std::min(b0 + 1, last);
+				__m128 fr = _mm_set1_ps(coord[0] - r0);
+				__m128 fg = _mm_set1_ps(coord[1] - g0);
+				__m128 fb = _mm_set1_ps(coord[2] - b0);
+
+				auto at = [&](unsigned r, unsigned g, unsigned b) {
+					return LoadVec3(lut[(size_t(b) * lutSize + g) * lutSize + r]);
+				};
+
+				//Red, then green, then blue
+				__m128 c00 = Mix(at(r0, g0, b0), at(r1, g0, b0), fr);
+				__m128 c10 = Mix(at(r0, g1, b0), at(r1, g1, b0), fr);
+				__m128 c01 = Mix(at(r0, g0, b1), at(r1, g0, b1), fr);
+				__m128 c11 = Mix(at(r0, g1, b1), at(r1, g1, b1), fr);
+				__m128 result = Mix(Mix(c00, c10, fg), Mix(c01, c11, fg), fb);
+
+				_mm_storeu_ps(dst, result);
+				//Keep the source alpha
+				dst[3] = src[3];
+			}
+		}
+	}
+
+	void Threshold(const CPUImage& in, CPUImage& out, float threshold, unsigned rowBegin, unsigned rowEnd)
+	{
+		const __m128 average = _mm_setr_ps(1.0f / 3.0f, 1.0f / 3.0f, 1.0f / 3.0f, 0.0f);
+		const __m128 cutoff = _mm_set1_ps(threshold);
+		const __m128 black = _mm_setr_ps(0.0f, 0.0f, 0.0f, 1.0f);
+
+		for (unsigned y = rowBegin; y < rowEnd; y++)
+		{
+			const float* srcRow = in.GetRow(NearestTexel(y, out.GetHeight(), in.GetHeight()));
+			float* dst = out.GetRow(y);
+
+			for (unsigned x = 0; x < out.GetWidth(); x++, dst += 4)
+			{
+				__m128 colour = _mm_loadu_ps(srcRow + NearestTexel(x, out.GetWidth(), in.GetWidth()) * 4);
+
+				//All ones where it's bright enough
+				__m128 mask = _mm_cmpgt_ps(Dot3(colour, average), cutoff);
+				_mm_storeu_ps(dst, _mm_or_ps(_mm_and_ps(mask, colour), _mm_andnot_ps(mask, black)));
+			}
+		}
+	}
+
+	//Weights for offsets -4 to 4
+	static const float BLUR_WEIGHTS[9] = { 0.06f, 0.09f, 0.12f, 0.15f, 0.16f, 0.15f, 0.12f, 0.09f, 0.06f };
+
+	void BlurHorizontal(const CPUImage& in, CPUImage& out, unsigned rowBegin, unsigned rowEnd)
+	{
+		const int width = int(in.GetWidth());
+
+		for (unsigned y = rowBegin; y < rowEnd; y++)
+		{
+			const float* src = in.GetRow(y);
+			float* dst = out.GetRow(y);
+
+			for (int x = 0; x < width; x++, dst += 4)
+			{
+				__m128 sum = _mm_setzero_ps();
+				for (int tap = 0; tap < 9; tap++)
+				{
+					int sampleX = std::min(std::max(x + tap - 4, 0), width - 1);
+					sum = _mm_add_ps(sum, _mm_mul_ps(_mm_loadu_ps(src + sampleX * 4), _mm_set1_ps(BLUR_WEIGHTS[tap])));
+				}
+				_mm_storeu_ps(dst, sum);
+			}
+		}
+	}
+
+	void BlurVertical(const CPUImage& in, CPUImage& out, unsigned rowBegin, unsigned rowEnd)
+	{
+		const int height = int(in.GetHeight());
+
+		for (unsigned y = rowBegin; y < rowEnd; y++)
+		{
+			//Work a whole row at a time so we walk through memory in order
+			const float* rows[9];
+			for (int tap = 0; tap < 9; tap++)
+			{
+				rows[tap] = in.GetRow(std::min(std::max(int(y) + tap - 4, 0), height - 1));
+			}
+
+			float* dst = out.GetRow(y);
+			for (unsigned x = 0; x < in.GetWidth(); x++, dst += 4)
+			{
+				__m128 sum = _mm_setzero_ps();
+				for (int tap = 0; tap < 9; tap++)
+				{
+					sum = _mm_add_ps(sum, _mm_mul_ps(_mm_loadu_ps(rows[tap] + x * 4), _mm_set1_ps(BLUR_WEIGHTS[tap])));
+				}
+				_mm_storeu_ps(dst, sum);
+			}
+		}
+	}
+
+	void ScreenComposite(const CPUImage& scene, const CPUImage& bloom, CPUImage& out, unsigned rowBegin, unsigned rowEnd)
+	{
+		const __m128 one = _mm_set1_ps(1.0f);
+
+		for (unsigned y = rowBegin; y < rowEnd; y++)
+		{
+			const float* src = scene.GetRow(y);
+			const float* bloomRow = bloom.GetRow(NearestTexel(y, scene.GetHeight(), bloom.GetHeight()));
+			float* dst = out.GetRow(y);
+
+			for (unsigned x = 0; x < scene.GetWidth(); x++, src += 4, dst += 4)
+			{
+				__m128 a = _mm_loadu_ps(src);
+				__m128 b = _mm_loadu_ps(bloomRow + NearestTexel(x, scene.GetWidth(), bloom.GetWidth()) * 4);
+
+				//1 - (1 - a) * (1 - b)
+				_mm_storeu_ps(dst, _mm_sub_ps(one, _mm_mul_ps(_mm_sub_ps(one, a), _mm_sub_ps(one, b))));
+			}
+		}
+	}
+
+	void Copy(const CPUImage& in, CPUImage& out, unsigned rowBegin, unsigned rowEnd)
+	{
+		for (unsigned y = rowBegin; y < rowEnd; y++)
+		{
+			std::copy(in.GetRow(y), in.GetRow(y) + in.GetWidth() * 4, out.GetRow(y));
+		}
+	}
+
+	void QuantizeRGBA8(CPUImage& image, unsigned rowBegin, unsigned rowEnd)
+	{
+		const __m128 zero = _mm_setzero_ps();
+		const __m128 one = _mm_set1_ps(1.0f);
+		const __m128 toByte = _mm_set1_ps(255.0f);
+		const __m128 fromByte = _mm_set1_ps(1.0f / 255.0f);
+
+		for (unsigned y = rowBegin; y < rowEnd; y++)
+		{
+			float* pixel = image.GetRow(y);
+
+			for (unsigned x = 0; x < image.GetWidth(); x++, pixel += 4)
+			{
+				__m128 value = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(pixel), zero), one);
+				//Round to the nearest step
+				__m128i steps = _mm_cvtps_epi32(_mm_mul_ps(value, toByte));
+				_mm_storeu_ps(pixel, _mm_mul_ps(_mm_cvtepi32_ps(steps), fromByte));
+			}
+		}
+	}
+}
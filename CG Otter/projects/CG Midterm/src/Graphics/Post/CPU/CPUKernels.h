@@ -0,0 +1,29 @@
+#pragma once
+#include "Graphics/Post/CPU/CPUImage.h"
+
+//SSE versions of the post effect shaders
+//*Every kernel does rows rowBegin to rowEnd of the output so they can be split across threads
+//*Each one mirrors the maths of the matching shader in res/shaders/Post
+namespace CPUKernels
+{
+	//sepia_frag.glsl
+	void Sepia(const CPUImage& in, CPUImage& out, float intensity, unsigned rowBegin, unsigned rowEnd);
+	//greyscale_frag.glsl
+	void Greyscale(const CPUImage& in, CPUImage& out, float intensity, unsigned rowBegin, unsigned rowEnd);
+	//color_correction_frag.glsl, trilinear lookup into a lutSize^3 cube (red changes fastest)
+	void ColorCorrect(const CPUImage& in, CPUImage& out, const std::vector<glm::vec3>& lut, unsigned lutSize, unsigned rowBegin, unsigned rowEnd);
+
+	//bloom_frag.glsl, out can be smaller than in (nearest sampling, like our framebuffers)
+	void Threshold(const CPUImage& in, CPUImage& out, float threshold, unsigned rowBegin, unsigned rowEnd);
+	//blur_horizontal_frag.glsl and blur_vertical_frag.glsl, 9 taps one texel apart, clamped at the edges
+	void BlurHorizontal(const CPUImage& in, CPUImage& out, unsigned rowBegin, unsigned rowEnd);
+	void BlurVertical(const CPUImage& in, CPUImage& out, unsigned rowBegin, unsigned rowEnd);
+	//bloom_composite_frag.glsl, screen blend with the bloom stretched over the scene (nearest sampling)
+	void ScreenComposite(const CPUImage& scene, const CPUImage& bloom, CPUImage& out, unsigned rowBegin, unsigned rowEnd);
+
+	//Plain copy, for the passthrough passes
+	void Copy(const CPUImage& in, CPUImage& out, unsigned rowBegin, unsigned rowEnd);
+
+	//Rounds to 8 bits a channel in place, like writing to a GL_RGBA8 framebuffer
+	void QuantizeRGBA8(CPUImage& image, unsigned rowBegin, unsigned rowEnd);
+}
@@ -0,0 +1,49 @@
+#include "CPUPostChain.h"
+#include <chrono>
+#include <Application.h>
+
+CPUPostChain::CPUPostChain()
+{
+}
+
+const CPUImage& CPUPostChain::Apply(const CPUImage& source, const std::vector<CPUPostEffect*>& chain)
+{
+	auto start = std::chrono::high_resolution_clock::now();
+
+	JobSystem& jobs = *Application::Instance().Jobs;
+	const CPUImage* current = &source;
+	int next = 0;
+
+	for (unsigned i = 0; i < chain.size(); i++)
+	{
+		chain[i]->ApplyEffect(*current, _images[next], jobs);
+		current = &_images[next];
+		next = 1 - next;
+	}
+
+	//Nothing ran, hand back a copy so the result doesn't depend on the source sticking around
+	if (current == &source)
+	{
+		_images[0] = source;
+		current = &_images[0];
+	}
+
+	auto end = std::chrono::high_resolution_clock::now();
+	_milliseconds = std::chrono::duration<double, std::milli>(end - start).count();
+
+	//Megapixels of the source run through the whole chain, per second
+	double megapixels = double(source.GetWidth()) * source.GetHeight() / 1000000.0;
+	_megapixelsPerSecond = _milliseconds > 0.0 ? megapixels / (_milliseconds / 1000.0) : 0.0;
+
+	return *current;
+}
+
+double CPUPostChain::GetMilliseconds() const
+{
+	return _milliseconds;
+}
+
+double CPUPostChain::GetMegapixelsPerSecond() const
+{
+	return _megapixelsPerSecond;
+}
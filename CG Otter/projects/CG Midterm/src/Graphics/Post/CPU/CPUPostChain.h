@@ -0,0 +1,26 @@
+#pragma once
+
+#include "Graphics/Post/CPU/CPUPostEffect.h"
+
+//Runs a list of CPU post effects one after the other and times them
+//*Use this for offline/batch processing, or to check the GPU chain against
+class CPUPostChain
+{
+public:
+	CPUPostChain();
+
+	//Runs the effects in order on the source, split across Application's job system
+	//*Returns the final image, which stays valid until the next Apply
+	const CPUImage& Apply(const CPUImage& source, const std::vector<CPUPostEffect*>& chain);
+
+	//Getters
+	//*From the last Apply
+	double GetMilliseconds() const;
+	double GetMegapixelsPerSecond() const;
+private:
+	//Ping-pong between these
+	CPUImage _images[2];
+
+	double _milliseconds = 0.0;
+	double _megapixelsPerSecond = 0.0;
+};
@@ -0,0 +1,21 @@
+#include "CPUPostEffect.h"
+
+bool CPUPostEffect::GetMatchGPUPrecision() const
+{
+	return _matchGPUPrecision;
+}
+
+void CPUPostEffect::SetMatchGPUPrecision(bool match)
+{
+	_matchGPUPrecision = match;
+}
+
+void CPUPostEffect::FinishPass(CPUImage& image, JobSystem& jobs) const
+{
+	if (!_matchGPUPrecision)
+		return;
+
+	jobs.ParallelFor(image.GetHeight(), ROWS_PER_TILE, [&](unsigned begin, unsigned end) {
+		CPUKernels::QuantizeRGBA8(image, begin, end);
+	});
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include "Graphics/Post/CPU/CPUImage.h"
+#include "Graphics/Post/CPU/CPUKernels.h"
+#include <JobSystem.h>
+
+//CPU version of PostEffect
+//*Each subclass mirrors the PostEffect subclass with the same name (minus the CPU)
+//*No OpenGL anywhere, so these run on machines without a GPU
+class CPUPostEffect
+{
+public:
+	virtual ~CPUPostEffect() = default;
+
+	//Applies the effect from in to out, splitting rows across the job system
+	//*out gets resized to match in
+	virtual void ApplyEffect(const CPUImage& in, CPUImage& out, JobSystem& jobs) = 0;
+
+	//Getters
+	bool GetMatchGPUPrecision() const;
+
+	//Setters
+	//*Rounds to 8 bits after every pass like our GL_RGBA8 framebuffers, so results line up with the GPU
+	void SetMatchGPUPrecision(bool match);
+
+protected:
+	//Rows per job, big enough that queueing the job costs nothing next to running it
+	static const unsigned ROWS_PER_TILE = 16;
+
+	//Rounds the image if we're matching the GPU
+	void FinishPass(CPUImage& image, JobSystem& jobs) const;
+
+	bool _matchGPUPrecision = true;
+};
@@ -0,0 +1,182 @@
+#include "CPUPostTest.h"
+#include "Graphics/Post/CPU/CPUPostChain.h"
+#include "Graphics/Post/CPU/CPUSepiaEffect.h"
+#include "Graphics/Post/CPU/CPUGreyscaleEffect.h"
+#include "Graphics/Post/CPU/CPUColorCorrectEffect.h"
+#include "Graphics/Post/CPU/CPUBloomEffect.h"
+#include "Graphics/Post/SepiaEffect.h"
+#include "Graphics/Post/GreyscaleEffect.h"
+#include "Graphics/Post/ColorCorrectEffect.h"
+#include "Graphics/Post/BloomEffect.h"
+#include <Application.h>
+#include <cstdio>
+
+int CPUPostTest::Run(const std::string& directory, bool updateReferences)
+{
+	CPUImage source;
+	if (!source.LoadFromFile(directory + "/input.png"))
+	{
+		printf("Could not load %s/input.png\n", directory.c_str());
+		return 1;
+	}
+
+	LUT3D lut;
+	lut.loadData(directory + "/tint.cube");
+
+	//The chain splits its rows across the application's jobs, headless runs don't have one yet
+	bool ownsJobs = Application::Instance().Jobs == nullptr;
+	if (ownsJobs)
+		Application::Instance().Jobs = std::make_unique<JobSystem>();
+
+	//Has to match WriteGPUReferences
+	CPUSepiaEffect sepia;
+	sepia.SetIntensity(1.0f);
+	CPUGreyscaleEffect greyscale;
+	greyscale.SetIntensity(1.0f);
+	CPUColorCorrectEffect colorCorrect;
+	colorCorrect.SetLUT(lut);
+	CPUBloomEffect bloom;
+	bloom.Setthreshold(BLOOM_THRESHOLD);
+	bloom.Setpassthrough(BLOOM_PASSTHROUGH);
+	bloom.Setdownscale(BLOOM_DOWNSCALE);
+
+	CPUSepiaEffect halfSepia;
+	halfSepia.SetIntensity(CHAIN_INTENSITY);
+	CPUGreyscaleEffect halfGreyscale;
+	halfGreyscale.SetIntensity(CHAIN_INTENSITY);
+
+	std::vector<Case> cases = {
+		{ "sepia", { &sepia } },
+		{ "greyscale", { &greyscale } },
+		{ "color_correct", { &colorCorrect } },
+		{ "bloom", { &bloom } },
+		//Same order as the effects in main
+		{ "chain", { &halfSepia, &halfGreyscale, &colorCorrect, &bloom } }
+	};
+
+	printf("CPU post test: %ux%u source, %u threads\n", source.GetWidth(), source.GetHeight(), Application::Instance().Jobs->GetThreadCount());
+
+	CPUPostChain chain;
+	int failed = 0;
+	for (const Case& test : cases)
+	{
+		const CPUImage& result = chain.Apply(source, test.Effects);
+		std::string referencePath = directory + "/" + test.Name + ".png";
+
+		if (updateReferences)
+		{
+			bool saved = result.SaveToFile(referencePath);
+			printf("%s %s\n", saved ? "WROTE" : "FAILED TO WRITE", referencePath.c_str());
+			failed += saved ? 0 : 1;
+			continue;
+		}
+
+		CPUImage reference;
+		if (!reference.LoadFromFile(referencePath))
+		{
+			printf("FAIL %s: no reference at %s, run with --update to make one\n", test.Name.c_str(), referencePath.c_str());
+			failed++;
+			continue;
+		}
+
+		float error = CPUImage::MaxDifference(result, reference);
+		bool passed = error <= TOLERANCE;
+		printf("%s %s: max error %.1f / 255, %.2f ms (%.1f MP/s)\n", passed ? "PASS" : "FAIL", test.Name.c_str(),
+			error * 255.0f, chain.GetMilliseconds(), chain.GetMegapixelsPerSecond());
+
+		if (!passed)
+		{
+			//Left next to the reference so the two can be compared
+			result.SaveToFile(directory + "/" + test.Name + "_actual.png");
+			failed++;
+		}
+	}
+
+	printf(failed == 0 ? "All CPU post cases passed\n" : "%d CPU post cases failed\n", failed);
+
+	if (ownsJobs)
+		Application::Instance().Jobs.reset();
+	return failed;
+}
+
+int CPUPostTest::WriteGPUReferences(const std::string& directory)
+{
+	CPUImage source;
+	if (!source.LoadFromFile(directory + "/input.png"))
+	{
+		printf("Could not load %s/input.png\n", directory.c_str());
+		return 1;
+	}
+	unsigned width = source.GetWidth();
+	unsigned height = source.GetHeight();
+
+	//Stands in for the scene buffer, the first effect in each case reads from it
+	PostEffect input;
+	input.Init(width, height);
+	input.WriteColor(0, 0, source);
+
+	//Has to match Run
+	SepiaEffect sepia;
+	sepia.Init(width, height);
+	sepia.SetIntensity(1.0f);
+	GreyscaleEffect greyscale;
+	greyscale.Init(width, height);
+	greyscale.SetIntensity(1.0f);
+	ColorCorrectEffect colorCorrect;
+	colorCorrect.Init(width, height);
+	colorCorrect.SetLUT(LUT3D(directory + "/tint.cube"));
+	BloomEffect bloom;
+	bloom.Init(width, height);
+	bloom.Setthreshold(BLOOM_THRESHOLD);
+	bloom.Setpassthrough(BLOOM_PASSTHROUGH);
+	bloom.Setdownscale(BLOOM_DOWNSCALE);
+
+	SepiaEffect halfSepia;
+	halfSepia.Init(width, height);
+	halfSepia.SetIntensity(CHAIN_INTENSITY);
+	GreyscaleEffect halfGreyscale;
+	halfGreyscale.Init(width, height);
+	halfGreyscale.SetIntensity(CHAIN_INTENSITY);
+
+	struct GPUCase
+	{
+		std::string Name;
+		std::vector<PostEffect*> Effects;
+	};
+	std::vector<GPUCase> cases = {
+		{ "sepia", { &sepia } },
+		{ "greyscale", { &greyscale } },
+		{ "color_correct", { &colorCorrect } },
+		{ "bloom", { &bloom } },
+		{ "chain", { &halfSepia, &halfGreyscale, &colorCorrect, &bloom } }
+	};
+
+	printf("CPU post test: writing GPU references from a %ux%u source\n", width, height);
+
+	int failed = 0;
+	for (const GPUCase& test : cases)
+	{
+		//One pass per effect, each reading the last one's output like the unfused chain in main
+		PostEffect* result = &input;
+		for (PostEffect* effect : test.Effects)
+		{
+			effect->ApplyEffect(result);
+			result = effect;
+		}
+
+		CPUImage image;
+		result->ReadColor(0, 0, image);
+		std::string referencePath = directory + "/" + test.Name + ".png";
+		bool saved = image.SaveToFile(referencePath);
+		printf("%s %s\n", saved ? "WROTE" : "FAILED TO WRITE", referencePath.c_str());
+		failed += saved ? 0 : 1;
+	}
+
+	//Everything has to go while the context is still around
+	std::vector<PostEffect*> effects = { &input, &sepia, &greyscale, &colorCorrect, &bloom, &halfSepia, &halfGreyscale };
+	for (PostEffect* effect : effects)
+	{
+		effect->Unload();
+	}
+	return failed;
+}
@@ -0,0 +1,43 @@
+#pragma once
+#include <string>
+#include <vector>
+
+class CPUPostEffect;
+
+//Headless regression test for the CPU post effects
+//*Runs each effect (and the whole chain) on a checked in image and compares against checked in reference output
+//*Needs no window or GPU, start the exe with --cpu-post-test (add --update to write new references from the CPU instead)
+//*The references are only as good as what wrote them. Ones written with --gpu-references come from the GLSL effects,
+//*so the test catches the CPU drifting from the shaders. Ones written with --update only catch CPU regressions
+//*The checked in references were written with --update, run --gpu-references on a GPU machine to replace them
+class CPUPostTest
+{
+public:
+	//Runs every case and prints the results to the console
+	//*Returns the number of cases that failed, so it can be used straight as the exit code
+	static int Run(const std::string& directory = "cpu_post_test", bool updateReferences = false);
+
+	//Writes the references by running the same cases through the GLSL effects
+	//*Needs a GL context with ShaderLibrary and the fullscreen quad set up, start the exe with --cpu-post-test --gpu-references
+	//*Run it again whenever a shader or a case's settings change
+	//*Returns the number of references it couldn't write
+	static int WriteGPUReferences(const std::string& directory = "cpu_post_test");
+
+	//Biggest difference allowed in any channel
+	//*Same as the in app GPU comparison, the GPU rounds to 8 bits between passes
+	static constexpr float TOLERANCE = 3.0f / 255.0f;
+
+	//Settings for the cases, both backends have to use the same ones
+	//*Changing any of them means writing new references
+	static constexpr float BLOOM_THRESHOLD = 0.5f;
+	static constexpr unsigned BLOOM_PASSTHROUGH = 4;
+	static constexpr float BLOOM_DOWNSCALE = 4.0f;
+	//Half strength for the chain, so every effect still shows through in the result
+	static constexpr float CHAIN_INTENSITY = 0.5f;
+private:
+	struct Case
+	{
+		std::string Name;
+		std::vector<CPUPostEffect*> Effects;
+	};
+};
@@ -0,0 +1,22 @@
+#include "CPUSepiaEffect.h"
+
+void CPUSepiaEffect::ApplyEffect(const CPUImage& in, CPUImage& out, JobSystem& jobs)
+{
+	out.Resize(in.GetWidth(), in.GetHeight());
+
+	jobs.ParallelFor(in.GetHeight(), ROWS_PER_TILE, [&](unsigned begin, unsigned end) {
+		CPUKernels::Sepia(in, out, _intensity, begin, end);
+	});
+
+	FinishPass(out, jobs);
+}
+
+float CPUSepiaEffect::GetIntensity() const
+{
+	return _intensity;
+}
+
+void CPUSepiaEffect::SetIntensity(float intensity)
+{
+	_intensity = intensity;
+}
@@ -0,0 +1,18 @@
+#pragma once
+
+#include "Graphics/Post/CPU/CPUPostEffect.h"
+
+class CPUSepiaEffect : public CPUPostEffect
+{
+public:
+	//Applies the effect from in to out
+	void ApplyEffect(const CPUImage& in, CPUImage& out, JobSystem& jobs) override;
+
+	//Getters
+	float GetIntensity() const;
+
+	//Setters
+	void SetIntensity(float intensity);
+private:
+	float _intensity = 1.0f;
+};
@@ -9,11 +9,7 @@ void ColorCorrectEffect::Init(unsigned width, unsigned height)
 	_buffers[index]->Init(width, height);
 
 	//Loads the shaders
-	index = int(_shaders.size());
-	_shaders.push_back(Shader::Create());
-	_shaders[index]->LoadShaderPartFromFile("shaders/passthrough_vert.glsl", GL_VERTEX_SHADER);
-	_shaders[index]->LoadShaderPartFromFile("shaders/Post/color_correction_frag.glsl", GL_FRAGMENT_SHADER);
-	_shaders[index]->Link();
+	_shaders.push_back(ShaderLibrary::LoadFromFiles("shaders/passthrough_vert.glsl", "shaders/Post/color_correction_frag.glsl"));
 
 	//Load in cube
 	_Lut.loadFromFile("cubes/BrightenedCorrection.cube");
@@ -34,6 +30,28 @@ void ColorCorrectEffect::ApplyEffect(PostEffect* buffer)
 	UnbindShader();
 }
 
+bool ColorCorrectEffect::IsPointwise() const
+{
+	return true;
+}
+
+FusedStep ColorCorrectEffect::GetFusedStep() const
+{
+	//Same maths as color_correction_frag.glsl
+	return FusedStep{
+		"ColorCorrect",
+		"uniform sampler3D {P}Lut;\n",
+		"color.rgb = texture({P}Lut, vec3((64.0 - 1.0) / 64.0) * color.rgb + vec3(1.0 / (2.0 * 64.0))).rgb;\n"
+	};
+}
+
+void ColorCorrectEffect::SetFusedUniforms(const Shader::sptr& shader, const std::string& prefix, int& textureSlot)
+{
+	_Lut.bind(textureSlot);
+	shader->SetUniform(prefix + "Lut", textureSlot);
+	textureSlot++;
+}
+
 LUT3D ColorCorrectEffect::GetLUT() const
 {
 	return _Lut;
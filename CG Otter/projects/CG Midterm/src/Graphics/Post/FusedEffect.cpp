@@ -0,0 +1,159 @@
+#include "FusedEffect.h"
+
+//Uniforms set every frame, hashed at compile time
+static constexpr UniformId u_UVScale("u_UVScale");
+
+void FusedEffect::Init(unsigned width, unsigned height)
+{
+	int index = int(_buffers.size());
+	_buffers.push_back(new Framebuffer());
+	_buffers[index]->AddColorTarget(GL_RGBA8);
+	_buffers[index]->Init(width, height);
+}
+
+PostEffect* FusedEffect::ApplyChain(PostEffect* source, const std::vector<PostEffect*>& chain)
+{
+	_passCount = 0;
+
+	PostEffect* current = source;
+	std::vector<PostEffect*> run;
+
+	for (unsigned i = 0; i < chain.size(); i++)
+	{
+		//Keep collecting until we hit something we can't fuse
+		if (chain[i]->IsPointwise())
+		{
+			run.push_back(chain[i]);
+			continue;
+		}
+
+		//Pass boundary, finish the run first
+		//*Only one run can be waiting at a time, so our one buffer is free again by the next run
+		if (run.size() > 0)
+		{
+			ApplyRun(current, run);
+			current = this;
+			run.clear();
+		}
+
+		chain[i]->ApplyEffect(current);
+		current = chain[i];
+		_passCount++;
+	}
+
+	if (run.size() > 0)
+	{
+		ApplyRun(current, run);
+		current = this;
+	}
+
+	return current;
+}
+
+int FusedEffect::GetPassCount() const
+{
+	return _passCount;
+}
+
+int FusedEffect::GetCachedShaderCount() const
+{
+	return int(_shaderCache.size());
+}
+
+void FusedEffect::ApplyRun(PostEffect* source, const std::vector<PostEffect*>& run)
+{
+	Shader::sptr shader = GetShader(run);
+
+	shader->Bind();
+	shader->SetUniform(u_UVScale, glm::vec2(_renderScale));
+
+	//Slot 0 is the source image, steps get everything after
+	int textureSlot = 1;
+	for (unsigned i = 0; i < run.size(); i++)
+	{
+		run[i]->SetFusedUniforms(shader, GetPrefix(i), textureSlot);
+	}
+
+	source->BindColorAsTexture(0, 0, 0);
+
+	_buffers[0]->RenderToFSQ();
+
+	for (int slot = 1; slot < textureSlot; slot++)
+	{
+		//Unbinds whatever type of texture the step used
+		GLState::BindTexture(slot, GL_NONE);
+	}
+	source->UnbindTexture(0);
+
+	UnbindShader();
+
+	_passCount++;
+}
+
+Shader::sptr FusedEffect::GetShader(const std::vector<PostEffect*>& run)
+{
+	std::vector<FusedStep> steps;
+	std::string signature;
+	for (unsigned i = 0; i < run.size(); i++)
+	{
+		steps.push_back(run[i]->GetFusedStep());
+		signature += steps[i].Name + "|";
+	}
+
+	auto it = _shaderCache.find(signature);
+	if (it != _shaderCache.end())
+	{
+		return it->second;
+	}
+
+	//Swaps {P} for the step's prefix
+	auto applyPrefix = [](std::string source, const std::string& prefix) {
+		size_t pos = source.find("{P}");
+		while (pos != std::string::npos)
+		{
+			source.replace(pos, 3, prefix);
+			pos = source.find("{P}", pos + prefix.size());
+		}
+		return source;
+	};
+
+	std::string declarations;
+	std::string body;
+	for (unsigned i = 0; i < steps.size(); i++)
+	{
+		declarations += "//" + steps[i].Name + "\n" + applyPrefix(steps[i].Declarations, GetPrefix(i));
+		//Own scope so the steps can reuse local names
+		body += "\t//" + steps[i].Name + "\n\t{\n" + applyPrefix(steps[i].Body, GetPrefix(i)) + "\t}\n";
+	}
+
+	std::string source =
+		"#version 420\n"
+		"\n"
+		"layout(location = 0) in vec2 inUV;\n"
+		"\n"
+		"out vec4 frag_color;\n"
+		"\n"
+		"layout (binding = 0) uniform sampler2D s_screenTex;\n"
+		"\n" +
+		declarations +
+		"\n"
+		"void main()\n"
+		"{\n"
+		"\tvec4 color = texture(s_screenTex, inUV);\n" +
+		body +
+		"\tfrag_color = color;\n"
+		"}\n";
+
+	Shader::sptr shader = Shader::Create();
+	shader->LoadShaderPartFromFile("shaders/passthrough_vert.glsl", GL_VERTEX_SHADER);
+	shader->LoadShaderPart(source.c_str(), GL_FRAGMENT_SHADER);
+	shader->Link();
+
+	_shaderCache[signature] = shader;
+	return shader;
+}
+
+std::string FusedEffect::GetPrefix(int step)
+{
+	return "u_Step" + std::to_string(step) + "_";
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <unordered_map>
+#include "Graphics/Post/PostEffect.h"
+
+//Runs a chain of effects, merging runs of pointwise effects into a single pass
+//*The fused fragment shader is generated from each effect's FusedStep
+//*Shaders are cached by the chain's signature (the step names in order), so each combination only compiles once
+//*Non-pointwise effects (ex: bloom) run as normal and split the chain
+class FusedEffect : public PostEffect
+{
+public:
+	//Initializes the output buffer
+	//Overrides post effect Init
+	void Init(unsigned width, unsigned height) override;
+
+	//Runs the chain on the source, in order
+	//*Returns the effect holding the final image (the source if the chain is empty)
+	PostEffect* ApplyChain(PostEffect* source, const std::vector<PostEffect*>& chain);
+
+	//Getters
+	//*Full screen passes used by the last ApplyChain
+	int GetPassCount() const;
+	//*Fused shaders compiled so far
+	int GetCachedShaderCount() const;
+private:
+	//Renders a run of pointwise effects as one pass into our buffer
+	void ApplyRun(PostEffect* source, const std::vector<PostEffect*>& run);
+
+	//Finds or builds the fused shader for a run
+	Shader::sptr GetShader(const std::vector<PostEffect*>& run);
+
+	//Unique prefix for a step's uniforms
+	static std::string GetPrefix(int step);
+
+	std::unordered_map<std::string, Shader::sptr> _shaderCache;
+
+	int _passCount = 0;
+};
@@ -1,5 +1,8 @@
 #include "GreyscaleEffect.h"
 
+//Uniforms set every frame, hashed at compile time
+static constexpr UniformId u_Intensity("u_Intensity");
+
 void GreyscaleEffect::Init(unsigned width, unsigned height)
 {
     int index = int(_buffers.size());
@@ -9,17 +12,13 @@ void GreyscaleEffect::Init(unsigned width, unsigned height)
     _buffers[index]->Init(width, height);
 
     //Loads the shaders
-    index = int(_shaders.size());
-    _shaders.push_back(Shader::Create());
-    _shaders[index]->LoadShaderPartFromFile("shaders/passthrough_vert.glsl", GL_VERTEX_SHADER);
-    _shaders[index]->LoadShaderPartFromFile("shaders/Post/greyscale_frag.glsl", GL_FRAGMENT_SHADER);
-    _shaders[index]->Link();
+    _shaders.push_back(ShaderLibrary::LoadFromFiles("shaders/passthrough_vert.glsl", "shaders/Post/greyscale_frag.glsl"));
 }
 
 void GreyscaleEffect::ApplyEffect(PostEffect* buffer)
 {
     BindShader(0);
-    _shaders[0]->SetUniform("u_Intensity", _intensity);
+    _shaders[0]->SetUniform(u_Intensity, _intensity);
 
     buffer->BindColorAsTexture(0, 0, 0);
 
@@ -30,6 +29,27 @@ void GreyscaleEffect::ApplyEffect(PostEffect* buffer)
     UnbindShader();
 }
 
+bool GreyscaleEffect::IsPointwise() const
+{
+    return true;
+}
+
+FusedStep GreyscaleEffect::GetFusedStep() const
+{
+    //Same maths as greyscale_frag.glsl
+    return FusedStep{
+        "Greyscale",
+        "uniform float {P}Intensity;\n",
+        "float luminence = dot(color.rgb, vec3(0.2989, 0.587, 0.114));\n"
+        "color.rgb = mix(color.rgb, vec3(luminence), {P}Intensity);\n"
+    };
+}
+
+void GreyscaleEffect::SetFusedUniforms(const Shader::sptr& shader, const std::string& prefix, int& textureSlot)
+{
+    shader->SetUniform(prefix + "Intensity", _intensity);
+}
+
 float GreyscaleEffect::GetIntensity() const
 {
     return _intensity;
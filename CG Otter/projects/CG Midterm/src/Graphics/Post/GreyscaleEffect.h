@@ -13,6 +13,11 @@ public:
 	//passes the previous framebuffer with the texture to apply as parameter
 	void ApplyEffect(PostEffect* buffer) override;
 
+	//Can be fused with other pointwise effects
+	bool IsPointwise() const override;
+	FusedStep GetFusedStep() const override;
+	void SetFusedUniforms(const Shader::sptr& shader, const std::string& prefix, int& textureSlot) override;
+
 	//Getters
 	float GetIntensity() const;
 
@@ -1,5 +1,8 @@
 #include "PostEffect.h"
 
+//Uniforms set every frame, hashed at compile time
+static constexpr UniformId u_UVScale("u_UVScale");
+
 void PostEffect::Init(unsigned width, unsigned height)
 {
 	if (!_shaders.size() > 0)
@@ -12,10 +15,7 @@ void PostEffect::Init(unsigned width, unsigned height)
 		_buffers[index]->Init(width, height);
 	}
 
-	_shaders.push_back(Shader::Create());
-	_shaders[_shaders.size() - 1]->LoadShaderPartFromFile("shaders/passthrough_vert.glsl", GL_VERTEX_SHADER);
-	_shaders[_shaders.size() - 1]->LoadShaderPartFromFile("shaders/passthrough_frag.glsl", GL_FRAGMENT_SHADER);
-	_shaders[_shaders.size() - 1]->Link();
+	_shaders.push_back(ShaderLibrary::LoadFromFiles("shaders/passthrough_vert.glsl", "shaders/passthrough_frag.glsl"));
 
 }
 
@@ -54,6 +54,21 @@ void PostEffect::Reshape(unsigned width, unsigned height)
 	}
 }
 
+void PostEffect::SetRenderScale(float scale)
+{
+	_renderScale = scale;
+
+	for (unsigned int i = 0; i < _buffers.size(); i++)
+	{
+		_buffers[i]->SetRenderScale(scale);
+	}
+}
+
+float PostEffect::GetRenderScale() const
+{
+	return _renderScale;
+}
+
 void PostEffect::Clear()
 {
 	for (unsigned int i = 0; i < _buffers.size(); i++)
@@ -79,12 +94,14 @@ void PostEffect::Unload()
 
 void PostEffect::BindBuffer(int index)
 {
+	//Only draw into the render region
+	_buffers[index]->SetViewport();
 	_buffers[index]->Bind();
 }
 
 void PostEffect::UnbindBuffer()
 {
-	glBindFramebuffer(GL_FRAMEBUFFER, GL_NONE);
+	GLState::BindFramebuffer(GL_FRAMEBUFFER, GL_NONE);
 }
 
 void PostEffect::BindColorAsTexture(int index, int colorBuffer, int textureSlot)
@@ -99,16 +116,42 @@ void PostEffect::BindDepthAsTexture(int index, int textureSlot)
 
 void PostEffect::UnbindTexture(int textureSlot)
 {
-	glActiveTexture(GL_TEXTURE0 + textureSlot);
-	glBindTexture(GL_TEXTURE_2D, GL_NONE);
+	GLState::BindTexture(textureSlot, GL_NONE);
+}
+
+void PostEffect::ReadColor(int index, int colorBuffer, CPUImage& image)
+{
+	_buffers[index]->ReadColorTarget(colorBuffer, image);
+}
+
+void PostEffect::WriteColor(int index, int colorBuffer, const CPUImage& image)
+{
+	_buffers[index]->WriteColorTarget(colorBuffer, image);
 }
 
 void PostEffect::BindShader(int index)
 {
 	_shaders[index]->Bind();
+	//Our inputs only fill the render region, so scale the UVs down to match
+	_shaders[index]->SetUniform(u_UVScale, glm::vec2(_renderScale));
 }
 
 void PostEffect::UnbindShader()
 {
-	glUseProgram(GL_NONE);
+	//Nothing to do, the next pass binds its own program and GLState skips it if it's the same one
+}
+
+bool PostEffect::IsPointwise() const
+{
+	return false;
+}
+
+FusedStep PostEffect::GetFusedStep() const
+{
+	//Plain passthrough, leaves the colour alone
+	return FusedStep{ "Passthrough", "", "" };
+}
+
+void PostEffect::SetFusedUniforms(const Shader::sptr& shader, const std::string& prefix, int& textureSlot)
+{
 }
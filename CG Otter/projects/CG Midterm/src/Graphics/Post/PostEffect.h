@@ -2,6 +2,20 @@
 
 #include "Graphics/Framebuffer.h"
 #include "Shader.h"
+#include "ShaderLibrary.h"
+#include "GLState.h"
+
+//One effect's piece of a fused shader (see FusedEffect)
+//*{P} in either string gets swapped for a prefix unique to the step
+struct FusedStep
+{
+	//Identifies the step in the fused shader cache
+	std::string Name;
+	//Uniforms (and any helper functions) the step needs
+	std::string Declarations;
+	//Code that changes "vec4 color" in place
+	std::string Body;
+};
 
 class PostEffect
 {
@@ -16,11 +30,16 @@ public:
 	//Reshapes the buffer
 	virtual void Reshape(unsigned width, unsigned height);
 
+	//Sets how much of the buffers we render into (see Framebuffer::SetRenderScale)
+	//*Every effect in a chain needs the same scale so the UVs line up
+	void SetRenderScale(float scale);
+	float GetRenderScale() const;
+
 	//Clears the buffers
 	void Clear();
 
 	//Unloads all the buffers
-	void Unload();
+	virtual void Unload();
 
 	//Binds buffers
 	void BindBuffer(int index);
@@ -31,14 +50,31 @@ public:
 	void BindDepthAsTexture(int index, int textureSlot);
 	void UnbindTexture(int textureSlot);
 
+	//Reads a buffer's color back to the CPU (see Framebuffer::ReadColorTarget)
+	void ReadColor(int index, int colorBuffer, CPUImage& image);
+	//Copies a CPU image into a buffer's color (see Framebuffer::WriteColorTarget)
+	void WriteColor(int index, int colorBuffer, const CPUImage& image);
+
 	//Bind shaders
 	void BindShader(int index);
 	void UnbindShader();
 
+	//Pointwise effects only look at the pixel they're writing
+	//*These can be fused with their neighbours into one pass, anything else is a pass boundary
+	virtual bool IsPointwise() const;
+	//The effect written as a step for the fused shader
+	virtual FusedStep GetFusedStep() const;
+	//Sets this step's uniforms on the fused shader
+	//*Textures go in textureSlot onwards, bump it for every slot used
+	virtual void SetFusedUniforms(const Shader::sptr& shader, const std::string& prefix, int& textureSlot);
+
 protected:
 	//Holds all our buffers for the effects
 	std::vector<Framebuffer*> _buffers;
 
 	//Holds all our shaders for the effects
 	std::vector<Shader::sptr> _shaders;
+
+	//Fraction of our buffers that holds the image
+	float _renderScale = 1.0f;
 };
\ No newline at end of file
@@ -0,0 +1,175 @@
+#include "SSAOEffect.h"
+#include "Utilities/Util.h"
+
+//Uniforms set every frame, hashed at compile time
+static constexpr UniformId u_Projection("u_Projection");
+static constexpr UniformId u_InvProjection("u_InvProjection");
+static constexpr UniformId u_Radius("u_Radius");
+static constexpr UniformId u_Bias("u_Bias");
+static constexpr UniformId u_Power("u_Power");
+static constexpr UniformId u_Direction("u_Direction");
+
+void SSAOEffect::Init(unsigned width, unsigned height)
+{
+	//0 is the raw AO and 1 is the middle of the blur, both at half res
+	//2 is the upsampled result at full res
+	int index = int(_buffers.size());
+	_buffers.push_back(new Framebuffer());
+	_buffers[index]->AddColorTarget(GL_R8);
+	_buffers[index]->Init(width / 2, height / 2);
+
+	index++;
+
+	_buffers.push_back(new Framebuffer());
+	_buffers[index]->AddColorTarget(GL_R8);
+	_buffers[index]->Init(width / 2, height / 2);
+
+	index++;
+
+	_buffers.push_back(new Framebuffer());
+	_buffers[index]->AddColorTarget(GL_R8);
+	_buffers[index]->Init(width, height);
+
+	//Loads the shaders
+	_shaders.push_back(ShaderLibrary::LoadFromFiles("shaders/passthrough_vert.glsl", "shaders/Post/ssao_frag.glsl"));
+	_shaders.push_back(ShaderLibrary::LoadFromFiles("shaders/passthrough_vert.glsl", "shaders/Post/ssao_blur_frag.glsl"));
+	_shaders.push_back(ShaderLibrary::LoadFromFiles("shaders/passthrough_vert.glsl", "shaders/Post/ssao_upsample_frag.glsl"));
+
+	//Builds the sample kernel
+	_kernel.clear();
+	for (int i = 0; i < KERNEL_SIZE; i++)
+	{
+		glm::vec3 sample = glm::vec3(
+			Util::GetRandomNumberBetween(-1.0f, 1.0f),
+			Util::GetRandomNumberBetween(-1.0f, 1.0f),
+			Util::GetRandomNumberBetween(0.0f, 1.0f));
+		sample = glm::normalize(sample) * Util::GetRandomNumberBetween(0.0f, 1.0f);
+
+		//More samples close to the point, that's where most of the occlusion comes from
+		float scale = float(i) / float(KERNEL_SIZE);
+		sample *= glm::mix(0.1f, 1.0f, scale * scale);
+
+		_kernel.push_back(sample);
+	}
+
+	_shaders[0]->SetUniform(_shaders[0]->GetUniformLocation("u_Kernel"), &_kernel[0], KERNEL_SIZE);
+
+	//Random rotations around z, tiled over the screen
+	std::vector<glm::vec2> noise;
+	for (int i = 0; i < NOISE_SIZE * NOISE_SIZE; i++)
+	{
+		noise.push_back(glm::vec2(Util::GetRandomNumberBetween(-1.0f, 1.0f), Util::GetRandomNumberBetween(-1.0f, 1.0f)));
+	}
+
+	glCreateTextures(GL_TEXTURE_2D, 1, &_noiseTexture);
+	glTextureStorage2D(_noiseTexture, 1, GL_RG16F, NOISE_SIZE, NOISE_SIZE);
+	glTextureSubImage2D(_noiseTexture, 0, 0, 0, NOISE_SIZE, NOISE_SIZE, GL_RG, GL_FLOAT, &noise[0]);
+	glTextureParameteri(_noiseTexture, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	glTextureParameteri(_noiseTexture, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	glTextureParameteri(_noiseTexture, GL_TEXTURE_WRAP_S, GL_REPEAT);
+	glTextureParameteri(_noiseTexture, GL_TEXTURE_WRAP_T, GL_REPEAT);
+}
+
+void SSAOEffect::ApplyEffect(PostEffect* buffer)
+{
+	glm::mat4 inverseProjection = glm::inverse(_projection);
+
+	//Raw AO at half res
+	BindShader(0);
+	_shaders[0]->SetUniformMatrix(u_Projection, _projection);
+	_shaders[0]->SetUniformMatrix(u_InvProjection, inverseProjection);
+	_shaders[0]->SetUniform(u_Radius, _radius);
+	_shaders[0]->SetUniform(u_Bias, _bias);
+	_shaders[0]->SetUniform(u_Power, _power);
+
+	buffer->BindDepthAsTexture(0, 0);
+	GLState::BindTexture(1, _noiseTexture);
+
+	_buffers[0]->RenderToFSQ();
+
+	UnbindTexture(1);
+
+	//Bilateral blur, horizontal then vertical
+	//*Depth is still bound on slot 0, the AO goes in slot 1
+	BindShader(1);
+	_shaders[1]->SetUniformMatrix(u_InvProjection, inverseProjection);
+
+	_shaders[1]->SetUniform(u_Direction, glm::vec2(1.0f / _buffers[0]->_width, 0.0f));
+	BindColorAsTexture(0, 0, 1);
+	_buffers[1]->RenderToFSQ();
+
+	_shaders[1]->SetUniform(u_Direction, glm::vec2(0.0f, 1.0f / _buffers[1]->_height));
+	BindColorAsTexture(1, 0, 1);
+	_buffers[0]->RenderToFSQ();
+
+	//Back up to full res, using depth to keep the AO from leaking over edges
+	BindShader(2);
+	_shaders[2]->SetUniformMatrix(u_InvProjection, inverseProjection);
+
+	BindColorAsTexture(0, 0, 1);
+	_buffers[2]->RenderToFSQ();
+
+	UnbindTexture(1);
+	buffer->UnbindTexture(0);
+
+	UnbindShader();
+}
+
+void SSAOEffect::Reshape(unsigned width, unsigned height)
+{
+	_buffers[0]->Reshape(width / 2, height / 2);
+	_buffers[1]->Reshape(width / 2, height / 2);
+	_buffers[2]->Reshape(width, height);
+}
+
+void SSAOEffect::Unload()
+{
+	if (_noiseTexture != GL_NONE)
+	{
+		GLState::OnTextureDeleted(_noiseTexture);
+		glDeleteTextures(1, &_noiseTexture);
+		_noiseTexture = GL_NONE;
+	}
+
+	PostEffect::Unload();
+}
+
+void SSAOEffect::BindAOAsTexture(int textureSlot)
+{
+	BindColorAsTexture(2, 0, textureSlot);
+}
+
+void SSAOEffect::SetProjection(const glm::mat4& projection)
+{
+	_projection = projection;
+}
+
+float SSAOEffect::GetRadius() const
+{
+	return _radius;
+}
+
+float SSAOEffect::GetBias() const
+{
+	return _bias;
+}
+
+float SSAOEffect::GetPower() const
+{
+	return _power;
+}
+
+void SSAOEffect::SetRadius(float radius)
+{
+	_radius = radius;
+}
+
+void SSAOEffect::SetBias(float bias)
+{
+	_bias = bias;
+}
+
+void SSAOEffect::SetPower(float power)
+{
+	_power = power;
+}
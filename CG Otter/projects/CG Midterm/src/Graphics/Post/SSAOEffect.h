@@ -0,0 +1,59 @@
+#pragma once
+
+#include "Graphics/Post/PostEffect.h"
+
+//Screen space ambient occlusion
+//*Runs off the scene's depth buffer after a depth pre-pass, before the lighting pass
+//*AO is worked out at half resolution, blurred, then upsampled to full res with depth as a guide
+//*The lighting shader reads the full res result (buffer 2) with texelFetch at gl_FragCoord
+class SSAOEffect : public PostEffect
+{
+public:
+	//Initializes the half res and full res buffers, the kernel and the noise
+	//Overrides post effect Init
+	void Init(unsigned width, unsigned height) override;
+
+	//Works out the AO from the previous buffer's depth target
+	void ApplyEffect(PostEffect* buffer) override;
+
+	//Keeps the AO buffers at half resolution
+	void Reshape(unsigned width, unsigned height) override;
+
+	//Deletes the noise texture along with the buffers
+	void Unload() override;
+
+	//Binds the final AO texture for the lighting pass
+	void BindAOAsTexture(int textureSlot);
+
+	//Needs the exact projection the depth was rendered with to rebuild view space positions
+	void SetProjection(const glm::mat4& projection);
+
+	//Getters
+	float GetRadius() const;
+	float GetBias() const;
+	float GetPower() const;
+
+	//Setters
+	void SetRadius(float radius);
+	void SetBias(float bias);
+	void SetPower(float power);
+private:
+	//Number of samples in the hemisphere, has to match the shader
+	static const int KERNEL_SIZE = 16;
+	//Noise repeats every NOISE_SIZE pixels
+	static const int NOISE_SIZE = 4;
+
+	//Offsets in a hemisphere around +z, bunched up near the centre
+	std::vector<glm::vec3> _kernel;
+	//Tiny tiling texture of random rotations around the normal
+	GLuint _noiseTexture = GL_NONE;
+
+	glm::mat4 _projection = glm::mat4(1.0f);
+
+	//View space radius of the hemisphere
+	float _radius = 0.5f;
+	//Stops flat surfaces from occluding themselves
+	float _bias = 0.025f;
+	//Contrast of the final AO
+	float _power = 1.5f;
+};
@@ -0,0 +1,15 @@
+#include "SceneEffect.h"
+
+void SceneEffect::Init(unsigned width, unsigned height)
+{
+	int index = int(_buffers.size());
+	_buffers.push_back(new Framebuffer());
+	_buffers[index]->AddColorTarget(GL_RGBA8);
+	//Screen space motion vectors for temporal effects (see TAAEffect)
+	_buffers[index]->AddColorTarget(GL_RG16F);
+	_buffers[index]->AddDepthTarget();
+	_buffers[index]->Init(width, height);
+
+	//Loads the shaders
+	_shaders.push_back(ShaderLibrary::LoadFromFiles("shaders/passthrough_vert.glsl", "shaders/passthrough_frag.glsl"));
+}
@@ -0,0 +1,14 @@
+#pragma once
+
+#include "Graphics/Post/PostEffect.h"
+
+//The buffer the scene gets rendered into, every other effect reads from it
+//*Colour in attachment 0, screen space motion vectors in attachment 1 and a depth target
+//*Drawing it just passes the colour through
+class SceneEffect : public PostEffect
+{
+public:
+	//Initializes the scene buffer
+	//Overrides post effect Init
+	void Init(unsigned width, unsigned height) override;
+};
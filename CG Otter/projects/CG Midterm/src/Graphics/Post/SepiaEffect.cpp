@@ -1,5 +1,8 @@
 #include "SepiaEffect.h"
 
+//Uniforms set every frame, hashed at compile time
+static constexpr UniformId u_Intensity("u_Intensity");
+
 void SepiaEffect::Init(unsigned width, unsigned height)
 {
     int index = int(_buffers.size());
@@ -9,17 +12,13 @@ void SepiaEffect::Init(unsigned width, unsigned height)
     _buffers[index]->Init(width, height);
 
     //Set up shaders
-    index = int(_shaders.size());
-    _shaders.push_back(Shader::Create());
-    _shaders[index]->LoadShaderPartFromFile("shaders/passthrough_vert.glsl", GL_VERTEX_SHADER);
-    _shaders[index]->LoadShaderPartFromFile("shaders/Post/sepia_frag.glsl", GL_FRAGMENT_SHADER);
-    _shaders[index]->Link();
+    _shaders.push_back(ShaderLibrary::LoadFromFiles("shaders/passthrough_vert.glsl", "shaders/Post/sepia_frag.glsl"));
 }
 
 void SepiaEffect::ApplyEffect(PostEffect* buffer)
 {
     BindShader(0);
-    _shaders[0]->SetUniform("u_Intensity", _intensity);
+    _shaders[0]->SetUniform(u_Intensity, _intensity);
 
     buffer->BindColorAsTexture(0, 0, 0);
 
@@ -30,6 +29,30 @@ void SepiaEffect::ApplyEffect(PostEffect* buffer)
     UnbindShader();
 }
 
+bool SepiaEffect::IsPointwise() const
+{
+    return true;
+}
+
+FusedStep SepiaEffect::GetFusedStep() const
+{
+    //Same maths as sepia_frag.glsl
+    return FusedStep{
+        "Sepia",
+        "uniform float {P}Intensity;\n",
+        "vec3 sepiaColor = vec3(\n"
+        "    dot(color.rgb, vec3(0.393, 0.769, 0.189)),\n"
+        "    dot(color.rgb, vec3(0.349, 0.686, 0.168)),\n"
+        "    dot(color.rgb, vec3(0.272, 0.534, 0.131)));\n"
+        "color.rgb = mix(color.rgb, sepiaColor, {P}Intensity);\n"
+    };
+}
+
+void SepiaEffect::SetFusedUniforms(const Shader::sptr& shader, const std::string& prefix, int& textureSlot)
+{
+    shader->SetUniform(prefix + "Intensity", _intensity);
+}
+
 float SepiaEffect::GetIntensity() const
 {
     return _intensity;
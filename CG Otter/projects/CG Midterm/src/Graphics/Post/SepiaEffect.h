@@ -11,6 +11,11 @@ public:
 	//Applies effect to this buffer
 	void ApplyEffect(PostEffect* buffer) override;
 
+	//Can be fused with other pointwise effects
+	bool IsPointwise() const override;
+	FusedStep GetFusedStep() const override;
+	void SetFusedUniforms(const Shader::sptr& shader, const std::string& prefix, int& textureSlot) override;
+
 	//Getters
 	float GetIntensity() const;
 
@@ -0,0 +1,120 @@
+#include "TAAEffect.h"
+
+//Uniforms set every frame, hashed at compile time
+static constexpr UniformId u_Feedback("u_Feedback");
+static constexpr UniformId u_ResetHistory("u_ResetHistory");
+
+void TAAEffect::Init(unsigned width, unsigned height)
+{
+	//Two buffers that swap between history and output every frame
+	//*Half float so the slow blend doesn't band
+	for (int i = 0; i < 2; i++)
+	{
+		int index = int(_buffers.size());
+		_buffers.push_back(new Framebuffer());
+		_buffers[index]->AddColorTarget(GL_RGBA16F);
+		_buffers[index]->Init(width, height);
+	}
+
+	//Loads the shaders
+	_shaders.push_back(ShaderLibrary::LoadFromFiles("shaders/passthrough_vert.glsl", "shaders/Post/taa_frag.glsl"));
+
+	glCreateSamplers(1, &_linearSampler);
+	glSamplerParameteri(_linearSampler, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glSamplerParameteri(_linearSampler, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glSamplerParameteri(_linearSampler, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glSamplerParameteri(_linearSampler, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+}
+
+void TAAEffect::ApplyEffect(PostEffect* buffer)
+{
+	//History from a different resolution doesn't line up
+	if (_renderScale != _historyScale)
+	{
+		_historyValid = false;
+		_historyScale = _renderScale;
+	}
+
+	BindShader(0);
+	_shaders[0]->SetUniform(u_Feedback, _feedback);
+	_shaders[0]->SetUniform(u_ResetHistory, _historyValid ? 0 : 1);
+
+	buffer->BindColorAsTexture(0, 0, 0);
+	BindColorAsTexture(0, 0, 1);
+	GLState::BindSampler(1, _linearSampler);
+	buffer->BindColorAsTexture(0, 1, 2);
+	buffer->BindDepthAsTexture(0, 3);
+
+	_buffers[1]->RenderToFSQ();
+
+	buffer->UnbindTexture(3);
+	buffer->UnbindTexture(2);
+	GLState::BindSampler(1, GL_NONE);
+	UnbindTexture(1);
+	buffer->UnbindTexture(0);
+
+	UnbindShader();
+
+	//Newest frame goes in slot 0, that's what the next effect reads and it's next frame's history
+	std::swap(_buffers[0], _buffers[1]);
+	_historyValid = true;
+}
+
+void TAAEffect::Reshape(unsigned width, unsigned height)
+{
+	PostEffect::Reshape(width, height);
+	ResetHistory();
+}
+
+void TAAEffect::Unload()
+{
+	if (_linearSampler != GL_NONE)
+	{
+		GLState::OnSamplerDeleted(_linearSampler);
+		glDeleteSamplers(1, &_linearSampler);
+		_linearSampler = GL_NONE;
+	}
+
+	PostEffect::Unload();
+}
+
+glm::vec2 TAAEffect::NextJitter()
+{
+	_frameIndex = (_frameIndex + 1) % NUM_JITTER_SAMPLES;
+
+	//Halton starts at 1, 0 would give us a sample on the corner every time round
+	glm::vec2 offset = glm::vec2(Halton(_frameIndex + 1, 2), Halton(_frameIndex + 1, 3)) - 0.5f;
+
+	//Pixels to NDC, one pixel is 2 / size since NDC spans -1 to 1
+	return offset * 2.0f / glm::vec2(_buffers[0]->GetRenderWidth(), _buffers[0]->GetRenderHeight());
+}
+
+void TAAEffect::ResetHistory()
+{
+	_historyValid = false;
+}
+
+float TAAEffect::GetFeedback() const
+{
+	return _feedback;
+}
+
+void TAAEffect::SetFeedback(float feedback)
+{
+	_feedback = feedback;
+}
+
+float TAAEffect::Halton(unsigned index, unsigned base)
+{
+	float result = 0.0f;
+	float fraction = 1.0f / base;
+
+	while (index > 0)
+	{
+		result += fraction * (index % base);
+		index /= base;
+		fraction /= base;
+	}
+
+	return result;
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include "Graphics/Post/PostEffect.h"
+
+//Temporal anti-aliasing
+//*The camera gets jittered by a sub-pixel amount every frame
+//*Each frame is blended into a history buffer that's reprojected with the scene's motion vectors
+//*History is clamped to the current frame's neighbourhood so moving stuff doesn't ghost
+class TAAEffect : public PostEffect
+{
+public:
+	//Initializes the two history buffers
+	//Overrides post effect Init
+	void Init(unsigned width, unsigned height) override;
+
+	//Resolves the previous buffer against the history
+	//*Previous buffer needs colour in attachment 0, velocity in attachment 1 and a depth target
+	void ApplyEffect(PostEffect* buffer) override;
+
+	//Reshapes the buffers and throws out the history
+	void Reshape(unsigned width, unsigned height) override;
+
+	//Deletes the history sampler along with the buffers
+	void Unload() override;
+
+	//Gives the camera jitter for this frame in NDC
+	//*Steps through a Halton(2, 3) sequence, call once per frame after setting the render scale
+	glm::vec2 NextJitter();
+
+	//Throws away the history (ex: camera cuts)
+	void ResetHistory();
+
+	//Getters
+	float GetFeedback() const;
+
+	//Setters
+	void SetFeedback(float feedback);
+private:
+	//Radical inverse of index in the given base, gives a nicely spread out sequence in 0-1
+	static float Halton(unsigned index, unsigned base);
+
+	//Length of the jitter pattern
+	static const unsigned NUM_JITTER_SAMPLES = 8;
+	unsigned _frameIndex = 0;
+
+	//Is there anything in the history worth blending with
+	bool _historyValid = false;
+	//Render scale the history was made at, it doesn't line up at any other scale
+	float _historyScale = 1.0f;
+
+	//Bilinear sampler for reading the history between pixels
+	GLuint _linearSampler = GL_NONE;
+
+	//How much of the history to keep each frame
+	float _feedback = 0.9f;
+};
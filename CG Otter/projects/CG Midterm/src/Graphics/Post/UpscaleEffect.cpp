@@ -0,0 +1,72 @@
+#include "UpscaleEffect.h"
+
+//Uniforms set every frame, hashed at compile time
+static constexpr UniformId u_Sharpness("u_Sharpness");
+
+void UpscaleEffect::Init(unsigned width, unsigned height)
+{
+	_width = width;
+	_height = height;
+
+	//Loads the shaders
+	_shaders.push_back(ShaderLibrary::LoadFromFiles("shaders/passthrough_vert.glsl", "shaders/Post/upscale_sharpen_frag.glsl"));
+
+	//Bilinear sampler so the upscale isn't blocky
+	glCreateSamplers(1, &_linearSampler);
+	glSamplerParameteri(_linearSampler, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glSamplerParameteri(_linearSampler, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glSamplerParameteri(_linearSampler, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glSamplerParameteri(_linearSampler, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+}
+
+void UpscaleEffect::ApplyEffect(PostEffect* buffer)
+{
+	//Match the region the previous effect rendered into
+	SetRenderScale(buffer->GetRenderScale());
+
+	//Draw to the back buffer at full window size
+	GLState::BindFramebuffer(GL_FRAMEBUFFER, GL_NONE);
+	glViewport(0, 0, _width, _height);
+
+	BindShader(0);
+	//No point sharpening if we're at native resolution
+	_shaders[0]->SetUniform(u_Sharpness, _renderScale < 1.0f ? _sharpness : 0.0f);
+
+	buffer->BindColorAsTexture(0, 0, 0);
+	GLState::BindSampler(0, _linearSampler);
+
+	Framebuffer::DrawFullscreenQuad();
+
+	GLState::BindSampler(0, GL_NONE);
+	buffer->UnbindTexture(0);
+
+	UnbindShader();
+}
+
+void UpscaleEffect::Reshape(unsigned width, unsigned height)
+{
+	_width = width;
+	_height = height;
+}
+
+void UpscaleEffect::Unload()
+{
+	if (_linearSampler != GL_NONE)
+	{
+		GLState::OnSamplerDeleted(_linearSampler);
+		glDeleteSamplers(1, &_linearSampler);
+		_linearSampler = GL_NONE;
+	}
+
+	PostEffect::Unload();
+}
+
+float UpscaleEffect::GetSharpness() const
+{
+	return _sharpness;
+}
+
+void UpscaleEffect::SetSharpness(float sharpness)
+{
+	_sharpness = sharpness;
+}
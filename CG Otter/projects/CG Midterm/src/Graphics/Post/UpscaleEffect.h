@@ -0,0 +1,38 @@
+#pragma once
+
+#include "Graphics/Post/PostEffect.h"
+
+//Final pass for dynamic resolution
+//*Stretches the render region of the previous effect over the whole back buffer
+//*Runs a light sharpen to win back some of the detail lost to the lower resolution
+class UpscaleEffect : public PostEffect
+{
+public:
+	//Initializes the shader and sampler
+	//*Has no framebuffers of its own, it draws straight to the back buffer
+	void Init(unsigned width, unsigned height) override;
+
+	//Upscales the previous buffer onto the back buffer
+	void ApplyEffect(PostEffect* buffer) override;
+
+	//Keeps track of the window size (nothing to reallocate)
+	void Reshape(unsigned width, unsigned height) override;
+
+	//Deletes the sampler along with the shaders
+	void Unload() override;
+
+	//Getters
+	float GetSharpness() const;
+
+	//Setters
+	void SetSharpness(float sharpness);
+private:
+	//Back buffer size
+	unsigned _width = 0;
+	unsigned _height = 0;
+
+	//Our framebuffers filter with GL_NEAREST, so we override it with a bilinear sampler here
+	GLuint _linearSampler = GL_NONE;
+
+	float _sharpness = 0.5f;
+};
@@ -0,0 +1,193 @@
+#include "RenderQueue.h"
+#include <algorithm>
+
+RenderQueue::RenderQueue()
+{
+}
+
+RenderQueue::~RenderQueue()
+{
+	Unload();
+}
+
+void RenderQueue::Init(entt::registry& registry)
+{
+	_registry = &registry;
+	_entries.clear();
+
+	//Start with whatever is already in the scene, it'll all get sorted on the first update
+	registry.view<RendererComponent>().each([&](entt::entity entity, RendererComponent& renderer) {
+		renderer.SortKeyDirty = true;
+		_entries.push_back({ 0, entity });
+	});
+
+	registry.on_construct<RendererComponent>().connect<&RenderQueue::OnConstruct>(*this);
+	registry.on_destroy<RendererComponent>().connect<&RenderQueue::OnDestroy>(*this);
+}
+
+void RenderQueue::Unload()
+{
+	if (_registry != nullptr)
+	{
+		_registry->on_construct<RendererComponent>().disconnect<&RenderQueue::OnConstruct>(*this);
+		_registry->on_destroy<RendererComponent>().disconnect<&RenderQueue::OnDestroy>(*this);
+		_registry = nullptr;
+	}
+}
+
+void RenderQueue::Update(const glm::mat4& view)
+{
+	_movedCount = 0;
+	_usedRadixSort = false;
+
+	//Only need the row that gives us view space z
+	glm::vec4 depthRow = glm::vec4(view[0][2], view[1][2], view[2][2], view[3][2]);
+
+	for (Entry& entry : _entries)
+	{
+		RendererComponent& renderer = _registry->get<RendererComponent>(entry.Entity);
+		const Transform& transform = _registry->get<Transform>(entry.Entity);
+
+		//Only chase the material pointer when something changed
+		if (renderer.SortKeyDirty)
+		{
+			const ShaderMaterial* material = Resources::Materials.Get(renderer.Material);
+			const VertexArrayObject* mesh = Resources::Meshes.Get(renderer.Mesh);
+			renderer.SortKey = MakeKey(material->RenderLayer, material->Shader->GetHandle(),
+				material->GetId(), mesh->GetHandle(), 0.0f);
+			renderer.SortKeyDirty = false;
+		}
+
+		//Camera looks down -z
+		float depth = -glm::dot(depthRow, transform.WorldTransform()[3]);
+		uint64_t key = renderer.SortKey | (MakeKey(0, 0, 0, 0, depth) & 0xFFFFull);
+
+		if (key != entry.Key)
+		{
+			entry.Key = key;
+			_movedCount++;
+		}
+	}
+
+	if (_movedCount == 0)
+		return;
+
+	if (_movedCount <= INSERTION_SORT_LIMIT)
+	{
+		InsertionSort();
+	}
+	else
+	{
+		RadixSort();
+		_usedRadixSort = true;
+	}
+}
+
+uint64_t RenderQueue::MakeKey(int layer, unsigned shaderId, unsigned materialId, unsigned meshId, float depth)
+{
+	//Layers can be negative, shift them so they still sort in order
+	uint64_t layerBits = uint64_t(glm::clamp(layer + 128, 0, 255));
+	//Front to back, so we get the most out of early depth testing
+	uint64_t depthBits = uint64_t(glm::clamp(depth / MAX_SORT_DEPTH, 0.0f, 1.0f) * 65535.0f);
+
+	//IDs that don't fit wrap around, that only costs us some batching, never correctness
+	return (layerBits << 56) |
+		(uint64_t(shaderId & 0xFFF) << 44) |
+		(uint64_t(materialId & 0xFFFF) << 28) |
+		(uint64_t(meshId & 0xFFF) << 16) |
+		depthBits;
+}
+
+const std::vector<RenderQueue::Entry>& RenderQueue::GetEntries() const
+{
+	return _entries;
+}
+
+unsigned RenderQueue::GetMovedCount() const
+{
+	return _movedCount;
+}
+
+bool RenderQueue::GetUsedRadixSort() const
+{
+	return _usedRadixSort;
+}
+
+void RenderQueue::OnConstruct(entt::registry& registry, entt::entity entity)
+{
+	//Lands at the end with a key of 0, so it counts as moved on the next update
+	_entries.push_back({ 0, entity });
+}
+
+void RenderQueue::OnDestroy(entt::registry& registry, entt::entity entity)
+{
+	auto it = std::find_if(_entries.begin(), _entries.end(), [&](const Entry& entry) { return entry.Entity == entity; });
+	if (it != _entries.end())
+	{
+		//Erase rather than swap so the rest stays sorted
+		_entries.erase(it);
+	}
+}
+
+void RenderQueue::RadixSort()
+{
+	const size_t count = _entries.size();
+	_scratch.resize(count);
+
+	//Count every byte of every key in one go
+	size_t histograms[8][256] = {};
+	for (const Entry& entry : _entries)
+	{
+		for (int pass = 0; pass < 8; pass++)
+		{
+			histograms[pass][(entry.Key >> (pass * 8)) & 0xFF]++;
+		}
+	}
+
+	Entry* source = _entries.data();
+	Entry* dest = _scratch.data();
+	for (int pass = 0; pass < 8; pass++)
+	{
+		size_t* histogram = histograms[pass];
+		const int shift = pass * 8;
+
+		//Every key has the same byte here, this pass wouldn't move anything
+		if (histogram[(source[0].Key >> shift) & 0xFF] == count)
+			continue;
+
+		//Turn the counts into where each bucket starts
+		size_t offset = 0;
+		for (int i = 0; i < 256; i++)
+		{
+			size_t bucketSize = histogram[i];
+			histogram[i] = offset;
+			offset += bucketSize;
+		}
+
+		for (size_t i = 0; i < count; i++)
+		{
+			dest[histogram[(source[i].Key >> shift) & 0xFF]++] = source[i];
+		}
+		std::swap(source, dest);
+	}
+
+	//Odd number of passes leaves the result in the scratch buffer
+	if (source != _entries.data())
+	{
+		_entries.swap(_scratch);
+	}
+}
+
+void RenderQueue::InsertionSort()
+{
+	for (size_t i = 1; i < _entries.size(); i++)
+	{
+		Entry value = _entries[i];
+		size_t j = i;
+		for (; j > 0 && value.Key < _entries[j - 1].Key; j--)
+		{
+			_entries[j] = _entries[j - 1];
+		}
+		_entries[j] = value;
+	}
+}
@@ -0,0 +1,66 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include <entt.hpp>
+#include <GLM/glm.hpp>
+#include <RendererComponent.h>
+#include <Transform.h>
+
+//Keeps every renderer in the scene in draw order from frame to frame
+//*Each renderer gets a packed 64 bit key, highest bits first:
+//*	layer (8) | shader (12) | material (16) | mesh (12) | depth (16)
+//*The layer/shader/material/mesh part is cached on the component and only rebuilt when it changes
+//*The list stays sorted between frames, so we only fix up entries whose key moved
+class RenderQueue
+{
+public:
+	struct Entry
+	{
+		uint64_t Key;
+		entt::entity Entity;
+	};
+
+	RenderQueue();
+	~RenderQueue();
+
+	//Picks up every renderer already in the registry and listens for new ones
+	void Init(entt::registry& registry);
+	//Stops listening to the registry
+	void Unload();
+
+	//Refreshes the keys and sorts the list
+	//*view is the camera's view matrix, used for the depth bits
+	void Update(const glm::mat4& view);
+
+	//Builds a key, depth is the distance in front of the camera
+	static uint64_t MakeKey(int layer, unsigned shaderId, unsigned materialId, unsigned meshId, float depth);
+
+	//Getters
+	const std::vector<Entry>& GetEntries() const;
+	//How many keys changed last update
+	unsigned GetMovedCount() const;
+	//Did the last update need a full radix sort
+	bool GetUsedRadixSort() const;
+private:
+	//Registry listeners
+	void OnConstruct(entt::registry& registry, entt::entity entity);
+	void OnDestroy(entt::registry& registry, entt::entity entity);
+
+	//LSD radix sort, 8 bits a pass, skipping passes where every key has the same byte
+	void RadixSort();
+	//Cheap when the list is almost sorted already
+	void InsertionSort();
+
+	//At or below this many moved keys we fix up with insertion sort
+	static const unsigned INSERTION_SORT_LIMIT = 16;
+	//Anything further away than this gets the same depth bits
+	static constexpr float MAX_SORT_DEPTH = 500.0f;
+
+	entt::registry* _registry = nullptr;
+	std::vector<Entry> _entries;
+	//Ping-pong buffer for the radix sort
+	std::vector<Entry> _scratch;
+
+	unsigned _movedCount = 0;
+	bool _usedRadixSort = false;
+};
@@ -0,0 +1,852 @@
+#include "SpatialIndex.h"
+#include "FrustumCuller.h"
+#include <algorithm>
+#include <cfloat>
+
+//Slab test, gives back the distance the ray enters the box at
+static bool RayBox(const glm::vec3& origin, const glm::vec3& invDirection, const glm::vec3& min, const glm::vec3& max, float maxDistance, float& enter)
+{
+	glm::vec3 t0 = (min - origin) * invDirection;
+	glm::vec3 t1 = (max - origin) * invDirection;
+	glm::vec3 tNear = glm::min(t0, t1);
+	glm::vec3 tFar = glm::max(t0, t1);
+
+	enter = glm::max(glm::max(tNear.x, tNear.y), glm::max(tNear.z, 0.0f));
+	float exit = glm::min(glm::min(tFar.x, tFar.y), glm::min(tFar.z, maxDistance));
+	return enter <= exit;
+}
+
+static bool Overlaps(const glm::vec3& minA, const glm::vec3& maxA, const glm::vec3& minB, const glm::vec3& maxB)
+{
+	return glm::all(glm::lessThanEqual(minA, maxB)) && glm::all(glm::lessThanEqual(minB, maxA));
+}
+
+SpatialIndex::SpatialIndex()
+{
+}
+
+SpatialIndex::~SpatialIndex()
+{
+	Unload();
+}
+
+void SpatialIndex::Init(entt::registry& registry)
+{
+	Unload();
+	_registry = &registry;
+
+	//Start with whatever is already in the scene, it all goes in on the first update
+	registry.view<RendererComponent>().each([&](entt::entity entity, RendererComponent&) {
+		OnConstruct(registry, entity);
+	});
+
+	registry.on_construct<RendererComponent>().connect<&SpatialIndex::OnConstruct>(*this);
+	registry.on_destroy<RendererComponent>().connect<&SpatialIndex::OnDestroy>(*this);
+}
+
+void SpatialIndex::Unload()
+{
+	if (_registry != nullptr)
+	{
+		_registry->on_construct<RendererComponent>().disconnect<&SpatialIndex::OnConstruct>(*this);
+		_registry->on_destroy<RendererComponent>().disconnect<&SpatialIndex::OnDestroy>(*this);
+		_registry = nullptr;
+	}
+
+	_nodes.clear();
+	_root = NULL_NODE;
+	_freeList = NULL_NODE;
+	_nodeCount = 0;
+	_proxies.clear();
+	_proxyLookup.clear();
+	_builtCost = 0.0f;
+}
+
+void SpatialIndex::Update()
+{
+	_reinsertCount = 0;
+
+	for (unsigned i = 0; i < _proxies.size(); i++)
+	{
+		const RendererComponent& renderer = _registry->get<RendererComponent>(_proxies[i].Entity);
+		const Transform& transform = _registry->get<Transform>(_proxies[i].Entity);
+
+		//Nothing moved, nothing to do
+		if (_proxies[i].Mesh == Resources::Meshes.Get(renderer.Mesh) &&
+			_proxies[i].WorldVersion == transform.GetWorldVersion())
+			continue;
+
+		if (!ComputeBounds(_proxies[i], renderer, transform))
+		{
+			//Lost its bounds, take it out of the tree
+			if (_proxies[i].Node != NULL_NODE)
+			{
+				RemoveLeaf(_proxies[i].Node);
+				FreeNode(_proxies[i].Node);
+				_proxies[i].Node = NULL_NODE;
+			}
+			continue;
+		}
+
+		if (_proxies[i].Node != NULL_NODE)
+		{
+			//Still inside the fat box, the tree doesn't need to know
+			const Node& leaf = _nodes[_proxies[i].Node];
+			if (glm::all(glm::greaterThanEqual(_proxies[i].Min, leaf.Min)) && glm::all(glm::lessThanEqual(_proxies[i].Max, leaf.Max)))
+				continue;
+
+			RemoveLeaf(_proxies[i].Node);
+		}
+		else
+		{
+			int node = AllocateNode();
+			_nodes[node].Proxy = int(i);
+			_proxies[i].Node = node;
+		}
+
+		Node& leaf = _nodes[_proxies[i].Node];
+		glm::vec3 margin = (_proxies[i].Max - _proxies[i].Min) * FAT_SCALE + FAT_MARGIN;
+		leaf.Min = _proxies[i].Min - margin;
+		leaf.Max = _proxies[i].Max + margin;
+
+		InsertLeaf(_proxies[i].Node);
+		_reinsertCount++;
+	}
+
+	//Incremental inserts slowly make the tree worse, start over once it's bad enough
+	if (_reinsertCount > 0 && GetCost() > _builtCost * REBUILD_RATIO)
+	{
+		Rebuild();
+	}
+}
+
+void SpatialIndex::Rebuild()
+{
+	_leaves.clear();
+	for (unsigned i = 0; i < _nodes.size(); i++)
+	{
+		if (_nodes[i].Height == 0)
+		{
+			_leaves.push_back(int(i));
+		}
+		//Internal nodes all get rebuilt
+		else if (_nodes[i].Height > 0)
+		{
+			FreeNode(int(i));
+		}
+	}
+
+	_root = _leaves.empty() ? NULL_NODE : BuildRange(_leaves, 0, int(_leaves.size()), NULL_NODE);
+	_builtCost = GetCost();
+	_rebuildCount++;
+}
+
+void SpatialIndex::CullFrustum(const glm::mat4& viewProjection)
+{
+	_frame++;
+	_visibleCount = 0;
+
+	//Anything without bounds is always visible
+	for (const Proxy& proxy : _proxies)
+	{
+		_visibleCount += proxy.Node == NULL_NODE ? 1 : 0;
+	}
+
+	VisitFrustum(viewProjection, [this](int proxy) {
+		_proxies[proxy].VisibleFrame = _frame;
+		_visibleCount++;
+	});
+}
+
+bool SpatialIndex::IsVisible(entt::entity entity) const
+{
+	auto it = _proxyLookup.find(entity);
+	//Hasn't made it into the index yet, don't hide it
+	if (it == _proxyLookup.end())
+		return true;
+
+	const Proxy& proxy = _proxies[it->second];
+	return proxy.Node == NULL_NODE || proxy.VisibleFrame == _frame;
+}
+
+bool SpatialIndex::GetBounds(entt::entity entity, glm::vec3& min, glm::vec3& max) const
+{
+	auto it = _proxyLookup.find(entity);
+	if (it == _proxyLookup.end() || _proxies[it->second].Node == NULL_NODE)
+		return false;
+
+	min = _proxies[it->second].Min;
+	max = _proxies[it->second].Max;
+	return true;
+}
+
+void SpatialIndex::QueryFrustum(const glm::mat4& viewProjection, std::vector<entt::entity>& results) const
+{
+	VisitFrustum(viewProjection, [&](int proxy) {
+		results.push_back(_proxies[proxy].Entity);
+	});
+}
+
+void SpatialIndex::QueryBox(const glm::vec3& min, const glm::vec3& max, std::vector<entt::entity>& results) const
+{
+	_nodesVisited = 0;
+	if (_root == NULL_NODE)
+		return;
+
+	_stack.clear();
+	_stack.push_back(_root);
+	while (!_stack.empty())
+	{
+		int index = _stack.back();
+		_stack.pop_back();
+		_nodesVisited++;
+
+		const Node& node = _nodes[index];
+		if (!Overlaps(node.Min, node.Max, min, max))
+			continue;
+
+		if (node.IsLeaf())
+		{
+			//Fat boxes can overlap when the real one doesn't
+			const Proxy& proxy = _proxies[node.Proxy];
+			if (Overlaps(proxy.Min, proxy.Max, min, max))
+			{
+				results.push_back(proxy.Entity);
+			}
+		}
+		else
+		{
+			_stack.push_back(node.Left);
+			_stack.push_back(node.Right);
+		}
+	}
+}
+
+bool SpatialIndex::RayCast(const glm::vec3& origin, const glm::vec3& direction, float maxDistance, entt::entity& hit, float& distance) const
+{
+	_nodesVisited = 0;
+	if (_root == NULL_NODE)
+		return false;
+
+	//Divide by zero gives infinity, which the slab test handles fine
+	glm::vec3 invDirection = 1.0f / direction;
+	float closest = maxDistance;
+	bool found = false;
+
+	_stack.clear();
+	_stack.push_back(_root);
+	while (!_stack.empty())
+	{
+		int index = _stack.back();
+		_stack.pop_back();
+		_nodesVisited++;
+
+		const Node& node = _nodes[index];
+		float enter;
+		//Skip anything that starts further away than what we've already hit
+		if (!RayBox(origin, invDirection, node.Min, node.Max, closest, enter))
+			continue;
+
+		if (node.IsLeaf())
+		{
+			const Proxy& proxy = _proxies[node.Proxy];
+			if (RayBox(origin, invDirection, proxy.Min, proxy.Max, closest, enter))
+			{
+				closest = enter;
+				hit = proxy.Entity;
+				found = true;
+			}
+		}
+		else
+		{
+			_stack.push_back(node.Left);
+			_stack.push_back(node.Right);
+		}
+	}
+
+	distance = closest;
+	return found;
+}
+
+unsigned SpatialIndex::GetProxyCount() const
+{
+	return unsigned(_proxies.size());
+}
+
+unsigned SpatialIndex::GetNodeCount() const
+{
+	return _nodeCount;
+}
+
+int SpatialIndex::GetHeight() const
+{
+	return _root == NULL_NODE ? 0 : _nodes[_root].Height;
+}
+
+unsigned SpatialIndex::GetVisibleCount() const
+{
+	return _visibleCount;
+}
+
+unsigned SpatialIndex::GetNodesVisited() const
+{
+	return _nodesVisited;
+}
+
+unsigned SpatialIndex::GetReinsertCount() const
+{
+	return _reinsertCount;
+}
+
+unsigned SpatialIndex::GetRebuildCount() const
+{
+	return _rebuildCount;
+}
+
+float SpatialIndex::GetCost() const
+{
+	if (_root == NULL_NODE || _nodes[_root].IsLeaf())
+		return 0.0f;
+
+	float cost = 0.0f;
+	for (const Node& node : _nodes)
+	{
+		if (node.Height > 0)
+		{
+			cost += SurfaceArea(node.Min, node.Max);
+		}
+	}
+	return cost / glm::max(SurfaceArea(_nodes[_root].Min, _nodes[_root].Max), 1e-6f);
+}
+
+void SpatialIndex::OnConstruct(entt::registry& registry, entt::entity entity)
+{
+	Proxy proxy;
+	proxy.Entity = entity;
+	proxy.Node = NULL_NODE;
+	//Transforms are on version 1 after their first update, so the first update always picks it up
+	proxy.World = glm::mat4(0.0f);
+	proxy.WorldVersion = 0;
+	proxy.Mesh = nullptr;
+	proxy.Min = glm::vec3(0.0f);
+	proxy.Max = glm::vec3(0.0f);
+	proxy.VisibleFrame = _frame;
+
+	_proxyLookup[entity] = unsigned(_proxies.size());
+	_proxies.push_back(proxy);
+}
+
+void SpatialIndex::OnDestroy(entt::registry& registry, entt::entity entity)
+{
+	auto it = _proxyLookup.find(entity);
+	if (it == _proxyLookup.end())
+		return;
+
+	unsigned index = it->second;
+	if (_proxies[index].Node != NULL_NODE)
+	{
+		RemoveLeaf(_proxies[index].Node);
+		FreeNode(_proxies[index].Node);
+	}
+
+	//Swap the last proxy into the hole
+	_proxies[index] = _proxies.back();
+	_proxies.pop_back();
+	_proxyLookup.erase(it);
+
+	if (index < _proxies.size())
+	{
+		_proxyLookup[_proxies[index].Entity] = index;
+		if (_proxies[index].Node != NULL_NODE)
+		{
+			_nodes[_proxies[index].Node].Proxy = int(index);
+		}
+	}
+}
+
+bool SpatialIndex::ComputeBounds(Proxy& proxy, const RendererComponent& renderer, const Transform& transform)
+{
+	proxy.World = transform.WorldTransform();
+	proxy.WorldVersion = transform.GetWorldVersion();
+	proxy.Mesh = Resources::Meshes.Get(renderer.Mesh);
+
+	if (proxy.Mesh == nullptr || !proxy.Mesh->HasBounds())
+		return false;
+
+	//Transform the center, the half size grows by the absolute value of the rotation/scale
+	glm::vec3 center = (proxy.Mesh->GetBoundsMin() + proxy.Mesh->GetBoundsMax()) * 0.5f;
+	glm::vec3 extent = (proxy.Mesh->GetBoundsMax() - proxy.Mesh->GetBoundsMin()) * 0.5f;
+
+	glm::vec3 worldCenter = glm::vec3(proxy.World * glm::vec4(center, 1.0f));
+	glm::mat3 absolute = glm::mat3(proxy.World);
+	for (int i = 0; i < 3; i++)
+	{
+		absolute[i] = glm::abs(absolute[i]);
+	}
+	glm::vec3 worldExtent = absolute * extent;
+
+	proxy.Min = worldCenter - worldExtent;
+	proxy.Max = worldCenter + worldExtent;
+	return true;
+}
+
+int SpatialIndex::AllocateNode()
+{
+	int index;
+	if (_freeList == NULL_NODE)
+	{
+		index = int(_nodes.size());
+		_nodes.emplace_back();
+	}
+	else
+	{
+		index = _freeList;
+		_freeList = _nodes[index].Parent;
+	}
+
+	Node& node = _nodes[index];
+	node.Min = glm::vec3(0.0f);
+	node.Max = glm::vec3(0.0f);
+	node.Parent = NULL_NODE;
+	node.Left = NULL_NODE;
+	node.Right = NULL_NODE;
+	node.Proxy = NULL_NODE;
+	node.Height = 0;
+
+	_nodeCount++;
+	return index;
+}
+
+void SpatialIndex::FreeNode(int node)
+{
+	_nodes[node].Parent = _freeList;
+	_nodes[node].Height = -1;
+	_freeList = node;
+	_nodeCount--;
+}
+
+void SpatialIndex::InsertLeaf(int leaf)
+{
+	if (_root == NULL_NODE)
+	{
+		_root = leaf;
+		_nodes[leaf].Parent = NULL_NODE;
+		return;
+	}
+
+	//Walk down picking whichever side makes the tree's surface area grow the least
+	glm::vec3 leafMin = _nodes[leaf].Min;
+	glm::vec3 leafMax = _nodes[leaf].Max;
+	int index = _root;
+	while (!_nodes[index].IsLeaf())
+	{
+		const Node& node = _nodes[index];
+		float area = SurfaceArea(node.Min, node.Max);
+		float combinedArea = SurfaceArea(glm::min(node.Min, leafMin), glm::max(node.Max, leafMax));
+
+		//Cost of making a new parent for this node and the leaf
+		float cost = 2.0f * combinedArea;
+		//Everything further down pays for this node growing
+		float inheritanceCost = 2.0f * (combinedArea - area);
+
+		float childCost[2];
+		int children[2] = { node.Left, node.Right };
+		for (int i = 0; i < 2; i++)
+		{
+			const Node& child = _nodes[children[i]];
+			float grown = SurfaceArea(glm::min(child.Min, leafMin), glm::max(child.Max, leafMax));
+			childCost[i] = (child.IsLeaf() ? grown : grown - SurfaceArea(child.Min, child.Max)) + inheritanceCost;
+		}
+
+		if (cost < childCost[0] && cost < childCost[1])
+			break;
+
+		index = childCost[0] < childCost[1] ? children[0] : children[1];
+	}
+
+	//Put a new parent in between the sibling and its old parent
+	int sibling = index;
+	int oldParent = _nodes[sibling].Parent;
+	int newParent = AllocateNode();
+
+	Node& parent = _nodes[newParent];
+	parent.Parent = oldParent;
+	parent.Min = glm::min(_nodes[sibling].Min, leafMin);
+	parent.Max = glm::max(_nodes[sibling].Max, leafMax);
+	parent.Height = _nodes[sibling].Height + 1;
+	parent.Left = sibling;
+	parent.Right = leaf;
+
+	if (oldParent != NULL_NODE)
+	{
+		if (_nodes[oldParent].Left == sibling)
+			_nodes[oldParent].Left = newParent;
+		else
+			_nodes[oldParent].Right = newParent;
+	}
+	else
+	{
+		_root = newParent;
+	}
+
+	_nodes[sibling].Parent = newParent;
+	_nodes[leaf].Parent = newParent;
+
+	Refit(newParent);
+}
+
+void SpatialIndex::RemoveLeaf(int leaf)
+{
+	if (leaf == _root)
+	{
+		_root = NULL_NODE;
+		return;
+	}
+
+	//The sibling takes the parent's place
+	int parent = _nodes[leaf].Parent;
+	int grandParent = _nodes[parent].Parent;
+	int sibling = _nodes[parent].Left == leaf ? _nodes[parent].Right : _nodes[parent].Left;
+
+	if (grandParent != NULL_NODE)
+	{
+		if (_nodes[grandParent].Left == parent)
+			_nodes[grandParent].Left = sibling;
+		else
+			_nodes[grandParent].Right = sibling;
+		_nodes[sibling].Parent = grandParent;
+		FreeNode(parent);
+
+		Refit(grandParent);
+	}
+	else
+	{
+		_root = sibling;
+		_nodes[sibling].Parent = NULL_NODE;
+		FreeNode(parent);
+	}
+}
+
+int SpatialIndex::Balance(int iA)
+{
+	Node* A = &_nodes[iA];
+	if (A->IsLeaf() || A->Height < 2)
+		return iA;
+
+	int iB = A->Left;
+	int iC = A->Right;
+	Node* B = &_nodes[iB];
+	Node* C = &_nodes[iC];
+
+	int balance = C->Height - B->Height;
+
+	//Right side is too tall, rotate C up
+	if (balance > 1)
+	{
+		int iF = C->Left;
+		int iG = C->Right;
+		Node* F = &_nodes[iF];
+		Node* G = &_nodes[iG];
+
+		C->Left = iA;
+		C->Parent = A->Parent;
+		A->Parent = iC;
+
+		if (C->Parent != NULL_NODE)
+		{
+			if (_nodes[C->Parent].Left == iA)
+				_nodes[C->Parent].Left = iC;
+			else
+				_nodes[C->Parent].Right = iC;
+		}
+		else
+		{
+			_root = iC;
+		}
+
+		//Keep the taller of C's children, the other one goes to A
+		if (F->Height > G->Height)
+		{
+			C->Right = iF;
+			A->Right = iG;
+			G->Parent = iA;
+			A->Min = glm::min(B->Min, G->Min);
+			A->Max = glm::max(B->Max, G->Max);
+			C->Min = glm::min(A->Min, F->Min);
+			C->Max = glm::max(A->Max, F->Max);
+			A->Height = 1 + glm::max(B->Height, G->Height);
+			C->Height = 1 + glm::max(A->Height, F->Height);
+		}
+		else
+		{
+			C->Right = iG;
+			A->Right = iF;
+			F->Parent = iA;
+			A->Min = glm::min(B->Min, F->Min);
+			A->Max = glm::max(B->Max, F->Max);
+			C->Min = glm::min(A->Min, G->Min);
+			C->Max = glm::max(A->Max, G->Max);
+			A->Height = 1 + glm::max(B->Height, F->Height);
+			C->Height = 1 + glm::max(A->Height, G->Height);
+		}
+
+		return iC;
+	}
+
+	//Left side is too tall, rotate B up
+	if (balance < -1)
+	{
+		int iD = B->Left;
+		int iE = B->Right;
+		Node* D = &_nodes[iD];
+		Node* E = &_nodes[iE];
+
+		B->Left = iA;
+		B->Parent = A->Parent;
+		A->Parent = iB;
+
+		if (B->Parent != NULL_NODE)
+		{
+			if (_nodes[B->Parent].Left == iA)
+				_nodes[B->Parent].Left = iB;
+			else
+				_nodes[B->Parent].Right = iB;
+		}
+		else
+		{
+			_root = iB;
+		}
+
+		//Keep the taller of B's children, the other one goes to A
+		if (D->Height > E->Height)
+		{
+			B->Right = iD;
+			A->Left = iE;
+			E->Parent = iA;
+			A->Min = glm::min(C->Min, E->Min);
+			A->Max = glm::max(C->Max, E->Max);
+			B->Min = glm::min(A->Min, D->Min);
+			B->Max = glm::max(A->Max, D->Max);
+			A->Height = 1 + glm::max(C->Height, E->Height);
+			B->Height = 1 + glm::max(A->Height, D->Height);
+		}
+		else
+		{
+			B->Right = iE;
+			A->Left = iD;
+			D->Parent = iA;
+			A->Min = glm::min(C->Min, D->Min);
+			A->Max = glm::max(C->Max, D->Max);
+			B->Min = glm::min(A->Min, E->Min);
+			B->Max = glm::max(A->Max, E->Max);
+			A->Height = 1 + glm::max(C->Height, D->Height);
+			B->Height = 1 + glm::max(A->Height, E->Height);
+		}
+
+		return iB;
+	}
+
+	return iA;
+}
+
+void SpatialIndex::Refit(int index)
+{
+	while (index != NULL_NODE)
+	{
+		index = Balance(index);
+
+		Node& node = _nodes[index];
+		const Node& left = _nodes[node.Left];
+		const Node& right = _nodes[node.Right];
+		node.Height = 1 + glm::max(left.Height, right.Height);
+		node.Min = glm::min(left.Min, right.Min);
+		node.Max = glm::max(left.Max, right.Max);
+
+		index = node.Parent;
+	}
+}
+
+int SpatialIndex::BuildRange(std::vector<int>& leaves, int first, int last, int parent)
+{
+	if (last - first == 1)
+	{
+		_nodes[leaves[first]].Parent = parent;
+		return leaves[first];
+	}
+
+	//Split along whichever axis the centroids are most spread out on
+	glm::vec3 centroidMin = glm::vec3(FLT_MAX);
+	glm::vec3 centroidMax = glm::vec3(-FLT_MAX);
+	for (int i = first; i < last; i++)
+	{
+		glm::vec3 centroid = (_nodes[leaves[i]].Min + _nodes[leaves[i]].Max) * 0.5f;
+		centroidMin = glm::min(centroidMin, centroid);
+		centroidMax = glm::max(centroidMax, centroid);
+	}
+	glm::vec3 spread = centroidMax - centroidMin;
+	int axis = spread.x > spread.y ? (spread.x > spread.z ? 0 : 2) : (spread.y > spread.z ? 1 : 2);
+
+	int mid = (first + last) / 2;
+	if (spread[axis] > 1e-6f)
+	{
+		auto binOf = [&](int leaf) {
+			float centroid = (_nodes[leaf].Min[axis] + _nodes[leaf].Max[axis]) * 0.5f;
+			return glm::min(SAH_BINS - 1, int(SAH_BINS * (centroid - centroidMin[axis]) / spread[axis]));
+		};
+
+		int binCount[SAH_BINS] = { };
+		glm::vec3 binMin[SAH_BINS];
+		glm::vec3 binMax[SAH_BINS];
+		for (int b = 0; b < SAH_BINS; b++)
+		{
+			binMin[b] = glm::vec3(FLT_MAX);
+			binMax[b] = glm::vec3(-FLT_MAX);
+		}
+		for (int i = first; i < last; i++)
+		{
+			int b = binOf(leaves[i]);
+			binCount[b]++;
+			binMin[b] = glm::min(binMin[b], _nodes[leaves[i]].Min);
+			binMax[b] = glm::max(binMax[b], _nodes[leaves[i]].Max);
+		}
+
+		//Sweep from the right so each split knows the cost of everything after it
+		float rightCost[SAH_BINS];
+		glm::vec3 sweepMin = glm::vec3(FLT_MAX);
+		glm::vec3 sweepMax = glm::vec3(-FLT_MAX);
+		int sweepCount = 0;
+		for (int b = SAH_BINS - 1; b > 0; b--)
+		{
+			sweepMin = glm::min(sweepMin, binMin[b]);
+			sweepMax = glm::max(sweepMax, binMax[b]);
+			sweepCount += binCount[b];
+			rightCost[b] = sweepCount ? SurfaceArea(sweepMin, sweepMax) * sweepCount : 0.0f;
+		}
+
+		//Then from the left, splitting before bin b
+		int bestSplit = 0;
+		float bestCost = FLT_MAX;
+		sweepMin = glm::vec3(FLT_MAX);
+		sweepMax = glm::vec3(-FLT_MAX);
+		sweepCount = 0;
+		for (int b = 1; b < SAH_BINS; b++)
+		{
+			sweepMin = glm::min(sweepMin, binMin[b - 1]);
+			sweepMax = glm::max(sweepMax, binMax[b - 1]);
+			sweepCount += binCount[b - 1];
+			float cost = (sweepCount ? SurfaceArea(sweepMin, sweepMax) * sweepCount : 0.0f) + rightCost[b];
+			if (cost < bestCost)
+			{
+				bestCost = cost;
+				bestSplit = b;
+			}
+		}
+
+		int* split = std::partition(&leaves[first], &leaves[first] + (last - first), [&](int leaf) {
+			return binOf(leaf) < bestSplit;
+		});
+		int splitIndex = int(split - &leaves[0]);
+
+		//Everything landed on one side, fall back to splitting down the middle
+		if (splitIndex != first && splitIndex != last)
+		{
+			mid = splitIndex;
+		}
+	}
+
+	int index = AllocateNode();
+	int left = BuildRange(leaves, first, mid, index);
+	int right = BuildRange(leaves, mid, last, index);
+
+	Node& node = _nodes[index];
+	node.Parent = parent;
+	node.Left = left;
+	node.Right = right;
+	node.Height = 1 + glm::max(_nodes[left].Height, _nodes[right].Height);
+	node.Min = glm::min(_nodes[left].Min, _nodes[right].Min);
+	node.Max = glm::max(_nodes[left].Max, _nodes[right].Max);
+	return index;
+}
+
+template <typename Visitor>
+void SpatialIndex::VisitFrustum(const glm::mat4& viewProjection, Visitor visitor) const
+{
+	_nodesVisited = 0;
+	if (_root == NULL_NODE)
+		return;
+
+	glm::vec4 planes[6];
+	FrustumCuller::ExtractPlanes(viewProjection, planes);
+
+	//Each entry carries a mask of the planes the node still straddles
+	//*Once a node is fully inside a plane none of its children need that plane tested again
+	const int ALL_PLANES = (1 << 6) - 1;
+	_stack.clear();
+	_stack.push_back(_root);
+	_stack.push_back(ALL_PLANES);
+	while (!_stack.empty())
+	{
+		int mask = _stack.back();
+		_stack.pop_back();
+		int index = _stack.back();
+		_stack.pop_back();
+		_nodesVisited++;
+
+		const Node& node = _nodes[index];
+		glm::vec3 center = (node.Min + node.Max) * 0.5f;
+		glm::vec3 extent = (node.Max - node.Min) * 0.5f;
+
+		bool outside = false;
+		for (int p = 0; p < 6 && !outside; p++)
+		{
+			if (!(mask & (1 << p)))
+				continue;
+
+			float distance = glm::dot(glm::vec3(planes[p]), center) + planes[p].w;
+			float reach = glm::dot(glm::abs(glm::vec3(planes[p])), extent);
+			if (distance < -reach)
+				outside = true;
+			else if (distance >= reach)
+				mask &= ~(1 << p);
+		}
+
+		if (outside)
+			continue;
+
+		if (mask == 0)
+		{
+			VisitSubtree(index, visitor);
+		}
+		else if (node.IsLeaf())
+		{
+			visitor(node.Proxy);
+		}
+		else
+		{
+			_stack.push_back(node.Left);
+			_stack.push_back(mask);
+			_stack.push_back(node.Right);
+			_stack.push_back(mask);
+		}
+	}
+}
+
+template <typename Visitor>
+void SpatialIndex::VisitSubtree(int index, Visitor visitor) const
+{
+	const Node& node = _nodes[index];
+	if (node.IsLeaf())
+	{
+		visitor(node.Proxy);
+		return;
+	}
+
+	VisitSubtree(node.Left, visitor);
+	VisitSubtree(node.Right, visitor);
+}
+
+float SpatialIndex::SurfaceArea(const glm::vec3& min, const glm::vec3& max)
+{
+	glm::vec3 size = max - min;
+	return 2.0f * (size.x * size.y + size.y * size.z + size.z * size.x);
+}
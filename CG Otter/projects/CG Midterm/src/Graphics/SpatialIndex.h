@@ -0,0 +1,147 @@
+#pragma once
+#include <vector>
+#include <unordered_map>
+#include <entt.hpp>
+#include <GLM/glm.hpp>
+#include <RendererComponent.h>
+#include <Transform.h>
+
+//Dynamic AABB tree over every renderer in the scene
+//*Leaves hold a slightly fattened world space box, so small moves don't touch the tree at all
+//*Anything that moves out of its fat box gets pulled out and reinserted, with rotations to keep it balanced
+//*When the tree gets too much worse than it was after the last build we rebuild it top down with binned SAH
+//*Renderers whose mesh has no bounds aren't in the tree and always count as visible
+class SpatialIndex
+{
+public:
+	SpatialIndex();
+	~SpatialIndex();
+
+	//Picks up every renderer already in the registry and listens for new ones
+	void Init(entt::registry& registry);
+	//Stops listening to the registry
+	void Unload();
+
+	//Refits anything whose world matrix or mesh changed since the last update
+	void Update();
+	//Throws everything away and builds the tree again from scratch
+	void Rebuild();
+
+	//Marks everything inside the frustum as visible for this frame
+	void CullFrustum(const glm::mat4& viewProjection);
+	//Was the entity inside the frustum on the last cull
+	bool IsVisible(entt::entity entity) const;
+	//Tight world space box from the last update, returns false if the entity has no bounds
+	bool GetBounds(entt::entity entity, glm::vec3& min, glm::vec3& max) const;
+
+	//Spatial queries, results are appended
+	void QueryFrustum(const glm::mat4& viewProjection, std::vector<entt::entity>& results) const;
+	void QueryBox(const glm::vec3& min, const glm::vec3& max, std::vector<entt::entity>& results) const;
+	//Finds the closest renderer box along the ray, returns false on a miss
+	bool RayCast(const glm::vec3& origin, const glm::vec3& direction, float maxDistance, entt::entity& hit, float& distance) const;
+
+	//Getters
+	unsigned GetProxyCount() const;
+	unsigned GetNodeCount() const;
+	int GetHeight() const;
+	unsigned GetVisibleCount() const;
+	unsigned GetNodesVisited() const;
+	unsigned GetReinsertCount() const;
+	unsigned GetRebuildCount() const;
+	//Surface area of every internal node over the root's, lower is better
+	float GetCost() const;
+
+	//Rebuild once the cost grows this much past what the last build gave us
+	static constexpr float REBUILD_RATIO = 1.5f;
+	//How far to fatten leaf boxes, as a fraction of their size plus a fixed amount
+	static constexpr float FAT_SCALE = 0.1f;
+	static constexpr float FAT_MARGIN = 0.1f;
+private:
+	static const int NULL_NODE = -1;
+	//Number of buckets the SAH build splits centroids into
+	static const int SAH_BINS = 12;
+
+	struct Node
+	{
+		glm::vec3 Min;
+		glm::vec3 Max;
+		//Doubles as the free list link when the node isn't in use
+		int Parent;
+		int Left;
+		int Right;
+		//Leaf only, index into the proxies
+		int Proxy;
+		//Leaves are 0, free nodes are -1
+		int Height;
+
+		bool IsLeaf() const { return Left == NULL_NODE; }
+	};
+
+	struct Proxy
+	{
+		entt::entity Entity;
+		//NULL_NODE if the mesh has no bounds
+		int Node;
+		//What the box was last built from
+		glm::mat4 World;
+		uint32_t WorldVersion;
+		const VertexArrayObject* Mesh;
+		//Tight world space box
+		glm::vec3 Min;
+		glm::vec3 Max;
+		unsigned VisibleFrame;
+	};
+
+	//Registry listeners
+	void OnConstruct(entt::registry& registry, entt::entity entity);
+	void OnDestroy(entt::registry& registry, entt::entity entity);
+
+	//Recomputes a proxy's tight box, returns false if the mesh has no bounds
+	bool ComputeBounds(Proxy& proxy, const RendererComponent& renderer, const Transform& transform);
+
+	//Node pool
+	int AllocateNode();
+	void FreeNode(int node);
+
+	//Incremental tree edits
+	void InsertLeaf(int leaf);
+	void RemoveLeaf(int leaf);
+	//Single AVL style rotation to keep heights balanced, returns the new subtree root
+	int Balance(int node);
+	//Walks up from a node fixing boxes and heights
+	void Refit(int node);
+
+	//Top down binned SAH build over leaves[first, last)
+	int BuildRange(std::vector<int>& leaves, int first, int last, int parent);
+
+	//Calls the visitor with every proxy whose box touches the frustum
+	template <typename Visitor>
+	void VisitFrustum(const glm::mat4& viewProjection, Visitor visitor) const;
+	//Visits every leaf under a node without testing them
+	template <typename Visitor>
+	void VisitSubtree(int node, Visitor visitor) const;
+
+	static float SurfaceArea(const glm::vec3& min, const glm::vec3& max);
+
+	entt::registry* _registry = nullptr;
+
+	std::vector<Node> _nodes;
+	int _root = NULL_NODE;
+	int _freeList = NULL_NODE;
+	unsigned _nodeCount = 0;
+
+	std::vector<Proxy> _proxies;
+	std::unordered_map<entt::entity, unsigned> _proxyLookup;
+
+	//Scratch for traversals and builds
+	mutable std::vector<int> _stack;
+	std::vector<int> _leaves;
+
+	unsigned _frame = 0;
+	unsigned _visibleCount = 0;
+	mutable unsigned _nodesVisited = 0;
+	unsigned _reinsertCount = 0;
+	unsigned _rebuildCount = 0;
+	//Cost right after the last full build
+	float _builtCost = 0.0f;
+};
@@ -0,0 +1,37 @@
+#pragma once
+#include <GLM/glm.hpp>
+
+//C++ side of the std140 uniform blocks the scene shaders share
+//*Has to match the block declarations in res/shaders member for member, FrameData lives in res/shaders/include/frame_data.glsl
+
+//Binding points the shaders declare their blocks at
+const unsigned FRAME_BLOCK_BINDING = 0;
+const unsigned OBJECT_BLOCK_BINDING = 1;
+//Materials bind their own MaterialBlock here, its layout is read back from each shader instead of mirrored in C++
+const unsigned MATERIAL_BLOCK_BINDING = 4;
+
+//Everything about the camera that only changes once a frame
+struct FrameBlock
+{
+	glm::mat4 View;
+	glm::mat4 ViewProjection;
+	glm::mat4 SkyboxMatrix;
+	//Last frame's camera, for motion vectors
+	glm::mat4 PrevViewProjection;
+	glm::mat4 PrevSkyboxMatrix;
+	//std140 pads a vec3 out to 16 bytes
+	glm::vec3 CamPos;
+	float Padding;
+	//This frame's jitter in xy, last frame's in zw
+	glm::vec4 TAAJitter;
+};
+
+//Transforms for a single non-instanced draw
+struct ObjectBlock
+{
+	glm::mat4 ModelViewProjection;
+	glm::mat4 Model;
+	glm::mat4 PrevModel;
+	//std140 stores each column of a mat3 as a vec4
+	glm::vec4 NormalMatrix[3];
+};
@@ -0,0 +1,114 @@
+#include "UniformRing.h"
+#include <cstring>
+#include <Logging.h>
+#include <GLState.h>
+
+UniformRing::UniformRing()
+{
+}
+
+UniformRing::~UniformRing()
+{
+	Unload();
+}
+
+void UniformRing::Init(GLsizeiptr frameSize, int numFrames)
+{
+	glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &_alignment);
+
+	//Keep every region starting on an aligned offset
+	_frameSize = (frameSize + _alignment - 1) / _alignment * _alignment;
+	_numFrames = numFrames;
+	_frame = numFrames - 1;
+	_cursor = 0;
+	_fences.assign(numFrames, nullptr);
+
+	//Coherent so we never have to flush, the fences make sure we don't write over anything in use
+	GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+	glCreateBuffers(1, &_buffer);
+	glNamedBufferStorage(_buffer, _frameSize * numFrames, nullptr, flags);
+	_mapped = static_cast<char*>(glMapNamedBufferRange(_buffer, 0, _frameSize * numFrames, flags));
+}
+
+void UniformRing::Unload()
+{
+	for (GLsync& fence : _fences)
+	{
+		if (fence != nullptr)
+		{
+			glDeleteSync(fence);
+			fence = nullptr;
+		}
+	}
+
+	if (_buffer != GL_NONE)
+	{
+		glUnmapNamedBuffer(_buffer);
+		GLState::OnBufferDeleted(_buffer);
+		glDeleteBuffers(1, &_buffer);
+		_buffer = GL_NONE;
+		_mapped = nullptr;
+	}
+}
+
+void UniformRing::BeginFrame()
+{
+	_frame = (_frame + 1) % _numFrames;
+	_cursor = 0;
+
+	GLsync& fence = _fences[_frame];
+	if (fence == nullptr)
+		return;
+
+	//Usually already signalled, we're a few frames ahead of the GPU at most
+	while (glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000) == GL_TIMEOUT_EXPIRED)
+	{
+	}
+	glDeleteSync(fence);
+	fence = nullptr;
+}
+
+void UniformRing::EndFrame()
+{
+	if (_fences[_frame] != nullptr)
+	{
+		glDeleteSync(_fences[_frame]);
+	}
+	_fences[_frame] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
+
+GLintptr UniformRing::Push(const void* data, GLsizeiptr size)
+{
+	if (_cursor + size > _frameSize)
+	{
+		LOG_WARN("Uniform ring is full ({} bytes a frame), skipping", _frameSize);
+		return -1;
+	}
+
+	GLintptr offset = _frameSize * _frame + _cursor;
+	memcpy(_mapped + offset, data, size);
+
+	//Next push has to start on an aligned offset too
+	_cursor += (size + _alignment - 1) / _alignment * _alignment;
+	return offset;
+}
+
+void UniformRing::BindRange(GLuint binding, GLintptr offset, GLsizeiptr size) const
+{
+	GLState::BindUniformBuffer(binding, _buffer, offset, size);
+}
+
+GLuint UniformRing::GetHandle() const
+{
+	return _buffer;
+}
+
+GLsizeiptr UniformRing::GetUsed() const
+{
+	return _cursor;
+}
+
+GLsizeiptr UniformRing::GetFrameSize() const
+{
+	return _frameSize;
+}
@@ -0,0 +1,59 @@
+#pragma once
+#include <glad/glad.h>
+#include <vector>
+
+//A persistently mapped uniform buffer split into one region per frame in flight
+//*We write straight into the mapped memory and hand out offsets for glBindBufferRange
+//*Each region gets a fence at the end of the frame, we only wait on it when we come back around
+class UniformRing
+{
+public:
+	UniformRing();
+	~UniformRing();
+
+	//Creates and maps the buffer
+	//*frameSize is how many bytes one frame can push
+	void Init(GLsizeiptr frameSize, int numFrames = 3);
+	//Unmaps and deletes the buffer
+	void Unload();
+
+	//Moves onto the next region, waiting if the GPU is still reading it
+	void BeginFrame();
+	//Fences off this frame's region
+	//*Call after the last draw that reads from it
+	void EndFrame();
+
+	//Copies data into this frame's region
+	//*Returns the offset to bind, or -1 if the region is full
+	GLintptr Push(const void* data, GLsizeiptr size);
+	template <typename T>
+	GLintptr Push(const T& data)
+	{
+		return Push(&data, sizeof(T));
+	}
+
+	//Binds part of the buffer to a uniform block binding point
+	void BindRange(GLuint binding, GLintptr offset, GLsizeiptr size) const;
+
+	//Getters
+	GLuint GetHandle() const;
+	//Bytes pushed so far this frame
+	GLsizeiptr GetUsed() const;
+	GLsizeiptr GetFrameSize() const;
+private:
+	GLuint _buffer = GL_NONE;
+	//Start of the mapped buffer
+	char* _mapped = nullptr;
+
+	GLsizeiptr _frameSize = 0;
+	int _numFrames = 0;
+	//Region we're writing this frame
+	int _frame = 0;
+	//Next free byte in the region
+	GLsizeiptr _cursor = 0;
+	//Offsets passed to glBindBufferRange have to be a multiple of this
+	GLint _alignment = 256;
+
+	//One fence per region, GL_NONE if the region has never been used
+	std::vector<GLsync> _fences;
+};
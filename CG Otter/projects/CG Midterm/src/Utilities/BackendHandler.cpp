@@ -58,6 +58,10 @@ void BackendHandler::GlfwWindowResizedCallback(GLFWwindow* window, int width, in
 	{
 		buf.Reshape(width, height);
 	});
+	Application::Instance().ActiveScene->Registry().view<SceneEffect>().each([=](SceneEffect& buf)
+	{
+		buf.Reshape(width, height);
+	});
 	Application::Instance().ActiveScene->Registry().view<GreyscaleEffect>().each([=](GreyscaleEffect& buf)
 	{
 		buf.Reshape(width, height);
@@ -74,6 +78,22 @@ void BackendHandler::GlfwWindowResizedCallback(GLFWwindow* window, int width, in
 	{
 		buf.Reshape(width, height);
 	});
+	Application::Instance().ActiveScene->Registry().view<FusedEffect>().each([=](FusedEffect& buf)
+	{
+		buf.Reshape(width, height);
+	});
+	Application::Instance().ActiveScene->Registry().view<SSAOEffect>().each([=](SSAOEffect& buf)
+	{
+		buf.Reshape(width, height);
+	});
+	Application::Instance().ActiveScene->Registry().view<TAAEffect>().each([=](TAAEffect& buf)
+	{
+		buf.Reshape(width, height);
+	});
+	Application::Instance().ActiveScene->Registry().view<UpscaleEffect>().each([=](UpscaleEffect& buf)
+	{
+		buf.Reshape(width, height);
+	});
 }
 
 bool BackendHandler::InitGLFW()
@@ -183,23 +203,49 @@ void BackendHandler::RenderImGui()
 		// Restore our gl context
 		glfwMakeContextCurrent(window);
 	}
+
+	// ImGui's backend binds its own state without going through GLState
+	GLState::Invalidate();
 }
 
-void BackendHandler::RenderVAO(const Shader::sptr& shader, const VertexArrayObject::sptr& vao, const glm::mat4& viewProjection, const Transform& transform)
+void BackendHandler::RenderVAO(UniformRing& ring, const VertexArrayObject* vao, const glm::mat4& viewProjection, const glm::mat4& world,
+	const glm::mat3& normalMatrix, const glm::mat4& prevWorld)
 {
-	shader->SetUniformMatrix("u_ModelViewProjection", viewProjection * transform.WorldTransform());
-	shader->SetUniformMatrix("u_Model", transform.WorldTransform());
-	shader->SetUniformMatrix("u_NormalMatrix", transform.WorldNormalMatrix());
+	ObjectBlock block;
+	block.ModelViewProjection = viewProjection * world;
+	block.Model = world;
+	block.PrevModel = prevWorld;
+	for (int i = 0; i < 3; i++)
+	{
+		block.NormalMatrix[i] = glm::vec4(normalMatrix[i], 0.0f);
+	}
+
+	GLintptr offset = ring.Push(block);
+	if (offset < 0)
+		return;
+
+	ring.BindRange(OBJECT_BLOCK_BINDING, offset, sizeof(ObjectBlock));
 	vao->Render();
 }
 
-void BackendHandler::SetupShaderForFrame(const Shader::sptr& shader, const glm::mat4& view, const glm::mat4& projection)
+void BackendHandler::SetupFrameUniforms(UniformRing& ring, const glm::mat4& view, const glm::mat4& projection,
+	const glm::mat4& prevView, const glm::mat4& prevProjection, const glm::vec4& jitter)
 {
-	shader->Bind();
-	// These are the uniforms that update only once per frame
-	shader->SetUniformMatrix("u_View", view);
-	shader->SetUniformMatrix("u_ViewProjection", projection * view);
-	shader->SetUniformMatrix("u_SkyboxMatrix", projection * glm::mat4(glm::mat3(view)));
-	glm::vec3 camPos = glm::inverse(view) * glm::vec4(0, 0, 0, 1);
-	shader->SetUniform("u_CamPos", camPos);
+	// These are the uniforms that update only once per frame, every shader reads the same block
+	FrameBlock block;
+	block.View = view;
+	block.ViewProjection = projection * view;
+	block.SkyboxMatrix = projection * glm::mat4(glm::mat3(view));
+	// Last frame's camera so we can work out motion vectors
+	block.PrevViewProjection = prevProjection * prevView;
+	block.PrevSkyboxMatrix = prevProjection * glm::mat4(glm::mat3(prevView));
+	block.CamPos = glm::inverse(view) * glm::vec4(0, 0, 0, 1);
+	block.Padding = 0.0f;
+	block.TAAJitter = jitter;
+
+	GLintptr offset = ring.Push(block);
+	if (offset >= 0)
+	{
+		ring.BindRange(FRAME_BLOCK_BINDING, offset, sizeof(FrameBlock));
+	}
 }
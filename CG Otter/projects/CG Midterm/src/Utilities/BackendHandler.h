@@ -2,10 +2,17 @@
 
 #include "Utilities/Util.h"
 #include "Utilities/EnvironmentGenerator.h"
+#include "Graphics/Post/SceneEffect.h"
 #include "Graphics/Post/GreyscaleEffect.h"
 #include "Graphics/Post/SepiaEffect.h"
 #include "Graphics/Post/ColorCorrectEffect.h"
 #include "Graphics/Post/BloomEffect.h"
+#include "Graphics/Post/UpscaleEffect.h"
+#include "Graphics/Post/TAAEffect.h"
+#include "Graphics/Post/SSAOEffect.h"
+#include "Graphics/Post/FusedEffect.h"
+#include "Graphics/UniformRing.h"
+#include "Graphics/UniformBlocks.h"
 
 #include <iostream>
 #include <Logging.h>
@@ -59,8 +66,14 @@ public:
 	static void RenderImGui();
 
 	//Render our VAO
-	static void RenderVAO(const Shader::sptr& shader, const VertexArrayObject::sptr& vao, const glm::mat4& viewProjection, const Transform& transform);
-	static void SetupShaderForFrame(const Shader::sptr& shader, const glm::mat4& view, const glm::mat4& projection);
+	//*Writes the object's transforms into the ring and binds them to the object block
+	//*prevWorld is the world matrix the object was drawn with last frame (for motion vectors)
+	static void RenderVAO(UniformRing& ring, const VertexArrayObject* vao, const glm::mat4& viewProjection, const glm::mat4& world,
+		const glm::mat3& normalMatrix, const glm::mat4& prevWorld);
+	//Writes the camera into the ring and binds it to the frame block, once a frame
+	//*prevView and prevProjection are last frame's camera, jitter is this frame's camera jitter in xy and last frame's in zw
+	static void SetupFrameUniforms(UniformRing& ring, const glm::mat4& view, const glm::mat4& projection,
+		const glm::mat4& prevView, const glm::mat4& prevProjection, const glm::vec4& jitter);
 
 	static GLFWwindow* window;
 	static std::vector<std::function<void()>> imGuiCallbacks;
@@ -0,0 +1,63 @@
+#include "JobBenchmark.h"
+#include <JobSystem.h>
+#include <chrono>
+#include <memory>
+#include <cmath>
+
+void JobBenchmark::Run(unsigned maxThreads)
+{
+	if (maxThreads == 0)
+	{
+		maxThreads = std::max(std::thread::hardware_concurrency(), 1u);
+	}
+
+	_results.clear();
+	_output.resize(ITEM_COUNT);
+
+	for (unsigned threads = 1; threads <= maxThreads; threads++)
+	{
+		//The main thread counts as one of the threads, and JobSystem takes 0 workers to mean one per core,
+		//so the single thread run skips the job system entirely
+		std::unique_ptr<JobSystem> jobs;
+		if (threads > 1)
+		{
+			jobs = std::make_unique<JobSystem>(threads - 1);
+		}
+
+		double best = 0.0;
+		for (int repeat = 0; repeat < REPEATS; repeat++)
+		{
+			auto start = std::chrono::high_resolution_clock::now();
+			auto work = [&](unsigned begin, unsigned end) {
+				//Enough math per item that the jobs aren't just measuring the queue
+				for (unsigned i = begin; i < end; i++)
+				{
+					float value = float(i);
+					for (int k = 0; k < 32; k++)
+					{
+						value = std::sqrt(value * 1.0001f + 1.0f);
+					}
+					_output[i] = value;
+				}
+			};
+			if (jobs == nullptr)
+				work(0, ITEM_COUNT);
+			else
+				jobs->ParallelFor(ITEM_COUNT, GRAIN_SIZE, work);
+			double milliseconds = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+			if (repeat == 0 || milliseconds < best)
+				best = milliseconds;
+		}
+
+		Result result;
+		result.Threads = threads;
+		result.Milliseconds = best;
+		result.Speedup = _results.empty() ? 1.0 : _results[0].Milliseconds / best;
+		_results.push_back(result);
+	}
+}
+
+const std::vector<JobBenchmark::Result>& JobBenchmark::GetResults() const
+{
+	return _results;
+}
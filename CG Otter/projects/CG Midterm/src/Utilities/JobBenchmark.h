@@ -0,0 +1,32 @@
+#pragma once
+#include <vector>
+
+//Times the same workload through job systems of 1 to N threads, to see how well it scales
+//*Each run makes its own JobSystem, so it doesn't matter what the application's one is busy with
+class JobBenchmark
+{
+public:
+	struct Result
+	{
+		unsigned Threads;
+		double Milliseconds;
+		//Compared to the single thread run
+		double Speedup;
+	};
+
+	//Runs the benchmark once for every thread count up to maxThreads
+	//*0 goes up to one per core, blocks until it's done
+	void Run(unsigned maxThreads = 0);
+
+	//Getters
+	const std::vector<Result>& GetResults() const;
+private:
+	//Items in the workload, and how many each job gets
+	static const unsigned ITEM_COUNT = 1 << 20;
+	static const unsigned GRAIN_SIZE = 2048;
+	//Best of this many runs per thread count
+	static const int REPEATS = 3;
+
+	std::vector<Result> _results;
+	std::vector<float> _output;
+};
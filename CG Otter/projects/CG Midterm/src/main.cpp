@@ -1,5 +1,20 @@
 //Just a simple handler for simple initialization stuffs
 #include "Utilities/BackendHandler.h"
+#include "Utilities/JobBenchmark.h"
+#include "Graphics/DynamicResolution.h"
+#include "Graphics/FrustumCuller.h"
+#include "Graphics/OcclusionCuller.h"
+#include "Graphics/InstanceBatcher.h"
+#include "Graphics/RenderQueue.h"
+#include "Graphics/SpatialIndex.h"
+#include "Graphics/UniformRing.h"
+#include "Graphics/Post/CPU/CPUPostChain.h"
+#include "Graphics/Post/CPU/CPUSepiaEffect.h"
+#include "Graphics/Post/CPU/CPUGreyscaleEffect.h"
+#include "Graphics/Post/CPU/CPUColorCorrectEffect.h"
+#include "Graphics/Post/CPU/CPUBloomEffect.h"
+#include "Graphics/Post/CPU/CPUPostTest.h"
+#include "Graphics/OcclusionTest.h"
 
 #include <filesystem>
 #include <json.hpp>
@@ -13,6 +28,8 @@
 #include <ObjLoader.h>
 #include <VertexTypes.h>
 #include <ShaderMaterial.h>
+#include <ShaderLibrary.h>
+#include <Resources.h>
 #include <RendererComponent.h>
 #include <TextureCubeMap.h>
 #include <TextureCubeMapData.h>
@@ -26,7 +43,24 @@
 #include <FollowPathBehaviour.h>
 #include <SimpleMoveBehaviour.h>
 
-int main() {
+int main(int argc, char** argv) {
+	// Headless check of the CPU post effects against the reference images, doesn't need a window or a GPU
+	//*--cpu-post-test --update writes new references from the CPU instead
+	//*--cpu-post-test --gpu-references writes them with the GLSL effects, that one does need a GPU (see CPUPostTest)
+	// Headless check of the software occlusion culler against a known occluder
+	if (argc > 1 && std::string(argv[1]) == "--occlusion-test") {
+		return OcclusionTest::Run();
+	}
+
+	bool gpuReferences = false;
+	if (argc > 1 && std::string(argv[1]) == "--cpu-post-test") {
+		gpuReferences = argc > 2 && std::string(argv[2]) == "--gpu-references";
+		if (!gpuReferences) {
+			bool update = argc > 2 && std::string(argv[2]) == "--update";
+			return CPUPostTest::Run("cpu_post_test", update);
+		}
+	}
+
 	int frameIx = 0;
 	float fpsBuffer[128];
 	float minFps, maxFps, avgFps;
@@ -35,6 +69,9 @@ int main() {
 
 	BackendHandler::InitAll();
 
+	// The main thread counts as worker 0, it's the only one that runs GL jobs
+	Application::Instance().Jobs = std::make_unique<JobSystem>();
+
 	// Let OpenGL know that we want debug output, and route it to our handler function
 	glEnable(GL_DEBUG_OUTPUT);
 	glDebugMessageCallback(BackendHandler::GlDebugMessage, nullptr);
@@ -45,17 +82,33 @@ int main() {
 	// Push another scope so most memory should be freed *before* we exit the app
 	{
 		#pragma region Shader and ImGui
-		Shader::sptr passthroughShader = Shader::Create();
-		passthroughShader->LoadShaderPartFromFile("shaders/passthrough_vert.glsl", GL_VERTEX_SHADER);
-		passthroughShader->LoadShaderPartFromFile("shaders/passthrough_frag.glsl", GL_FRAGMENT_SHADER);
-		passthroughShader->Link();
+		// Linked programs get saved here, so the next run can skip compiling them
+		ShaderLibrary::Init("shader_cache", (GLADloadproc)glfwGetProcAddress);
+
+		if (gpuReferences) {
+			int failed = CPUPostTest::WriteGPUReferences("cpu_post_test");
+			ShaderLibrary::Unload();
+			BackendHandler::ShutdownImGui();
+			Logger::Uninitialize();
+			return failed;
+		}
+		// Everything up to the game loop only submits its shaders, we wait on them all at once at the end
+		ShaderLibrary::BeginBatch();
+
+		Shader::sptr passthroughShader = ShaderLibrary::LoadFromFiles("shaders/passthrough_vert.glsl", "shaders/passthrough_frag.glsl");
 
 		// Load our shaders
 		Shader::sptr shader = Shader::Create();
-		shader->LoadShaderPartFromFile("shaders/vertex_shader.glsl", GL_VERTEX_SHADER);
+		shader->LoadShaderPartFromFile("shaders/vertex_shader_instanced.glsl", GL_VERTEX_SHADER);
 		shader->LoadShaderPartFromFile("shaders/frag_blinn_phong_textured.glsl", GL_FRAGMENT_SHADER);
 		shader->Link();
 
+		// Only fills in depth, so SSAO has something to work with before we light the scene
+		Shader::sptr depthPrepassShader = Shader::Create();
+		depthPrepassShader->LoadShaderPartFromFile("shaders/vertex_shader_instanced.glsl", GL_VERTEX_SHADER);
+		depthPrepassShader->LoadShaderPartFromFile("shaders/depth_prepass_frag.glsl", GL_FRAGMENT_SHADER);
+		depthPrepassShader->Link();
+
 		glm::vec3 lightPos = glm::vec3(0.0f, 0.0f, 5.0f);
 		glm::vec3 lightCol = glm::vec3(0.9f, 0.85f, 0.5f);
 		float     lightAmbientPow = 0.05f;
@@ -64,12 +117,10 @@ int main() {
 		float     ambientPow = 0.1f;
 		float     lightLinearFalloff = 0.09f;
 		float     lightQuadraticFalloff = 0.032f;
-		int		  lightingValue = 0;
-		int       ambientOnly = 0;
-		int       specularOnly = 0;
-		int       ambientSpecular = 0;
-		int		  ambientspecularBloom = 0;
-		int		  textureoff = 0;
+		bool      ssaoEnabled = true;
+		float     aoStrength = 1.0f;
+		// Texture slot the AO gets bound to for the lighting pass, well clear of the material textures
+		const int aoTextureSlot = 20;
 
 		// These are our application / scene level uniforms that don't necessarily update
 		// every frame
@@ -83,30 +134,95 @@ int main() {
 		shader->SetUniform("u_LightAttenuationLinear", lightLinearFalloff);
 		shader->SetUniform("u_LightAttenuationQuadratic", lightQuadraticFalloff);
 
-		shader->SetUniform("u_lightingValue", lightingValue);
-		shader->SetUniform("u_ambientOnly", ambientOnly);
-		shader->SetUniform("u_specularOnly", specularOnly);
-		shader->SetUniform("u_ambientSpecular", ambientSpecular);
-		shader->SetUniform("u_ambientspecularBloom", ambientspecularBloom);
-		shader->SetUniform("u_textureoff", textureoff);
+		shader->SetUniform("s_AmbientOcclusion", aoTextureSlot);
+		shader->SetUniform("u_AOStrength", aoStrength);
 
 		PostEffect* basicEffect;
 
 		int activeEffect = 0;
 		std::vector<PostEffect*> effects;
+		//Which effects run, in the same order as effects
+		std::vector<bool> effectEnabled;
+
+		//Runs the enabled effects, merging the pointwise ones into single passes
+		FusedEffect* fusedEffect;
+		bool fuseEffects = true;
 
 		SepiaEffect* sepiaEffect;
 		GreyscaleEffect* greyscaleEffect;
 		ColorCorrectEffect* colorCorrectEffect;
 		BloomEffect* bloomEffect;
+
+		//CPU copies of the effects, in the same order as effects
+		//*Used to check the CPU backend against the GPU on a real frame
+		CPUPostChain cpuChain;
+		CPUSepiaEffect cpuSepiaEffect;
+		CPUGreyscaleEffect cpuGreyscaleEffect;
+		CPUColorCorrectEffect cpuColorCorrectEffect;
+		CPUBloomEffect cpuBloomEffect;
+		std::vector<CPUPostEffect*> cpuEffects = { &cpuSepiaEffect, &cpuGreyscaleEffect, &cpuColorCorrectEffect, &cpuBloomEffect };
+		bool runCPUComparison = false;
+		bool cpuCompared = false;
+		double cpuMilliseconds = 0.0;
+		double cpuMegapixelsPerSecond = 0.0;
+		float cpuMaxError = 0.0f;
+		//Biggest difference we'll accept, the GPU rounds to 8 bits between passes in different places
+		const float cpuTolerance = 3.0f / 255.0f;
+
+		//Works out the AO between the depth pre-pass and the lighting pass
+		SSAOEffect* ssaoEffect;
+
+		//Resolves the jittered scene against last frame before the other effects run
+		TAAEffect* taaEffect;
+		bool taaEnabled = true;
+
+		//Final pass that stretches the scaled down image back over the window
+		UpscaleEffect* upscaleEffect;
+		DynamicResolution dynamicResolution;
+
+		//Keeps the renderers in draw order between frames, picks up new ones as they get added
+		RenderQueue renderQueue;
+		//Tree over every renderer's bounds, throws out whole groups of them at once
+		SpatialIndex spatialIndex;
+		//Drops renderers whose bounds are outside the camera before they get batched
+		FrustumCuller frustumCuller;
+		//Rasterizes the big occluders on the CPU and drops anything hidden behind them
+		OcclusionCuller occlusionCuller;
+		bool occlusionCulling = true;
+		//How many world matrices actually had to be re-calculated this frame
+		unsigned transformsUpdated = 0;
+		//Times the job system at every thread count when asked
+		JobBenchmark jobBenchmark;
+		//Groups objects with the same mesh and material into instanced draws
+		InstanceBatcher instanceBatcher;
+		//Per-frame and per-object uniform blocks, triple buffered
+		UniformRing uniformRing;
 		
 
+		//Switches the lit shader's lighting mode, nullptr goes back to full lighting
+		auto setLightingMode = [](const char* mode) {
+			static const char* const modes[] = {
+				"LIGHTING_UNLIT", "LIGHTING_AMBIENT_ONLY", "LIGHTING_SPECULAR_ONLY", "LIGHTING_AMBIENT_SPECULAR", "LIGHTING_TEXTURES_OFF"
+			};
+			for (const char* keyword : modes)
+				ShaderMaterial::SetGlobalKeyword(keyword, mode != nullptr && std::string(keyword) == mode);
+		};
+
 		// We'll add some ImGui controls to control our shader
 		BackendHandler::imGuiCallbacks.push_back([&]() {
 			if (ImGui::CollapsingHeader("Effect controls"))
 			{
+				ImGui::Checkbox("Fuse Pointwise Effects", &fuseEffects);
+				ImGui::Text("Passes: %d, Fused Shaders: %d", fusedEffect->GetPassCount(), fusedEffect->GetCachedShaderCount());
+
 				ImGui::SliderInt("Chosen Effect", &activeEffect, 0, effects.size() - 1);
 
+				bool enabled = effectEnabled[activeEffect];
+				if (ImGui::Checkbox("Effect Enabled", &enabled))
+				{
+					effectEnabled[activeEffect] = enabled;
+				}
+
 				if (activeEffect == 0)
 				{
 					ImGui::Text("Active Effect: Sepia Effect");
@@ -167,6 +283,150 @@ int main() {
 					}
 				}
 			}
+			if (ImGui::CollapsingHeader("Ambient Occlusion"))
+			{
+				if (ImGui::Checkbox("SSAO", &ssaoEnabled))
+				{
+					shader->SetUniform("u_AOStrength", ssaoEnabled ? aoStrength : 0.0f);
+				}
+				if (ImGui::SliderFloat("AO Strength", &aoStrength, 0.0f, 1.0f) && ssaoEnabled)
+				{
+					shader->SetUniform("u_AOStrength", aoStrength);
+				}
+
+				float radius = ssaoEffect->GetRadius();
+				if (ImGui::SliderFloat("AO Radius", &radius, 0.05f, 2.0f))
+				{
+					ssaoEffect->SetRadius(radius);
+				}
+				float bias = ssaoEffect->GetBias();
+				if (ImGui::SliderFloat("AO Bias", &bias, 0.0f, 0.1f))
+				{
+					ssaoEffect->SetBias(bias);
+				}
+				float power = ssaoEffect->GetPower();
+				if (ImGui::SliderFloat("AO Power", &power, 0.5f, 4.0f))
+				{
+					ssaoEffect->SetPower(power);
+				}
+			}
+			if (ImGui::CollapsingHeader("Anti-Aliasing"))
+			{
+				if (ImGui::Checkbox("TAA", &taaEnabled))
+				{
+					//Whatever's in there is from before we turned it off
+					taaEffect->ResetHistory();
+				}
+
+				float feedback = taaEffect->GetFeedback();
+				if (ImGui::SliderFloat("History Feedback", &feedback, 0.5f, 0.98f))
+				{
+					taaEffect->SetFeedback(feedback);
+				}
+			}
+			if (ImGui::CollapsingHeader("Dynamic Resolution"))
+			{
+				bool enabled = dynamicResolution.GetEnabled();
+				if (ImGui::Checkbox("Enabled", &enabled))
+				{
+					dynamicResolution.SetEnabled(enabled);
+				}
+
+				float targetTime = dynamicResolution.GetTargetTime();
+				if (ImGui::SliderFloat("Target GPU Time (ms)", &targetTime, 2.0f, 33.3f))
+				{
+					dynamicResolution.SetTargetTime(targetTime);
+				}
+
+				float minScale = dynamicResolution.GetMinScale();
+				float maxScale = dynamicResolution.GetMaxScale();
+				if (ImGui::SliderFloat("Min Scale", &minScale, 0.25f, 1.0f) | ImGui::SliderFloat("Max Scale", &maxScale, 0.25f, 1.0f))
+				{
+					dynamicResolution.SetScaleRange(minScale, maxScale);
+				}
+
+				//Let us pick the scale by hand when the governor is off
+				if (!enabled)
+				{
+					float scale = dynamicResolution.GetScale();
+					if (ImGui::SliderFloat("Scale", &scale, minScale, maxScale))
+					{
+						dynamicResolution.SetScale(scale);
+					}
+				}
+
+				float sharpness = upscaleEffect->GetSharpness();
+				if (ImGui::SliderFloat("Sharpness", &sharpness, 0.0f, 2.0f))
+				{
+					upscaleEffect->SetSharpness(sharpness);
+				}
+
+				int windowWidth, windowHeight;
+				glfwGetWindowSize(BackendHandler::window, &windowWidth, &windowHeight);
+				float scale = dynamicResolution.GetScale();
+				ImGui::Text("Render Scale: %.0f%% (%d x %d)", scale * 100.0f, int(windowWidth * scale + 0.5f), int(windowHeight * scale + 0.5f));
+				ImGui::Text("GPU Time: %.2f ms", dynamicResolution.GetGPUTime());
+			}
+			if (ImGui::CollapsingHeader("CPU Post Effects"))
+			{
+				ImGui::Text("Threads: %u", Application::Instance().Jobs->GetThreadCount());
+				if (ImGui::Button("Compare With GPU", ImVec2(200.0f, 40.0f)))
+				{
+					runCPUComparison = true;
+				}
+				if (dynamicResolution.GetScale() < 1.0f)
+				{
+					ImGui::Text("Bloom only lines up at 100%% render scale");
+				}
+				if (cpuCompared)
+				{
+					ImGui::Text("CPU Time: %.2f ms (%.1f MP/s)", cpuMilliseconds, cpuMegapixelsPerSecond);
+					ImGui::Text("Max Error: %.4f (%.1f / 255) %s", cpuMaxError, cpuMaxError * 255.0f, cpuMaxError <= cpuTolerance ? "PASS" : "FAIL");
+				}
+			}
+			if (ImGui::CollapsingHeader("Instancing"))
+			{
+				ImGui::Text("Objects: %d, Batches: %d, Buckets: %d", instanceBatcher.GetInstanceCount(),
+					(int)instanceBatcher.GetBatches().size(), (int)instanceBatcher.GetBuckets().size());
+				ImGui::Text("Visible: %u / %u", frustumCuller.GetVisibleCount(), frustumCuller.GetTotalCount());
+				ImGui::Text("BVH: %u visible, %u nodes visited", spatialIndex.GetVisibleCount(), spatialIndex.GetNodesVisited());
+				ImGui::Checkbox("Occlusion Culling", &occlusionCulling);
+				ImGui::Text("Occluded: %u / %u, %u occluder triangles", occlusionCuller.GetOccludedCount(), occlusionCuller.GetTestedCount(), occlusionCuller.GetTriangleCount());
+				ImGui::Text("BVH: %u nodes, height %d, cost %.2f", spatialIndex.GetNodeCount(), spatialIndex.GetHeight(), spatialIndex.GetCost());
+				ImGui::Text("BVH: %u reinserted, %u rebuilds", spatialIndex.GetReinsertCount(), spatialIndex.GetRebuildCount());
+				ImGui::Text("Draw Calls: %d", instanceBatcher.GetDrawCount());
+				ImGui::Text("Transforms: %u updated", transformsUpdated);
+				ImGui::Text("GL State Calls: %u issued, %u skipped", GLState::GetIssuedCount(), GLState::GetElidedCount());
+				ImGui::Text("Shaders: %.1f ms, %u from cache, %u compiled", ShaderLibrary::GetBuildTime(), ShaderLibrary::GetCachedCount(), ShaderLibrary::GetCompiledCount());
+				ImGui::Text("Uniform Ring: %.1f / %.1f KB", uniformRing.GetUsed() / 1024.0f, uniformRing.GetFrameSize() / 1024.0f);
+				ImGui::Text("Sort: %d keys moved (%s)", renderQueue.GetMovedCount(), renderQueue.GetUsedRadixSort() ? "radix" : "insertion");
+			}
+			if (ImGui::CollapsingHeader("Jobs"))
+			{
+				JobSystem& jobs = *Application::Instance().Jobs;
+				ImGui::Text("Threads: %u, %u jobs stolen", jobs.GetThreadCount(), jobs.GetStealCount());
+				if (ImGui::Button("Run Scaling Benchmark", ImVec2(200.0f, 40.0f)))
+				{
+					jobBenchmark.Run();
+				}
+				for (const JobBenchmark::Result& result : jobBenchmark.GetResults())
+				{
+					ImGui::Text("%2u threads: %.2f ms (%.2fx)", result.Threads, result.Milliseconds, result.Speedup);
+				}
+			}
+			if (ImGui::CollapsingHeader("Simulation"))
+			{
+				Timing& timing = Timing::Instance();
+				float fixedRate = 1.0f / timing.FixedTimeStep;
+				if (ImGui::SliderFloat("Fixed Rate (Hz)", &fixedRate, 10.0f, 240.0f)) {
+					timing.FixedTimeStep = 1.0f / fixedRate;
+				}
+				ImGui::SliderInt("Max Steps Per Frame", &timing.MaxFixedSteps, 1, 20);
+				ImGui::Text("Fixed Steps: %d this frame, alpha %.2f", timing.FixedSteps, timing.FixedAlpha);
+				ImGui::Text("Dropped: %.2f s", timing.DroppedTime);
+				BehaviourScheduler& behaviours = BehaviourScheduler::Get(Application::Instance().ActiveScene->Registry());
+				ImGui::Text("Behaviours: %u in %u types", (unsigned)behaviours.GetBehaviourCount(), (unsigned)behaviours.GetTypeCount());
+			}
 			if (ImGui::CollapsingHeader("Environment generation"))
 			{
 				if (ImGui::Button("Regenerate Environment", ImVec2(200.0f, 40.0f)))
@@ -206,67 +466,39 @@ int main() {
 			}
 			if (ImGui::CollapsingHeader("CG Midterm Effects Buttons"))
 			{
+				//Each mode is a keyword, materials on the lit shader switch to the matching variant
 				if (ImGui::Button("No Lighting"))
 				{
-					shader->SetUniform("u_lightingValue", lightingValue = 1);
-					shader->SetUniform("u_ambientOnly", ambientOnly = 0);
-					shader->SetUniform("u_specularOnly", specularOnly = 0);
-					shader->SetUniform("u_ambientSpecular", ambientSpecular = 0);
-					shader->SetUniform("u_ambientspecularBloom", ambientspecularBloom = 0);
-					shader->SetUniform("u_textureoff", textureoff = 0);
+					setLightingMode("LIGHTING_UNLIT");
 				}
 
 				if (ImGui::Button("Ambient Lighting Only"))
 				{
-					shader->SetUniform("u_lightingValue", lightingValue = 0);
-					shader->SetUniform("u_ambientOnly", ambientOnly = 1);
-					shader->SetUniform("u_specularOnly", specularOnly = 0);
-					shader->SetUniform("u_ambientSpecular", ambientSpecular = 0);
-					shader->SetUniform("u_ambientspecularBloom", ambientspecularBloom = 0);
-					shader->SetUniform("u_textureoff", textureoff = 0);
+					setLightingMode("LIGHTING_AMBIENT_ONLY");
 				}
 
 				if (ImGui::Button("Specular Lighting Only"))
 				{
-					shader->SetUniform("u_lightingValue", lightingValue = 0);
-					shader->SetUniform("u_ambientOnly", ambientOnly = 0);
-					shader->SetUniform("u_specularOnly", specularOnly = 1);
-					shader->SetUniform("u_ambientSpecular", ambientSpecular = 0);
-					shader->SetUniform("u_ambientspecularBloom", ambientspecularBloom = 0);
-					shader->SetUniform("u_textureoff", textureoff = 0);
+					setLightingMode("LIGHTING_SPECULAR_ONLY");
 				}
 
 				if (ImGui::Button("Ambient + Specular"))
 				{
-					shader->SetUniform("u_lightingValue", lightingValue = 0);
-					shader->SetUniform("u_ambientOnly", ambientOnly = 0);
-					shader->SetUniform("u_specularOnly", specularOnly = 0);
-					shader->SetUniform("u_ambientSpecular", ambientSpecular = 1);
-					shader->SetUniform("u_ambientspecularBloom", ambientspecularBloom = 0);
-					shader->SetUniform("u_textureoff", textureoff = 0);
+					setLightingMode("LIGHTING_AMBIENT_SPECULAR");
 				}
 				if (ImGui::CollapsingHeader("Bloom"))
 				{
+					//Full lighting, the bloom itself is the post effect
 					if (ImGui::Button("Ambient + Specular + Bloom"))
 					{
-						shader->SetUniform("u_lightingValue", lightingValue = 0);
-						shader->SetUniform("u_ambientOnly", ambientOnly = 0);
-						shader->SetUniform("u_specularOnly", specularOnly = 0);
-						shader->SetUniform("u_ambientSpecular", ambientSpecular = 0);
-						shader->SetUniform("u_ambientspecularBloom", ambientspecularBloom = 1);
-						shader->SetUniform("u_textureoff", textureoff = 0);
+						setLightingMode(nullptr);
 					}
 				}
 				
 				
 				if (ImGui::Button("Textures OFF"))
 				{
-					shader->SetUniform("u_lightingValue", lightingValue = 0);
-					shader->SetUniform("u_ambientOnly", ambientOnly = 0);
-					shader->SetUniform("u_specularOnly", specularOnly = 0);
-					shader->SetUniform("u_ambientSpecular", ambientSpecular = 0);
-					shader->SetUniform("u_ambientspecularBloom", ambientspecularBloom = 0);
-					shader->SetUniform("u_textureoff", textureoff = 1);
+					setLightingMode("LIGHTING_TEXTURES_OFF");
 				}
 			}
 
@@ -292,9 +524,9 @@ int main() {
 		#pragma endregion 
 
 		// GL states
-		glEnable(GL_DEPTH_TEST);
-		//glEnable(GL_CULL_FACE);
-		glDepthFunc(GL_LEQUAL); // New 
+		GLState::Enable(GL_DEPTH_TEST);
+		//GLState::Enable(GL_CULL_FACE);
+		GLState::DepthFunc(GL_LEQUAL); // New 
 
 		#pragma region TEXTURE LOADING
 
@@ -338,14 +570,14 @@ int main() {
 		GameScene::RegisterComponentType<RendererComponent>();
 		GameScene::RegisterComponentType<BehaviourBinding>();
 		GameScene::RegisterComponentType<Camera>();
+		GameScene::RegisterComponentType<OccluderComponent>();
 
 		// Create a scene, and set it to be the active scene in the application
 		GameScene::sptr scene = GameScene::Create("test");
 		Application::Instance().ActiveScene = scene;
 
-		// We can create a group ahead of time to make iterating on the group faster
-		entt::basic_group<entt::entity, entt::exclude_t<>, entt::get_t<Transform>, RendererComponent> renderGroup =
-			scene->Registry().group<RendererComponent>(entt::get_t<Transform>());
+		renderQueue.Init(scene->Registry());
+		spatialIndex.Init(scene->Registry());
 
 		// Create a material and set some properties for it
 		ShaderMaterial::sptr stoneMat = ShaderMaterial::Create();  
@@ -384,6 +616,16 @@ int main() {
 		marbleMat->Set("u_Shininess", 8.0f);
 		marbleMat->Set("u_TextureMix", 0.0f);
 
+		//Marble with grass blended over it, s_Diffuse2 is only in the TEXTURE_MIX variant
+		ShaderMaterial::sptr mossyMarbleMat = ShaderMaterial::Create();
+		mossyMarbleMat->Shader = shader;
+		mossyMarbleMat->SetKeyword("TEXTURE_MIX", true);
+		mossyMarbleMat->Set("s_Diffuse", marble);
+		mossyMarbleMat->Set("s_Diffuse2", grass);
+		mossyMarbleMat->Set("s_Specular", noSpec);
+		mossyMarbleMat->Set("u_Shininess", 8.0f);
+		mossyMarbleMat->Set("u_TextureMix", 0.35f);
+
 		ShaderMaterial::sptr throneMat = ShaderMaterial::Create();
 		throneMat->Shader = shader;
 		throneMat->Set("s_Diffuse", throne);
@@ -422,7 +664,9 @@ int main() {
 		GameObject obj1 = scene->CreateEntity("Ground"); 
 		{
 			VertexArrayObject::sptr vao = ObjLoader::LoadFromFile("models/plane.obj");
-			obj1.emplace<RendererComponent>().SetMesh(vao).SetMaterial(marbleMat);
+			obj1.emplace<RendererComponent>().SetMesh(vao).SetMaterial(mossyMarbleMat);
+			// The plane fills its bounds, so they make an exact occluder
+			obj1.emplace<OccluderComponent>(OccluderComponent::FromBounds(vao));
 			obj1.get<Transform>().SetLocalRotation(90.0f, 0.0f, 90.0f);
 			BehaviourBinding::BindDisabled<SimpleMoveBehaviour>(obj1);
 		}
@@ -440,15 +684,19 @@ int main() {
 		{
 			VertexArrayObject::sptr vao = ObjLoader::LoadFromFile("models/throne.obj");
 			obj3.emplace<RendererComponent>().SetMesh(vao).SetMaterial(throneMat);
+			// Keep the occluder well inside the throne, its bounds include the gaps around the arms and back
+			obj3.emplace<OccluderComponent>(OccluderComponent::FromBounds(vao, glm::vec3(0.5f)));
 			obj3.get<Transform>().SetLocalPosition(0.0f, 0.0f, 0.0f);
 			obj3.get<Transform>().SetLocalRotation(90.0f, 0.0f, 180.0f);
 			BehaviourBinding::BindDisabled<SimpleMoveBehaviour>(obj3);
 		}
 
+		// All the knights share one mesh so they can be drawn together
+		VertexArrayObject::sptr knightMesh = ObjLoader::LoadFromFile("models/knight.obj");
+
 		GameObject obj4 = scene->CreateEntity("Knight");
 		{
-			VertexArrayObject::sptr vao = ObjLoader::LoadFromFile("models/knight.obj");
-			obj4.emplace<RendererComponent>().SetMesh(vao).SetMaterial(knightMat);
+			obj4.emplace<RendererComponent>().SetMesh(knightMesh).SetMaterial(knightMat);
 			obj4.get<Transform>().SetLocalPosition(0.0f, 5.0f, 0.0f);
 			obj4.get<Transform>().SetLocalRotation(90.0f, 0.0f, 180.0f);
 			BehaviourBinding::BindDisabled<SimpleMoveBehaviour>(obj4);
@@ -456,8 +704,7 @@ int main() {
 
 		GameObject obj5 = scene->CreateEntity("Knight2");
 		{
-			VertexArrayObject::sptr vao = ObjLoader::LoadFromFile("models/knight.obj");
-			obj5.emplace<RendererComponent>().SetMesh(vao).SetMaterial(knightMat);
+			obj5.emplace<RendererComponent>().SetMesh(knightMesh).SetMaterial(knightMat);
 			obj5.get<Transform>().SetLocalPosition(0.0f, 2.0f, 0.0f);
 			obj5.get<Transform>().SetLocalRotation(90.0f, 0.0f, 180.0f);
 			BehaviourBinding::BindDisabled<SimpleMoveBehaviour>(obj5);
@@ -465,8 +712,7 @@ int main() {
 
 		GameObject obj6 = scene->CreateEntity("Knight3");
 		{
-			VertexArrayObject::sptr vao = ObjLoader::LoadFromFile("models/knight.obj");
-			obj6.emplace<RendererComponent>().SetMesh(vao).SetMaterial(knightMat);
+			obj6.emplace<RendererComponent>().SetMesh(knightMesh).SetMaterial(knightMat);
 			obj6.get<Transform>().SetLocalPosition(0.0f, 8.0f, 0.0f);
 			obj6.get<Transform>().SetLocalRotation(90.0f, 0.0f, 180.0f);
 			BehaviourBinding::BindDisabled<SimpleMoveBehaviour>(obj6);
@@ -474,8 +720,7 @@ int main() {
 
 		GameObject obj7 = scene->CreateEntity("Knight4");
 		{
-			VertexArrayObject::sptr vao = ObjLoader::LoadFromFile("models/knight.obj");
-			obj7.emplace<RendererComponent>().SetMesh(vao).SetMaterial(knightMat);
+			obj7.emplace<RendererComponent>().SetMesh(knightMesh).SetMaterial(knightMat);
 			obj7.get<Transform>().SetLocalPosition(0.0f, -1.0f, 0.0f);
 			obj7.get<Transform>().SetLocalRotation(90.0f, 0.0f, 180.0f);
 			BehaviourBinding::BindDisabled<SimpleMoveBehaviour>(obj7);
@@ -483,8 +728,7 @@ int main() {
 
 		GameObject obj8 = scene->CreateEntity("Knight5");
 		{
-			VertexArrayObject::sptr vao = ObjLoader::LoadFromFile("models/knight.obj");
-			obj8.emplace<RendererComponent>().SetMesh(vao).SetMaterial(knightMat);
+			obj8.emplace<RendererComponent>().SetMesh(knightMesh).SetMaterial(knightMat);
 			obj8.get<Transform>().SetLocalPosition(0.0f, -8.5f, 0.0f);
 			obj8.get<Transform>().SetLocalRotation(90.0f, 0.0f, 0.0f);
 			BehaviourBinding::BindDisabled<SimpleMoveBehaviour>(obj8);
@@ -492,8 +736,7 @@ int main() {
 
 		GameObject obj9 = scene->CreateEntity("Knight6");
 		{
-			VertexArrayObject::sptr vao = ObjLoader::LoadFromFile("models/knight.obj");
-			obj9.emplace<RendererComponent>().SetMesh(vao).SetMaterial(knightMat);
+			obj9.emplace<RendererComponent>().SetMesh(knightMesh).SetMaterial(knightMat);
 			obj9.get<Transform>().SetLocalPosition(0.0f, -5.5f, 0.0f);
 			obj9.get<Transform>().SetLocalRotation(90.0f, 0.0f, 0.0f);
 			BehaviourBinding::BindDisabled<SimpleMoveBehaviour>(obj9);
@@ -501,8 +744,7 @@ int main() {
 
 		GameObject obj10 = scene->CreateEntity("Knight7");
 		{
-			VertexArrayObject::sptr vao = ObjLoader::LoadFromFile("models/knight.obj");
-			obj10.emplace<RendererComponent>().SetMesh(vao).SetMaterial(knightMat);
+			obj10.emplace<RendererComponent>().SetMesh(knightMesh).SetMaterial(knightMat);
 			obj10.get<Transform>().SetLocalPosition(0.0f, -2.5f, 0.0f);
 			obj10.get<Transform>().SetLocalRotation(90.0f, 0.0f, 0.0f);
 			BehaviourBinding::BindDisabled<SimpleMoveBehaviour>(obj10);
@@ -510,8 +752,7 @@ int main() {
 
 		GameObject obj11 = scene->CreateEntity("Knight8");
 		{
-			VertexArrayObject::sptr vao = ObjLoader::LoadFromFile("models/knight.obj");
-			obj11.emplace<RendererComponent>().SetMesh(vao).SetMaterial(knightMat);
+			obj11.emplace<RendererComponent>().SetMesh(knightMesh).SetMaterial(knightMat);
 			obj11.get<Transform>().SetLocalPosition(0.0f, 0.5f, 0.0f);
 			obj11.get<Transform>().SetLocalRotation(90.0f, 0.0f, 0.0f);
 			BehaviourBinding::BindDisabled<SimpleMoveBehaviour>(obj11);
@@ -573,7 +814,7 @@ int main() {
 
 		GameObject framebufferObject = scene->CreateEntity("Basic Effect");
 		{
-			basicEffect = &framebufferObject.emplace<PostEffect>();
+			basicEffect = &framebufferObject.emplace<SceneEffect>();
 			basicEffect->Init(width, height);
 		}
 
@@ -605,6 +846,38 @@ int main() {
 		}
 		effects.push_back(bloomEffect);
 
+		//Just sepia to start with
+		effectEnabled = { true, false, false, false };
+
+		GameObject fusedEffectObject = scene->CreateEntity("Fused Effect");
+		{
+			fusedEffect = &fusedEffectObject.emplace<FusedEffect>();
+			fusedEffect->Init(width, height);
+		}
+
+		GameObject ssaoEffectObject = scene->CreateEntity("SSAO Effect");
+		{
+			ssaoEffect = &ssaoEffectObject.emplace<SSAOEffect>();
+			ssaoEffect->Init(width, height);
+		}
+
+		GameObject taaEffectObject = scene->CreateEntity("TAA Effect");
+		{
+			taaEffect = &taaEffectObject.emplace<TAAEffect>();
+			taaEffect->Init(width, height);
+		}
+
+		GameObject upscaleEffectObject = scene->CreateEntity("Upscale Effect");
+		{
+			upscaleEffect = &upscaleEffectObject.emplace<UpscaleEffect>();
+			upscaleEffect->Init(width, height);
+		}
+
+		dynamicResolution.Init();
+		instanceBatcher.Init();
+		//Room for the frame block and about a thousand non-instanced draws a frame
+		uniformRing.Init(256 * 1024);
+
 		#pragma endregion 
 		//////////////////////////////////////////////////////////////////////////////////////////
 
@@ -626,6 +899,8 @@ int main() {
 			MeshFactory::AddIcoSphere(mesh, glm::vec3(0.0f), 1.0f);
 			MeshFactory::InvertFaces(mesh);
 			VertexArrayObject::sptr meshVao = mesh.Bake();
+			// The skybox is drawn at infinity, so its bounds would get it culled
+			meshVao->ClearBounds();
 			
 			GameObject skyboxObj = scene->CreateEntity("skybox");  
 			skyboxObj.get<Transform>().SetLocalPosition(0.0f, 0.0f, 0.0f);
@@ -666,25 +941,27 @@ int main() {
 				});
 		}
 
+		ShaderLibrary::EndBatch();
+		// A warm start should show everything coming from the cache
+		LOG_INFO("Built shaders in {:.1f} ms ({} from cache, {} compiled, {} stage compiles shared)",
+			ShaderLibrary::GetBuildTime(), ShaderLibrary::GetCachedCount(), ShaderLibrary::GetCompiledCount(), ShaderLibrary::GetSharedStageCount());
+
 		// Initialize our timing instance and grab a reference for our use
 		Timing& time = Timing::Instance();
 		time.LastFrame = glfwGetTime();
 
+		// Last frame's camera, for motion vectors
+		glm::mat4 prevView = glm::inverse(cameraObject.get<Transform>().LocalTransform());
+		glm::mat4 prevProjection = cameraObject.get<Camera>().GetProjection();
+		glm::vec2 prevJitter = glm::vec2(0.0f);
+
 		///// Game loop /////
 		while (!glfwWindowShouldClose(BackendHandler::window)) {
 			glfwPollEvents();
-
-			// Update the timing
-			time.CurrentFrame = glfwGetTime();
-			time.DeltaTime = static_cast<float>(time.CurrentFrame - time.LastFrame);
-
-			time.DeltaTime = time.DeltaTime > 1.0f ? 1.0f : time.DeltaTime;
-
-			// Update our FPS tracker data
-			fpsBuffer[frameIx] = 1.0f / time.DeltaTime;
-			frameIx++;
-			if (frameIx >= 128)
-				frameIx = 0;
+			// Counters in the debug UI show the frame that just finished
+			GLState::BeginFrame();
+			// GL work that other threads queued up since last frame
+			Application::Instance().Jobs->PumpMainThread();
 
 			// We'll make sure our UI isn't focused before we start handling input for our game
 			if (!ImGui::IsAnyWindowFocused()) {
@@ -696,15 +973,30 @@ int main() {
 				}
 			}
 
-			// Iterate over all the behaviour binding components
-			scene->Registry().view<BehaviourBinding>().each([&](entt::entity entity, BehaviourBinding& binding) {
-				// Iterate over all the behaviour scripts attached to the entity, and update them in sequence (if enabled)
-				for (const auto& behaviour : binding.Behaviours) {
-					if (behaviour->Enabled) {
-						behaviour->Update(entt::handle(scene->Registry(), entity));
-					}
-				}
-			});
+			// Update the timing, then run the fixed updates that are due followed by Update and LateUpdate
+			//*Anything that moved in the fixed updates gets drawn blended between its last two fixed states
+			Application::Instance().Update();
+
+			// Update our FPS tracker data
+			fpsBuffer[frameIx] = 1.0f / time.DeltaTime;
+			frameIx++;
+			if (frameIx >= 128)
+				frameIx = 0;
+
+			// Pick this frame's resolution from the GPU times we've got back so far
+			// Every buffer in the chain renders into the same sized region so the UVs line up
+			float renderScale = dynamicResolution.Update();
+			basicEffect->SetRenderScale(renderScale);
+			for (int i = 0; i < effects.size(); i++)
+			{
+				effects[i]->SetRenderScale(renderScale);
+			}
+			taaEffect->SetRenderScale(renderScale);
+			ssaoEffect->SetRenderScale(renderScale);
+			fusedEffect->SetRenderScale(renderScale);
+
+			// Time everything up to the upscale, that's what the resolution affects
+			dynamicResolution.BeginFrame();
 
 			// Clear the screen
 			basicEffect->Clear();
@@ -717,80 +1009,238 @@ int main() {
 
 
 			glClearColor(0.08f, 0.17f, 0.31f, 1.0f);
-			glEnable(GL_DEPTH_TEST);
+			GLState::Enable(GL_DEPTH_TEST);
 			glClearDepth(1.0f);
 			glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-			// Update all world matrices for this frame
-			scene->Registry().view<Transform>().each([](entt::entity entity, Transform& t) {
-				t.UpdateWorldMatrix();
-			});
+			// Update the world matrices for this frame, only the ones that moved (or whose parent moved) get re-calculated
+			//*Dirty local matrices are built four at a time first, then the world matrices parents first
+			transformsUpdated = TransformSystem::Update();
 			
 			// Grab out camera info from the camera object
 			Transform& camTransform = cameraObject.get<Transform>();
+			Camera& camera = cameraObject.get<Camera>();
+			// Nudge the camera by a sub-pixel amount, TAA adds the frames back together
+			glm::vec2 jitter = taaEnabled ? taaEffect->NextJitter() : glm::vec2(0.0f);
+			camera.SetJitter(jitter);
 			glm::mat4 view = glm::inverse(camTransform.LocalTransform());
-			glm::mat4 projection = cameraObject.get<Camera>().GetProjection();
+			glm::mat4 projection = camera.GetProjection();
 			glm::mat4 viewProjection = projection * view;
+
+			// Camera uniforms go in once for every shader this frame
+			uniformRing.BeginFrame();
+			BackendHandler::SetupFrameUniforms(uniformRing, view, projection, prevView, prevProjection, glm::vec4(jitter, prevJitter));
 						
-			// Sort the renderers by shader and material, we will go for a minimizing context switches approach here,
-			// but you could for instance sort front to back to optimize for fill rate if you have intensive fragment shaders
-			renderGroup.sort<RendererComponent>([](const RendererComponent& l, const RendererComponent& r) {
-				// Sort by render layer first, higher numbers get drawn last
-				if (l.Material->RenderLayer < r.Material->RenderLayer) return true;
-				if (l.Material->RenderLayer > r.Material->RenderLayer) return false;
-
-				// Sort by shader pointer next (so materials using the same shader run sequentially where possible)
-				if (l.Material->Shader < r.Material->Shader) return true;
-				if (l.Material->Shader > r.Material->Shader) return false;
-
-				// Sort by material pointer last (so we can minimize switching between materials)
-				if (l.Material < r.Material) return true;
-				if (l.Material > r.Material) return false;
-				
-				return false;
-			});
+			// Refresh the sort keys, the queue stays sorted between frames so this is usually just a quick fix up
+			renderQueue.Update(view);
+
+			// Refit anything that moved and throw out whole branches of the scene that are off screen
+			spatialIndex.Update();
+			spatialIndex.CullFrustum(viewProjection);
+
+			// Test whatever survived against the camera in one pass, this time with each renderer's own bounds
+			const std::vector<RenderQueue::Entry>& entries = renderQueue.GetEntries();
+			frustumCuller.Begin();
+			for (const RenderQueue::Entry& entry : entries)
+			{
+				if (!spatialIndex.IsVisible(entry.Entity))
+					continue;
+				const RendererComponent& renderer = scene->Registry().get<RendererComponent>(entry.Entity);
+				frustumCuller.Add(Resources::Meshes.Get(renderer.Mesh), scene->Registry().get<Transform>(entry.Entity).WorldTransform());
+			}
+			frustumCuller.Cull(viewProjection);
+
+			// Draw the occluders into the CPU depth buffer, split into tiles across the job system
+			if (occlusionCulling)
+			{
+				occlusionCuller.Begin(viewProjection);
+				scene->Registry().view<OccluderComponent, Transform>().each([&](entt::entity entity, OccluderComponent& occluder, Transform& transform) {
+					occlusionCuller.AddOccluder(occluder, transform.WorldTransform());
+				});
+				occlusionCuller.Rasterize(*Application::Instance().Jobs);
+			}
+
+			// Gather the visible renderers into batches of matching mesh and material
+			instanceBatcher.Begin();
+			unsigned culledIndex = 0;
+			for (unsigned i = 0; i < entries.size(); i++)
+			{
+				RendererComponent& renderer = scene->Registry().get<RendererComponent>(entries[i].Entity);
+				const Transform& transform = scene->Registry().get<Transform>(entries[i].Entity);
+				// Only the ones the tree let through made it into the culler
+				bool visible = false;
+				if (spatialIndex.IsVisible(entries[i].Entity))
+				{
+					visible = frustumCuller.IsVisible(culledIndex++);
+				}
+				// Last of all check it isn't hidden behind an occluder
+				glm::vec3 boundsMin, boundsMax;
+				if (visible && occlusionCulling && spatialIndex.GetBounds(entries[i].Entity, boundsMin, boundsMax))
+				{
+					visible = occlusionCuller.TestBox(boundsMin, boundsMax);
+				}
+				if (visible)
+				{
+					instanceBatcher.Add(renderer.Mesh, renderer.Material, transform.WorldTransform(), renderer.PrevWorld, transform.WorldNormalMatrix());
+				}
+				// Keep the history up to date even when culled so it doesn't smear when it comes back
+				renderer.PrevWorld = transform.WorldTransform();
+			}
+			instanceBatcher.End();
 
 			// Start by assuming no shader or material is applied
-			Shader::sptr current = nullptr;
-			ShaderMaterial::sptr currentMat = nullptr;
+			//*Raw pointers, the pools own everything so there's no refcounting in the loop
+			Shader* current = nullptr;
+			ShaderMaterial* currentMat = nullptr;
 
 			basicEffect->BindBuffer(0);
 
-			// Iterate over the render group components and draw them
-			renderGroup.each( [&](entt::entity e, RendererComponent& renderer, Transform& transform) {
-				// If the shader has changed, set up it's uniforms
-				if (current != renderer.Material->Shader) {
-					current = renderer.Material->Shader;
+			if (ssaoEnabled)
+			{
+				// Depth pre-pass, SSAO needs the depth before the lighting pass can use it
+				glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+				depthPrepassShader->Bind();
+				for (const InstanceBucket& bucket : instanceBatcher.GetBuckets())
+				{
+					// The skybox (and anything drawn after it) sits at the back anyway
+					if (bucket.Material->RenderLayer >= 100)
+						continue;
+					instanceBatcher.Render(bucket, depthPrepassShader.get(), uniformRing, viewProjection);
+				}
+				glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+
+				basicEffect->UnbindBuffer();
+
+				ssaoEffect->SetProjection(projection);
+				ssaoEffect->ApplyEffect(basicEffect);
+
+				// Back to the scene buffer, the depth from the pre-pass is still there
+				basicEffect->BindBuffer(0);
+			}
+			ssaoEffect->BindAOAsTexture(aoTextureSlot);
+
+			// Iterate over the buckets and draw them, each one is a single multi-draw
+			for (const InstanceBucket& bucket : instanceBatcher.GetBuckets())
+			{
+				// If the shader has changed, bind it (the frame uniforms are already in their block)
+				//*GetProgram picks the variant for the keywords that are on
+				Shader* program = bucket.Material->GetProgram().get();
+				if (current != program) {
+					current = program;
 					current->Bind();
-					BackendHandler::SetupShaderForFrame(current, view, projection);
 				}
 				// If the material has changed, apply it
-				if (currentMat != renderer.Material) {
-					currentMat = renderer.Material;
+				if (currentMat != bucket.Material) {
+					currentMat = bucket.Material;
 					currentMat->Apply();
 				}
-				// Render the mesh
-				BackendHandler::RenderVAO(renderer.Material->Shader, renderer.Mesh, viewProjection, transform);
-			});
+				// Render every object in the bucket
+				instanceBatcher.Render(bucket, current, uniformRing, viewProjection);
+			}
+
+			// Nothing else reads this frame's part of the ring
+			uniformRing.EndFrame();
+
+			basicEffect->UnbindTexture(aoTextureSlot);
+
+			prevView = view;
+			prevProjection = projection;
+			prevJitter = jitter;
 
 			basicEffect->UnbindBuffer();
 
-			effects[activeEffect]->ApplyEffect(basicEffect);
+			// TAA goes first so the other effects work on a clean image
+			PostEffect* sceneResult = basicEffect;
+			if (taaEnabled)
+			{
+				taaEffect->ApplyEffect(basicEffect);
+				sceneResult = taaEffect;
+			}
+
+			std::vector<PostEffect*> activeEffects;
+			for (int i = 0; i < effects.size(); i++)
+			{
+				if (effectEnabled[i])
+					activeEffects.push_back(effects[i]);
+			}
+
+			PostEffect* result = sceneResult;
+			if (fuseEffects)
+			{
+				result = fusedEffect->ApplyChain(sceneResult, activeEffects);
+			}
+			else
+			{
+				// One pass per effect, each reading the last one's output
+				for (int i = 0; i < activeEffects.size(); i++)
+				{
+					activeEffects[i]->ApplyEffect(result);
+					result = activeEffects[i];
+				}
+			}
 			
-			effects[activeEffect]->DrawToScreen();
+			// Run the same chain on the CPU and see how far off it is
+			if (runCPUComparison)
+			{
+				cpuSepiaEffect.SetIntensity(sepiaEffect->GetIntensity());
+				cpuGreyscaleEffect.SetIntensity(greyscaleEffect->GetIntensity());
+				cpuColorCorrectEffect.SetLUT(colorCorrectEffect->GetLUT());
+				cpuBloomEffect.Setthreshold(bloomEffect->Getthreshold());
+				cpuBloomEffect.Setpassthrough(bloomEffect->Getpassthrough());
+				cpuBloomEffect.Setdownscale(bloomEffect->Getdownscale());
+
+				std::vector<CPUPostEffect*> activeCPUEffects;
+				for (int i = 0; i < cpuEffects.size(); i++)
+				{
+					if (effectEnabled[i])
+						activeCPUEffects.push_back(cpuEffects[i]);
+				}
+
+				CPUImage source, gpuResult;
+				sceneResult->ReadColor(0, 0, source);
+				result->ReadColor(0, 0, gpuResult);
+
+				const CPUImage& cpuResult = cpuChain.Apply(source, activeCPUEffects);
+				cpuMilliseconds = cpuChain.GetMilliseconds();
+				cpuMegapixelsPerSecond = cpuChain.GetMegapixelsPerSecond();
+				cpuMaxError = CPUImage::MaxDifference(cpuResult, gpuResult);
+
+				cpuCompared = true;
+				runCPUComparison = false;
+			}
+
+			// Stretch the render region back over the window before the UI goes on top
+			upscaleEffect->ApplyEffect(result);
+
+			dynamicResolution.EndFrame();
 			
 			// Draw our ImGui content
 			BackendHandler::RenderImGui();
 
 			scene->Poll();
 			glfwSwapBuffers(BackendHandler::window);
-			time.LastFrame = time.CurrentFrame;
 		}
 
+		dynamicResolution.Unload();
+		renderQueue.Unload();
+		spatialIndex.Unload();
+		instanceBatcher.Unload();
+		uniformRing.Unload();
+		// Effects hold GL objects of their own, they have to go before the context does
+		ssaoEffect->Unload();
+		taaEffect->Unload();
+		upscaleEffect->Unload();
+
 		// Nullify scene so that we can release references
 		Application::Instance().ActiveScene = nullptr;
 		//Clean up the environment generator so we can release references
 		EnvironmentGenerator::CleanUpPointers();
+		// Anything still queued for the main thread gets a chance to clean up while the context is alive
+		Application::Instance().Jobs->PumpMainThread();
+		Application::Instance().Jobs.reset();
+		//The pools own every mesh and material a renderer was given
+		Resources::Unload();
+		ShaderLibrary::Unload();
 		BackendHandler::ShutdownImGui();
 	}	
 
@@ -0,0 +1,196 @@
+//Unit tests for the JobSystem in BaseApplicationModule
+//*Console only, no window or GL context, so it runs on build machines without a GPU
+//*Exits with the number of failed checks, so 0 means everything passed
+#include <JobSystem.h>
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+static int failures = 0;
+
+//Logs a failed check without stopping, so one run reports everything that's broken
+#define CHECK(condition) \
+	do { \
+		if (!(condition)) { \
+			printf("  FAILED: %s (line %d)\n", #condition, __LINE__); \
+			failures++; \
+		} \
+	} while (false)
+
+struct Position { int Value = 0; };
+struct Velocity { int Value = 1; };
+
+//Every index from 0 to count gets handed to exactly one chunk
+void TestParallelForCoverage(JobSystem& jobs) {
+	printf("ParallelFor coverage\n");
+	//Empty, smaller than a grain, exactly one grain, a partial last grain and lots of grains
+	const unsigned counts[] = { 0, 1, 7, 64, 1000, 100003 };
+	const unsigned grains[] = { 1, 16, 64, 5000 };
+
+	for (unsigned count : counts) {
+		for (unsigned grain : grains) {
+			std::vector<std::atomic<int>> hits(count);
+			std::atomic<bool> outOfRange{ false };
+			jobs.ParallelFor(count, grain, [&](unsigned begin, unsigned end) {
+				if (begin >= end || end > count) {
+					outOfRange = true;
+					return;
+				}
+				for (unsigned i = begin; i < end; i++) {
+					hits[i].fetch_add(1, std::memory_order_relaxed);
+				}
+			});
+
+			CHECK(!outOfRange);
+			unsigned wrong = 0;
+			for (unsigned i = 0; i < count; i++) {
+				if (hits[i].load() != 1) {
+					wrong++;
+				}
+			}
+			if (wrong != 0) {
+				printf("  count %u, grain %u: %u indices not hit exactly once\n", count, grain, wrong);
+			}
+			CHECK(wrong == 0);
+		}
+	}
+}
+
+//Every entity with all the components gets visited once, and nothing else gets visited at all
+void TestParallelEachOnce(JobSystem& jobs) {
+	printf("ParallelEach runs once per entity\n");
+	entt::registry registry;
+	std::vector<entt::entity> entities;
+	for (int i = 0; i < 5000; i++) {
+		entt::entity entity = registry.create();
+		registry.emplace<Position>(entity);
+		//Only every third one matches the view
+		if (i % 3 == 0) {
+			registry.emplace<Velocity>(entity);
+		}
+		entities.push_back(entity);
+	}
+
+	std::atomic<int> visits{ 0 };
+	jobs.ParallelEach<Position, Velocity>(registry, 64, [&](entt::entity entity, Position& position, Velocity& velocity) {
+		//Each entity is only ever touched by one job, so no atomics needed on the components
+		position.Value += velocity.Value;
+		visits.fetch_add(1, std::memory_order_relaxed);
+	});
+
+	int expected = 0;
+	for (int i = 0; i < (int)entities.size(); i++) {
+		bool matches = i % 3 == 0;
+		expected += matches ? 1 : 0;
+		CHECK(registry.get<Position>(entities[i]).Value == (matches ? 1 : 0));
+	}
+	CHECK(visits.load() == expected);
+}
+
+//Wait doesn't come back until parents, children and grandchildren are all done
+void TestNestedCounters(JobSystem& jobs) {
+	printf("JobCounter waits on nested children\n");
+	const int parents = 50;
+	const int children = 10;
+	const int grandchildren = 4;
+
+	JobCounter counter;
+	std::atomic<int> parentsDone{ 0 }, childrenDone{ 0 }, grandchildrenDone{ 0 };
+	std::atomic<bool> missingCounter{ false };
+	for (int p = 0; p < parents; p++) {
+		jobs.Run([&]() {
+			JobCounter* parentCounter = JobSystem::CurrentCounter();
+			if (parentCounter != &counter) {
+				missingCounter = true;
+			}
+			for (int c = 0; c < children; c++) {
+				jobs.Run([&]() {
+					for (int g = 0; g < grandchildren; g++) {
+						jobs.Run([&]() {
+							//Slow enough that the parents finish first
+							std::this_thread::sleep_for(std::chrono::microseconds(50));
+							grandchildrenDone.fetch_add(1);
+						}, JobSystem::CurrentCounter());
+					}
+					childrenDone.fetch_add(1);
+				}, parentCounter);
+			}
+			parentsDone.fetch_add(1);
+		}, &counter);
+	}
+	jobs.Wait(counter);
+
+	CHECK(!missingCounter);
+	CHECK(counter.IsDone());
+	CHECK(parentsDone.load() == parents);
+	CHECK(childrenDone.load() == parents * children);
+	CHECK(grandchildrenDone.load() == parents * children * grandchildren);
+	//Nothing is running, so there's no counter to hand out
+	CHECK(JobSystem::CurrentCounter() == nullptr);
+}
+
+//Main thread jobs wait for PumpMainThread, even while the main thread is inside Wait
+void TestMainThreadJobs(JobSystem& jobs) {
+	printf("Main thread jobs only run in PumpMainThread\n");
+	const int count = 20;
+	const std::thread::id mainThread = std::this_thread::get_id();
+	CHECK(jobs.IsMainThread());
+
+	std::atomic<int> ran{ 0 };
+	std::atomic<int> ranOnMain{ 0 };
+	JobCounter mainCounter;
+	JobCounter workerCounter;
+
+	//Queued from a worker, the way a loader would hand its GL upload back. The worker then holds on until
+	//the main thread jobs run (or a timeout), so the main thread sits in Wait with them ready to go
+	std::function<void()> upload = [&]() {
+		//Only useful on a worker, bounce it back into the queue until one steals it
+		if (jobs.IsMainThread()) {
+			jobs.Run(upload, JobSystem::CurrentCounter());
+			return;
+		}
+		for (int i = 0; i < count; i++) {
+			jobs.RunOnMainThread([&]() {
+				ran.fetch_add(1);
+				if (std::this_thread::get_id() == mainThread) {
+					ranOnMain.fetch_add(1);
+				}
+			}, &mainCounter);
+		}
+		auto start = std::chrono::steady_clock::now();
+		while (ran.load() == 0 && std::chrono::steady_clock::now() - start < std::chrono::milliseconds(100)) {
+			std::this_thread::yield();
+		}
+	};
+	jobs.Run(upload, &workerCounter);
+	//The main thread helps out in here, but must leave the main thread jobs alone
+	jobs.Wait(workerCounter);
+	CHECK(ran.load() == 0);
+	CHECK(!mainCounter.IsDone());
+
+	unsigned pumped = jobs.PumpMainThread();
+	CHECK(pumped == (unsigned)count);
+	CHECK(ran.load() == count);
+	CHECK(ranOnMain.load() == count);
+	CHECK(mainCounter.IsDone());
+	//Nothing left over
+	CHECK(jobs.PumpMainThread() == 0);
+}
+
+int main() {
+	//More workers than this machine might have cores, so stealing happens either way
+	JobSystem jobs(3);
+	printf("Running with %u threads\n", jobs.GetThreadCount());
+
+	TestParallelForCoverage(jobs);
+	TestParallelEachOnce(jobs);
+	TestNestedCounters(jobs);
+	TestMainThreadJobs(jobs);
+
+	printf(failures == 0 ? "All tests passed\n" : "%d checks failed\n", failures);
+	return failures;
+}